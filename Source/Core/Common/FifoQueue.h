@@ -113,4 +113,71 @@ private:
 	volatile u32 m_size;
 };
 
+// a lockless multiple writer, single reader queue
+// Push may be called from any thread, Pop only from the reader.
+// An element whose Push has not returned yet may hide the ones pushed after it.
+template <typename T>
+class MPSCQueue
+{
+public:
+	MPSCQueue()
+	{
+		m_write_ptr = m_read_ptr = new ElementPtr();
+	}
+
+	~MPSCQueue()
+	{
+		Clear();
+		delete m_read_ptr;
+	}
+
+	bool Empty() const
+	{
+		return !AtomicLoad(m_read_ptr->next);
+	}
+
+	template <typename Arg>
+	void Push(Arg&& t)
+	{
+		ElementPtr* new_ptr = new ElementPtr();
+		new_ptr->current = std::forward<Arg>(t);
+		// claim the tail first, then link the old tail to it
+		ElementPtr* prev = AtomicExchangeAcquire(m_write_ptr, new_ptr);
+		AtomicStoreRelease(prev->next, new_ptr);
+	}
+
+	bool Pop(T& t)
+	{
+		ElementPtr* next = AtomicLoadAcquire(m_read_ptr->next);
+		if (!next)
+			return false;
+
+		// the read pointer is always a consumed element, its successor holds the data
+		t = std::move(next->current);
+		delete m_read_ptr;
+		m_read_ptr = next;
+		return true;
+	}
+
+	// not thread-safe
+	void Clear()
+	{
+		T t;
+		while (Pop(t)) {}
+	}
+
+private:
+	class ElementPtr
+	{
+	public:
+		ElementPtr() : next(NULL) {}
+
+		T current;
+		ElementPtr *volatile next;
+	};
+
+	ElementPtr *volatile m_write_ptr;
+	ElementPtr *m_read_ptr;
+};
+
 }
@@ -553,6 +553,8 @@ void XEmitter::SAHF() {Write8(0x9E);}
 void XEmitter::PUSHF() {Write8(0x9C);}
 void XEmitter::POPF()  {Write8(0x9D);}
 
+void XEmitter::RDTSC() {Write8(0x0F); Write8(0x31);}
+
 void XEmitter::LFENCE() {Write8(0x0F); Write8(0xAE); Write8(0xE8);}
 void XEmitter::MFENCE() {Write8(0x0F); Write8(0xAE); Write8(0xF0);}
 void XEmitter::SFENCE() {Write8(0x0F); Write8(0xAE); Write8(0xF8);}
@@ -327,6 +327,9 @@ public:
 	// Note: CMOV brings small if any benefit on current cpus.
 	void CMOVcc(int bits, X64Reg dest, OpArg src, CCFlags flag);
 
+	// Timestamp counter
+	void RDTSC();
+
 	// Fences
 	void LFENCE();
 	void MFENCE();
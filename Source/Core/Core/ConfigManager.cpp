@@ -109,6 +109,7 @@ static const struct
 	{ "UndoSaveState",       351 /* WXK_F12 */,   4 /* wxMOD_SHIFT */ },
 	{ "SaveStateFile",       0,                   0 /* wxMOD_NONE */ },
 	{ "LoadStateFile",       0,                   0 /* wxMOD_NONE */ },
+	{ "Rewind",              0,                   0 /* wxMOD_NONE */ },
 };
 
 SConfig::SConfig()
@@ -229,10 +230,12 @@ void SConfig::SaveSettings()
 	ini.Set("Core", "HLE_BS2",			m_LocalCoreStartupParameter.bHLE_BS2);
 	ini.Set("Core", "CPUCore",			m_LocalCoreStartupParameter.iCPUCore);
 	ini.Set("Core", "Fastmem",			m_LocalCoreStartupParameter.bFastmem);
+	ini.Set("Core", "TextureWriteWatch",	m_LocalCoreStartupParameter.bTextureWriteWatch);
 	ini.Set("Core", "CPUThread",		m_LocalCoreStartupParameter.bCPUThread);
 	ini.Set("Core", "DSPThread",		m_LocalCoreStartupParameter.bDSPThread);
 	ini.Set("Core", "DSPHLE",			m_LocalCoreStartupParameter.bDSPHLE);
 	ini.Set("Core", "SkipIdle",			m_LocalCoreStartupParameter.bSkipIdle);
+	ini.Set("Core", "FastHLE",			m_LocalCoreStartupParameter.bFastHLE);
 	ini.Set("Core", "DefaultGCM",		m_LocalCoreStartupParameter.m_strDefaultGCM);
 	ini.Set("Core", "DVDRoot",			m_LocalCoreStartupParameter.m_strDVDRoot);
 	ini.Set("Core", "Apploader",		m_LocalCoreStartupParameter.m_strApploader);
@@ -382,10 +385,13 @@ void SConfig::LoadSettings()
 		ini.Get("Core", "CPUCore",		&m_LocalCoreStartupParameter.iCPUCore,		1);
 #endif
 		ini.Get("Core", "Fastmem",		&m_LocalCoreStartupParameter.bFastmem,		true);
+		ini.Get("Core", "TextureWriteWatch",	&m_LocalCoreStartupParameter.bTextureWriteWatch,	false);
 		ini.Get("Core", "DSPThread",	&m_LocalCoreStartupParameter.bDSPThread,	false);
 		ini.Get("Core", "DSPHLE",		&m_LocalCoreStartupParameter.bDSPHLE,		true);
 		ini.Get("Core", "CPUThread",	&m_LocalCoreStartupParameter.bCPUThread,	true);
 		ini.Get("Core", "SkipIdle",		&m_LocalCoreStartupParameter.bSkipIdle,		true);
+		ini.Get("Core", "FastHLE",		&m_LocalCoreStartupParameter.bFastHLE,		true);
+		ini.Get("Core", "FastHLEVerify",	&m_LocalCoreStartupParameter.bFastHLEVerify,	false);
 		ini.Get("Core", "DefaultGCM",	&m_LocalCoreStartupParameter.m_strDefaultGCM);
 		ini.Get("Core", "DVDRoot",		&m_LocalCoreStartupParameter.m_strDVDRoot);
 		ini.Get("Core", "Apploader",	&m_LocalCoreStartupParameter.m_strApploader);
@@ -401,6 +407,9 @@ void SConfig::LoadSettings()
 		ini.Get("Core", "BBA_MAC",		&m_bba_mac);
 		ini.Get("Core", "TimeProfiling",&m_LocalCoreStartupParameter.bJITILTimeProfiling,		false);
 		ini.Get("Core", "OutputIR",		&m_LocalCoreStartupParameter.bJITILOutputIR,			false);
+		ini.Get("Core", "ProfileBlocks",	&m_LocalCoreStartupParameter.bJITProfileBlocks,		false);
+		ini.Get("Core", "PerfMap",		&m_LocalCoreStartupParameter.bJITPerfMap,				false);
+		ini.Get("Core", "JITWarmStart",	&m_LocalCoreStartupParameter.bJITWarmStart,				true);
 		for (int i = 0; i < MAX_SI_CHANNELS; ++i)
 		{
 			ini.Get("Core", StringFromFormat("SIDevice%i", i), (u32*)&m_SIDevice[i], (i == 0) ? SIDEVICE_GC_CONTROLLER : SIDEVICE_NONE);
@@ -416,6 +425,10 @@ void SConfig::LoadSettings()
 		ini.Get("Core", "BBDumpPort",		&m_LocalCoreStartupParameter.iBBDumpPort,		-1);
 		ini.Get("Core", "VBeam",			&m_LocalCoreStartupParameter.bVBeamSpeedHack,	false);
 		ini.Get("Core", "SyncGPU",			&m_LocalCoreStartupParameter.bSyncGPU,			false);
+		ini.Get("Core", "BatchGPUFifo",		&m_LocalCoreStartupParameter.bBatchGPUFifo,		true);
+		ini.Get("Core", "Rewind",			&m_LocalCoreStartupParameter.bRewind,			false);
+		ini.Get("Core", "RewindFrames",		&m_LocalCoreStartupParameter.iRewindFrames,		60);
+		ini.Get("Core", "RewindMemory",		&m_LocalCoreStartupParameter.iRewindMemory,		512);
 		ini.Get("Core", "FastDiscSpeed",	&m_LocalCoreStartupParameter.bFastDiscSpeed,	false);
 		ini.Get("Core", "DCBZ",				&m_LocalCoreStartupParameter.bDCBZOFF,			false);
 		ini.Get("Core", "FrameLimit",		&m_Framelimit,									1); // auto frame limit by default
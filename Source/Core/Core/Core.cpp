@@ -21,6 +21,7 @@
 #include "CoreTiming.h"
 #include "Boot/Boot.h"
 #include "FifoPlayer/FifoPlayer.h"
+#include "Rewind.h"
 
 #include "HW/Memmap.h"
 #include "HW/ProcessorInterface.h"
@@ -301,7 +302,7 @@ void CpuThread()
 	}
 
 	#if defined(_M_X64) || _M_ARM
-	if (_CoreParameter.bFastmem)
+	if (_CoreParameter.bFastmem || Memory::IsWriteWatchEnabled())
 		EMM::InstallExceptionHandler(); // Let's run under memory watch
 	#endif
 
@@ -345,6 +346,12 @@ void FifoPlayerThread()
 		Common::SetCurrentThreadName("FIFO-GPU thread");
 	}
 
+	#if defined(_M_X64) || _M_ARM
+	// The FIFO player copies into emulated memory, which faults on watched pages
+	if (Memory::IsWriteWatchEnabled())
+		EMM::InstallExceptionHandler();
+	#endif
+
 	g_bStarted = true;
 
 	// Enter CPU run loop. When we leave it - we are done.
@@ -626,6 +633,8 @@ void VideoThrottle()
 	}
 
 	DrawnVideo++;
+
+	Rewind::FrameUpdate();
 }
 
 // Executed from GPU thread
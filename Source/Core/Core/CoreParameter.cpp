@@ -32,15 +32,17 @@ SCoreStartupParameter::SCoreStartupParameter()
   bJITPairedOff(false), bJITSystemRegistersOff(false),
   bJITBranchOff(false),
   bJITILTimeProfiling(false), bJITILOutputIR(false),
-  bEnableFPRF(false),
+  bJITProfileBlocks(false), bJITPerfMap(false), bJITWarmStart(true),
+  bTextureWriteWatch(false), bEnableFPRF(false),
   bCPUThread(true), bDSPThread(false), bDSPHLE(true),
   bSkipIdle(true), bNTSC(false), bForceNTSCJ(false),
-  bHLE_BS2(true), bEnableCheats(false),
+  bHLE_BS2(true), bFastHLE(true), bFastHLEVerify(false), bEnableCheats(false),
   bMergeBlocks(false), bEnableMemcardSaving(true),
   bDPL2Decoder(false), iLatency(14),
   bRunCompareServer(false), bRunCompareClient(false),
   bMMU(false), bDCBZOFF(false), bTLBHack(false), iBBDumpPort(0), bVBeamSpeedHack(false),
-  bSyncGPU(false), bFastDiscSpeed(false),
+  bSyncGPU(false), bBatchGPUFifo(true), bRewind(false), iRewindFrames(60), iRewindMemory(512),
+  bFastDiscSpeed(false),
   SelectedLanguage(0), bWii(false),
   bConfirmStop(false), bHideCursor(false),
   bAutoHideCursor(false), bUsePanicHandlers(true), bOnScreenDisplayMessages(true),
@@ -79,6 +81,10 @@ void SCoreStartupParameter::LoadDefaults()
 	iBBDumpPort = -1;
 	bVBeamSpeedHack = false;
 	bSyncGPU = false;
+	bBatchGPUFifo = true;
+	bRewind = false;
+	iRewindFrames = 60;
+	iRewindMemory = 512;
 	bFastDiscSpeed = false;
 	bMergeBlocks = false;
 	bEnableMemcardSaving = true;
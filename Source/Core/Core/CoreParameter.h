@@ -77,6 +77,7 @@ enum Hotkey
 	HK_UNDO_SAVE_STATE,
 	HK_SAVE_STATE_FILE,
 	HK_LOAD_STATE_FILE,
+	HK_REWIND,
 
 	NUM_HOTKEYS,
 };
@@ -112,8 +113,10 @@ struct SCoreStartupParameter
 	bool bJITBranchOff;
 	bool bJITILTimeProfiling;
 	bool bJITILOutputIR;
+	bool bJITProfileBlocks, bJITPerfMap, bJITWarmStart;
 
 	bool bFastmem;
+	bool bTextureWriteWatch;
 	bool bEnableFPRF;
 
 	bool bCPUThread;
@@ -123,6 +126,7 @@ struct SCoreStartupParameter
 	bool bNTSC;
 	bool bForceNTSCJ;
 	bool bHLE_BS2;
+	bool bFastHLE, bFastHLEVerify;
 	bool bEnableCheats;
 	bool bMergeBlocks;
 	bool bEnableMemcardSaving;
@@ -139,6 +143,10 @@ struct SCoreStartupParameter
 	int iBBDumpPort;
 	bool bVBeamSpeedHack;
 	bool bSyncGPU;
+	bool bBatchGPUFifo;
+	bool bRewind;
+	int iRewindFrames;
+	int iRewindMemory; // MiB
 	bool bFastDiscSpeed;
 
 	int SelectedLanguage;
@@ -2,8 +2,11 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
-#include <vector>
+#include <algorithm>
 #include <cinttypes>
+#include <functional>
+#include <tuple>
+#include <vector>
 
 #include "Thread.h"
 #include "PowerPC/PowerPC.h"
@@ -26,22 +29,34 @@ struct EventType
 
 std::vector<EventType> event_types;
 
-struct BaseEvent
+struct Event
 {
 	s64 time;
+	u64 fifo_order;
 	u64 userdata;
 	int type;
 };
 
-typedef LinkedListItem<BaseEvent> Event;
+// Events scheduled for the same cycle fire in the order they were scheduled,
+// which keeps the emulation deterministic for movies and netplay.
+static bool operator<(const Event& left, const Event& right)
+{
+	return std::tie(left.time, left.fifo_order) < std::tie(right.time, right.fifo_order);
+}
 
-// STATE_TO_SAVE
-static Event *first;
-static std::mutex tsWriteLock;
-Common::FifoQueue<BaseEvent, false> tsQueue;
+// The std heap functions keep the largest element on top, so use a reversed
+// comparison to have the next event to fire there.
+static bool FiresLater(const Event& left, const Event& right)
+{
+	return right < left;
+}
 
-// event pools
-Event *eventPool = 0;
+// STATE_TO_SAVE
+// A binary heap ordered by FiresLater.
+static std::vector<Event> event_queue;
+static u64 event_fifo_id;
+// Events scheduled from other threads, moved into event_queue by the CPU thread.
+static Common::MPSCQueue<Event> ts_queue;
 
 int downcount, slicelength;
 int maxSliceLength = MAX_SLICE_LENGTH;
@@ -59,22 +74,6 @@ int ev_lost;
 
 void (*advanceCallback)(int cyclesExecuted) = NULL;
 
-Event* GetNewEvent()
-{
-	if(!eventPool)
-		return new Event;
-
-	Event* ev = eventPool;
-	eventPool = ev->next;
-	return ev;
-}
-
-void FreeEvent(Event* ev)
-{
-	ev->next = eventPool;
-	eventPool = ev;
-}
-
 static void EmptyTimedCallback(u64 userdata, int cyclesLate) {}
 
 int RegisterEvent(const char *name, TimedCallback callback)
@@ -103,7 +102,7 @@ int RegisterEvent(const char *name, TimedCallback callback)
 
 void UnregisterAllEvents()
 {
-	if (first)
+	if (!event_queue.empty())
 		PanicAlertT("Cannot unregister events with events pending");
 	event_types.clear();
 }
@@ -114,26 +113,19 @@ void Init()
 	slicelength = maxSliceLength;
 	globalTimer = 0;
 	idledCycles = 0;
+	event_fifo_id = 0;
 
 	ev_lost = RegisterEvent("_lost_event", &EmptyTimedCallback);
 }
 
 void Shutdown()
 {
-	std::lock_guard<std::mutex> lk(tsWriteLock);
 	MoveEvents();
 	ClearPendingEvents();
 	UnregisterAllEvents();
-
-	while(eventPool)
-	{
-		Event *ev = eventPool;
-		eventPool = ev->next;
-		delete ev;
-	}
 }
 
-void EventDoState(PointerWrap &p, BaseEvent* ev)
+void EventDoState(PointerWrap &p, Event* ev)
 {
 	p.Do(ev->time);
 
@@ -169,7 +161,6 @@ void EventDoState(PointerWrap &p, BaseEvent* ev)
 
 void DoState(PointerWrap &p)
 {
-	std::lock_guard<std::mutex> lk(tsWriteLock);
 	p.Do(downcount);
 	p.Do(slicelength);
 	p.Do(globalTimer);
@@ -182,8 +173,26 @@ void DoState(PointerWrap &p)
 
 	MoveEvents();
 
-	p.DoLinkedList<BaseEvent, GetNewEvent, FreeEvent, EventDoState>(first);
+	// Saved in firing order.  A sorted array is still a valid heap, and
+	// renumbering it on load keeps same-cycle events in their original order.
+	if (p.GetMode() != PointerWrap::MODE_READ)
+		std::sort(event_queue.begin(), event_queue.end());
+
+	u32 num_events = (u32)event_queue.size();
+	p.Do(num_events);
+	if (p.GetMode() == PointerWrap::MODE_READ)
+	{
+		event_queue.resize(num_events);
+		event_fifo_id = 0;
+	}
+	for (Event& ev : event_queue)
+	{
+		EventDoState(p, &ev);
+		if (p.GetMode() == PointerWrap::MODE_READ)
+			ev.fifo_order = event_fifo_id++;
+	}
 	p.DoMarker("CoreTimingEvents");
+
 }
 
 u64 GetTicks()
@@ -200,12 +209,12 @@ u64 GetIdleTicks()
 // schedule things to be executed on the main thread.
 void ScheduleEvent_Threadsafe(int cyclesIntoFuture, int event_type, u64 userdata)
 {
-	std::lock_guard<std::mutex> lk(tsWriteLock);
 	Event ne;
 	ne.time = globalTimer + cyclesIntoFuture;
+	ne.fifo_order = 0;
 	ne.type = event_type;
 	ne.userdata = userdata;
-	tsQueue.Push(ne);
+	ts_queue.Push(ne);
 }
 
 // Same as ScheduleEvent_Threadsafe(0, ...) EXCEPT if we are already on the CPU thread
@@ -224,30 +233,31 @@ void ScheduleEvent_Threadsafe_Immediate(int event_type, u64 userdata)
 
 void ClearPendingEvents()
 {
-	while (first)
-	{
-		Event *e = first->next;
-		FreeEvent(first);
-		first = e;
-	}
+	event_queue.clear();
 }
 
-void AddEventToQueue(Event* ne)
+static void AddEventToQueue(Event ne)
 {
-	Event* prev = NULL;
-	Event** pNext = &first;
-	for(;;)
-	{
-		Event*& next = *pNext;
-		if(!next || ne->time < next->time)
-		{
-			ne->next = next;
-			next = ne;
-			break;
-		}
-		prev = next;
-		pNext = &prev->next;
-	}
+	ne.fifo_order = event_fifo_id++;
+	event_queue.push_back(ne);
+	std::push_heap(event_queue.begin(), event_queue.end(), FiresLater);
+}
+
+// Removes the next event from the queue and calls it.
+static void RunNextEvent()
+{
+	Event evt = event_queue.front();
+	std::pop_heap(event_queue.begin(), event_queue.end(), FiresLater);
+	event_queue.pop_back();
+	event_types[evt.type].callback(evt.userdata, (int)(globalTimer - evt.time));
+}
+
+// The queue in firing order, for display.
+static std::vector<Event> GetSortedEvents()
+{
+	std::vector<Event> events(event_queue);
+	std::sort(events.begin(), events.end());
+	return events;
 }
 
 // This must be run ONLY from within the cpu thread
@@ -255,10 +265,10 @@ void AddEventToQueue(Event* ne)
 // than Advance
 void ScheduleEvent(int cyclesIntoFuture, int event_type, u64 userdata)
 {
-	Event *ne = GetNewEvent();
-	ne->userdata = userdata;
-	ne->type = event_type;
-	ne->time = globalTimer + cyclesIntoFuture;
+	Event ne;
+	ne.userdata = userdata;
+	ne.type = event_type;
+	ne.time = globalTimer + cyclesIntoFuture;
 	AddEventToQueue(ne);
 }
 
@@ -269,54 +279,18 @@ void RegisterAdvanceCallback(void (*callback)(int cyclesExecuted))
 
 bool IsScheduled(int event_type)
 {
-	if (!first)
-		return false;
-	Event *e = first;
-	while (e) {
-		if (e->type == event_type)
-			return true;
-		e = e->next;
-	}
-	return false;
+	return std::any_of(event_queue.begin(), event_queue.end(),
+		[event_type](const Event& e) { return e.type == event_type; });
 }
 
 void RemoveEvent(int event_type)
 {
-	if (!first)
-		return;
-
-	while(first)
+	auto it = std::remove_if(event_queue.begin(), event_queue.end(),
+		[event_type](const Event& e) { return e.type == event_type; });
+	if (it != event_queue.end())
 	{
-		if (first->type == event_type)
-		{
-			Event *next = first->next;
-			FreeEvent(first);
-			first = next;
-		}
-		else
-		{
-			break;
-		}
-	}
-
-	if (!first)
-		return;
-
-	Event *prev = first;
-	Event *ptr = prev->next;
-	while (ptr)
-	{
-		if (ptr->type == event_type)
-		{
-			prev->next = ptr->next;
-			FreeEvent(ptr);
-			ptr = prev->next;
-		}
-		else
-		{
-			prev = ptr;
-			ptr = ptr->next;
-		}
+		event_queue.erase(it, event_queue.end());
+		std::make_heap(event_queue.begin(), event_queue.end(), FiresLater);
 	}
 }
 
@@ -351,36 +325,15 @@ void ProcessFifoWaitEvents()
 {
 	MoveEvents();
 
-	if (!first)
-		return;
-
-	while (first)
-	{
-		if (first->time <= globalTimer)
-		{
-			Event* evt = first;
-			first = first->next;
-			event_types[evt->type].callback(evt->userdata, (int)(globalTimer - evt->time));
-			FreeEvent(evt);
-		}
-		else
-		{
-			break;
-		}
-	}
+	while (!event_queue.empty() && event_queue.front().time <= globalTimer)
+		RunNextEvent();
 }
 
 void MoveEvents()
 {
-	BaseEvent sevt;
-	while (tsQueue.Pop(sevt))
-	{
-		Event *evt = GetNewEvent();
-		evt->time = sevt.time;
-		evt->userdata = sevt.userdata;
-		evt->type = sevt.type;
+	Event evt;
+	while (ts_queue.Pop(evt))
 		AddEventToQueue(evt);
-	}
 }
 
 void Advance()
@@ -391,31 +344,21 @@ void Advance()
 	globalTimer += cyclesExecuted;
 	downcount = slicelength;
 
-	while (first)
+	while (!event_queue.empty() && event_queue.front().time <= globalTimer)
 	{
-		if (first->time <= globalTimer)
-		{
-//			LOG(POWERPC, "[Scheduler] %s     (%lld, %lld) ",
-//				event_types[first->type].name ? event_types[first->type].name : "?", (u64)globalTimer, (u64)first->time);
-			Event* evt = first;
-			first = first->next;
-			event_types[evt->type].callback(evt->userdata, (int)(globalTimer - evt->time));
-			FreeEvent(evt);
-		}
-		else
-		{
-			break;
-		}
+//		LOG(POWERPC, "[Scheduler] %s     (%lld, %lld) ",
+//			event_types[event_queue.front().type].name, (u64)globalTimer, (u64)event_queue.front().time);
+		RunNextEvent();
 	}
 
-	if (!first)
+	if (event_queue.empty())
 	{
 		WARN_LOG(POWERPC, "WARNING - no events in queue. Setting downcount to 10000");
 		downcount += 10000;
 	}
 	else
 	{
-		slicelength = (int)(first->time - globalTimer);
+		slicelength = (int)(event_queue.front().time - globalTimer);
 		if (slicelength > maxSliceLength)
 			slicelength = maxSliceLength;
 		downcount = slicelength;
@@ -427,12 +370,8 @@ void Advance()
 
 void LogPendingEvents()
 {
-	Event *ptr = first;
-	while (ptr)
-	{
-		INFO_LOG(POWERPC, "PENDING: Now: %" PRId64 " Pending: %" PRId64 " Type: %d", globalTimer, ptr->time, ptr->type);
-		ptr = ptr->next;
-	}
+	for (const Event& ev : GetSortedEvents())
+		INFO_LOG(POWERPC, "PENDING: Now: %" PRId64 " Pending: %" PRId64 " Type: %d", globalTimer, ev.time, ev.type);
 }
 
 void Idle()
@@ -456,21 +395,19 @@ void Idle()
 
 std::string GetScheduledEventsSummary()
 {
-	Event *ptr = first;
 	std::string text = "Scheduled events\n";
 	text.reserve(1000);
-	while (ptr)
+	for (const Event& ev : GetSortedEvents())
 	{
-		unsigned int t = ptr->type;
+		unsigned int t = ev.type;
 		if (t >= event_types.size())
 			PanicAlertT("Invalid event type %i", t);
 
-		const char *name = event_types[ptr->type].name;
+		const char *name = event_types[ev.type].name;
 		if (!name)
 			name = "[unknown]";
 
-		text += StringFromFormat("%s : %" PRIi64 " %016" PRIx64 "\n", name, ptr->time, ptr->userdata);
-		ptr = ptr->next;
+		text += StringFromFormat("%s : %" PRIi64 " %016" PRIx64 "\n", name, ev.time, ev.userdata);
 	}
 	return text;
 }
@@ -13,6 +13,7 @@
 
 #include "HLE_OS.h"
 #include "HLE_Misc.h"
+#include "HLE_Fast.h"
 #include "IPC_HLE/WII_IPC_HLE_Device_es.h"
 #include "ConfigManager.h"
 #include "Core.h"
@@ -64,6 +65,20 @@ static const SPatch OSPatches[] =
 	{ "___blank",             HLE_OS::HLE_GeneralDebugPrint,   HLE_HOOK_REPLACE, HLE_TYPE_DEBUG },
 	{ "__write_console",      HLE_OS::HLE_write_console,       HLE_HOOK_REPLACE, HLE_TYPE_DEBUG }, // used by sysmenu (+more?)
 	{ "GeckoCodehandler",     HLE_Misc::HLEGeckoCodehandler,   HLE_HOOK_START,   HLE_TYPE_GENERIC },
+
+	// Hot SDK routines
+	{ "memcpy",               HLE_Fast::Memmove,               HLE_HOOK_REPLACE, HLE_TYPE_FAST },
+	{ "memmove",              HLE_Fast::Memmove,               HLE_HOOK_REPLACE, HLE_TYPE_FAST },
+	{ "memset",               HLE_Fast::Memset,                HLE_HOOK_REPLACE, HLE_TYPE_FAST },
+	{ "__fill_mem",           HLE_Fast::FillMem,               HLE_HOOK_REPLACE, HLE_TYPE_FAST },
+	{ "DCFlushRange",         HLE_Fast::DCRange,               HLE_HOOK_REPLACE, HLE_TYPE_FAST },
+	{ "DCFlushRangeNoSync",   HLE_Fast::DCRange,               HLE_HOOK_REPLACE, HLE_TYPE_FAST },
+	{ "DCStoreRange",         HLE_Fast::DCRange,               HLE_HOOK_REPLACE, HLE_TYPE_FAST },
+	{ "DCStoreRangeNoSync",   HLE_Fast::DCRange,               HLE_HOOK_REPLACE, HLE_TYPE_FAST },
+	{ "DCInvalidateRange",    HLE_Fast::DCRange,               HLE_HOOK_REPLACE, HLE_TYPE_FAST },
+	{ "DCZeroRange",          HLE_Fast::DCZeroRange,           HLE_HOOK_REPLACE, HLE_TYPE_FAST },
+	{ "PSMTXIdentity",        HLE_Fast::PSMTXIdentity,         HLE_HOOK_REPLACE, HLE_TYPE_FAST },
+	{ "PSMTX44Identity",      HLE_Fast::PSMTX44Identity,       HLE_HOOK_REPLACE, HLE_TYPE_FAST },
 };
 
 static const SPatch OSBreakPoints[] =
@@ -89,7 +104,7 @@ void PatchFunctions()
 	for (u32 i = 0; i < sizeof(OSPatches) / sizeof(SPatch); i++)
 	{
 		Symbol *symbol = g_symbolDB.GetSymbolFromName(OSPatches[i].m_szPatchName);
-		if (symbol > 0)
+		if (symbol)
 		{
 			for (u32 addr = symbol->address; addr < symbol->address + symbol->size; addr += 4)
 			{
@@ -104,7 +119,7 @@ void PatchFunctions()
 		for (size_t i = 1; i < sizeof(OSBreakPoints) / sizeof(SPatch); i++)
 		{
 			Symbol *symbol = g_symbolDB.GetSymbolFromName(OSPatches[i].m_szPatchName);
-			if (symbol > 0)
+			if (symbol)
 			{
 				PowerPC::breakpoints.Add(symbol->address, false);
 				INFO_LOG(OSHLE, "Adding BP to %s %08x", OSBreakPoints[i].m_szPatchName, symbol->address);
@@ -120,6 +135,8 @@ void Execute(u32 _CurrentPC, u32 _Instruction)
 	unsigned int FunctionIndex = _Instruction & 0xFFFFF;
 	if ((FunctionIndex > 0) && (FunctionIndex < (sizeof(OSPatches) / sizeof(SPatch))))
 	{
+		// The JITs don't keep PC up to date within a block.
+		PC = _CurrentPC;
 		OSPatches[FunctionIndex].PatchFunction();
 	}
 	else
@@ -148,7 +165,10 @@ int GetFunctionFlagsByIndex(u32 index)
 
 bool IsEnabled(int flags)
 {
-	if (flags == HLE::HLE_TYPE_MEMORY && Core::g_CoreStartupParameter.bMMU)
+	if ((flags == HLE::HLE_TYPE_MEMORY || flags == HLE::HLE_TYPE_FAST) && Core::g_CoreStartupParameter.bMMU)
+		return false;
+
+	if (flags == HLE::HLE_TYPE_FAST && !Core::g_CoreStartupParameter.bFastHLE)
 		return false;
 
 	if (flags == HLE::HLE_TYPE_DEBUG && !Core::g_CoreStartupParameter.bEnableDebugging && PowerPC::GetMode() != MODE_INTERPRETER)
@@ -160,7 +180,7 @@ bool IsEnabled(int flags)
 u32 UnPatch(std::string patchName)
 {
 	Symbol *symbol = g_symbolDB.GetSymbolFromName(patchName.c_str());
-	if (symbol > 0)
+	if (symbol)
 	{
 		for (u32 addr = symbol->address; addr < symbol->address + symbol->size; addr += 4)
 		{
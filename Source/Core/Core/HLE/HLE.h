@@ -23,6 +23,7 @@ namespace HLE
 		HLE_TYPE_MEMORY  = 1,    // Memory operation
 		HLE_TYPE_FP      = 2,    // Floating Point operation
 		HLE_TYPE_DEBUG   = 3,    // Debug output function
+		HLE_TYPE_FAST    = 4,    // Native replacement of a hot SDK routine, see HLE_Fast
 	};
 
 	void PatchFunctions();
@@ -0,0 +1,239 @@
+// Copyright 2013 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <functional>
+#include <vector>
+
+#include "Common.h"
+#include "HLE_Fast.h"
+
+#include "../PowerPC/PowerPC.h"
+#include "../PowerPC/PPCTables.h"
+#include "../PowerPC/JitInterface.h"
+#include "../HW/Memmap.h"
+#include "Core.h"
+
+namespace HLE_Fast
+{
+
+// Upper bound on the guest instructions run to verify one call.
+static const u32 VERIFY_MAX_INSTRUCTIONS = 0x4000000;
+
+// Host pointer to [address, address + size) if all of it is in one block of emulated RAM.
+static u8 *GetRangePointer(u32 address, u32 size)
+{
+	if (!Memory::IsRAMAddress(address) || !Memory::IsRAMAddress(address + size - 1))
+		return NULL;
+	u8 *ptr = Memory::GetPointer(address);
+	return (Memory::GetPointer(address + size - 1) == ptr + size - 1) ? ptr : NULL;
+}
+
+static void ReadRange(u32 address, std::vector<u8> &data)
+{
+	for (u32 i = 0; i < data.size(); i++)
+		data[i] = Memory::Read_U8(address + i);
+}
+
+static void WriteRange(u32 address, const std::vector<u8> &data)
+{
+	for (u32 i = 0; i < data.size(); i++)
+		Memory::Write_U8(data[i], address + i);
+}
+
+// Interprets the guest's own code for the current function until it returns to LR.
+static bool RunGuestFunction()
+{
+	const u32 return_address = LR;
+	for (u32 i = 0; i < VERIFY_MAX_INSTRUCTIONS && PC != return_address; i++)
+	{
+		UGeckoInstruction inst = Memory::Read_Opcode(PC);
+		Interpreter::_interpreterInstruction op = GetInterpreterOp(inst);
+		if (!op)
+			return false;
+		NPC = PC + 4;
+		op(inst);
+		if (PowerPC::ppcState.Exceptions & (EXCEPTION_SYSCALL | EXCEPTION_DSI | EXCEPTION_ISI |
+			EXCEPTION_ALIGNMENT | EXCEPTION_FPU_UNAVAILABLE | EXCEPTION_PROGRAM))
+			return false;
+		PC = NPC;
+	}
+	return PC == return_address;
+}
+
+// Runs the native version of a function that writes [address, address + size).
+// With FastHLEVerify the guest's version is run afterwards from the same state
+// and the two results compared; the guest's result is the one kept.
+static void Run(const char *name, u32 address, u32 size, const std::function<void()> &native)
+{
+	if (!Core::g_CoreStartupParameter.bFastHLEVerify || size == 0)
+	{
+		native();
+		NPC = LR;
+		return;
+	}
+
+	std::vector<u8> original(size), native_result(size), guest_result(size);
+	ReadRange(address, original);
+
+	u32 gpr[32];
+	u64 ps[32][2];
+	u8 cr_fast[8];
+	u32 spr[1024];
+	memcpy(gpr, PowerPC::ppcState.gpr, sizeof(gpr));
+	memcpy(ps, PowerPC::ppcState.ps, sizeof(ps));
+	memcpy(cr_fast, PowerPC::ppcState.cr_fast, sizeof(cr_fast));
+	memcpy(spr, PowerPC::ppcState.spr, sizeof(spr));
+	const u32 entry = PC;
+
+	native();
+	ReadRange(address, native_result);
+
+	WriteRange(address, original);
+	if (RunGuestFunction())
+	{
+		ReadRange(address, guest_result);
+		for (u32 i = 0; i < size; i++)
+		{
+			if (guest_result[i] != native_result[i])
+			{
+				ERROR_LOG(OSHLE, "FastHLE %s at %08x: result differs at %08x (native %02x, guest %02x)",
+					name, entry, address + i, native_result[i], guest_result[i]);
+				break;
+			}
+		}
+		NPC = PC;
+		return;
+	}
+
+	// The guest's version could not be run to completion in isolation; keep the native result.
+	WARN_LOG(OSHLE, "FastHLE %s at %08x: could not verify, stopped at %08x", name, entry, PC);
+	PowerPC::ppcState.Exceptions &= ~(EXCEPTION_SYSCALL | EXCEPTION_DSI | EXCEPTION_ISI |
+		EXCEPTION_ALIGNMENT | EXCEPTION_FPU_UNAVAILABLE | EXCEPTION_PROGRAM);
+	memcpy(PowerPC::ppcState.gpr, gpr, sizeof(gpr));
+	memcpy(PowerPC::ppcState.ps, ps, sizeof(ps));
+	memcpy(PowerPC::ppcState.cr_fast, cr_fast, sizeof(cr_fast));
+	memcpy(PowerPC::ppcState.spr, spr, sizeof(spr));
+	WriteRange(address, native_result);
+	PC = entry;
+	NPC = LR;
+}
+
+// MSL's memcpy picks the copy direction from the operands like memmove does,
+// so both are the same function here.
+void Memmove()
+{
+	const u32 dst = GPR(3);
+	const u32 src = GPR(4);
+	const u32 size = GPR(5);
+
+	Run("memmove", dst, size, [=] {
+		if (size == 0)
+			return;
+		u8 *dst_ptr = GetRangePointer(dst, size);
+		u8 *src_ptr = GetRangePointer(src, size);
+		if (dst_ptr && src_ptr)
+		{
+			memmove(dst_ptr, src_ptr, size);
+		}
+		else if (src < dst)
+		{
+			for (u32 i = size; i-- > 0; )
+				Memory::Write_U8(Memory::Read_U8(src + i), dst + i);
+		}
+		else
+		{
+			for (u32 i = 0; i < size; i++)
+				Memory::Write_U8(Memory::Read_U8(src + i), dst + i);
+		}
+	});
+}
+
+static void Fill(const char *name, u32 dst, u8 value, u32 size)
+{
+	Run(name, dst, size, [=] {
+		if (size == 0)
+			return;
+		u8 *dst_ptr = GetRangePointer(dst, size);
+		if (dst_ptr)
+		{
+			memset(dst_ptr, value, size);
+		}
+		else
+		{
+			for (u32 i = 0; i < size; i++)
+				Memory::Write_U8(value, dst + i);
+		}
+	});
+}
+
+// void *memset(void *dst, int value, size_t size), returns dst, which is already in r3.
+void Memset()
+{
+	Fill("memset", GPR(3), (u8)GPR(4), GPR(5));
+}
+
+// void __fill_mem(void *dst, int value, size_t size)
+void FillMem()
+{
+	Fill("__fill_mem", GPR(3), (u8)GPR(4), GPR(5));
+}
+
+// The DC*Range functions run their dcb* over every cache line touched by [r3, r3 + r4).
+static u32 GetNumLines(u32 address, u32 size)
+{
+	if (size == 0)
+		return 0;
+	return (size + (address & 31) + 31) >> 5;
+}
+
+// DCFlushRange, DCStoreRange and DCInvalidateRange.  The data cache isn't
+// emulated, so like dcbf, dcbst and dcbi this only invalidates the JIT's blocks.
+void DCRange()
+{
+	const u32 address = GPR(3);
+	const u32 num_lines = GetNumLines(address, GPR(4));
+	if (num_lines)
+		JitInterface::InvalidateICache(address & ~31, num_lines * 32);
+	NPC = LR;
+}
+
+void DCZeroRange()
+{
+	const u32 address = GPR(3) & ~31;
+	const u32 num_lines = GetNumLines(GPR(3), GPR(4));
+
+	Run("DCZeroRange", address, num_lines * 32, [=] {
+		if (Core::g_CoreStartupParameter.bDCBZOFF)
+			return;
+		// Lines never straddle two blocks of memory.
+		for (u32 i = 0; i < num_lines; i++)
+			Memory::Memset(address + i * 32, 0, 32);
+	});
+}
+
+static void WriteIdentity(const char *name, u32 matrix, int rows)
+{
+	Run(name, matrix, rows * 16, [=] {
+		for (int row = 0; row < rows; row++)
+		{
+			for (int column = 0; column < 4; column++)
+				Memory::Write_U32(row == column ? 0x3F800000 : 0, matrix + row * 16 + column * 4);
+		}
+	});
+}
+
+// void PSMTXIdentity(Mtx m), a 3x4 matrix of floats.
+void PSMTXIdentity()
+{
+	WriteIdentity("PSMTXIdentity", GPR(3), 3);
+}
+
+// void PSMTX44Identity(Mtx44 m)
+void PSMTX44Identity()
+{
+	WriteIdentity("PSMTX44Identity", GPR(3), 4);
+}
+
+}  // end of namespace HLE_Fast
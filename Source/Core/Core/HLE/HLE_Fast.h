@@ -0,0 +1,18 @@
+// Copyright 2013 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+// Native replacements for hot SDK routines.  They must leave memory exactly
+// as the guest's own code would; FastHLEVerify checks that at runtime.
+namespace HLE_Fast
+{
+	void Memmove();
+	void Memset();
+	void FillMem();
+	void DCRange();
+	void DCZeroRange();
+	void PSMTXIdentity();
+	void PSMTX44Identity();
+}
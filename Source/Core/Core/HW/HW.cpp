@@ -22,6 +22,7 @@
 #include "SystemTimers.h"
 #include "../IPC_HLE/WII_IPC_HLE.h"
 #include "../State.h"
+#include "../Rewind.h"
 #include "../PowerPC/PPCAnalyst.h"
 
 namespace HW
@@ -51,10 +52,13 @@ namespace HW
 			WII_IPCInterface::Init();
 			WII_IPC_HLE_Interface::Init();
 		}
+
+		Rewind::Init();
 	}
 
 	void Shutdown()
 	{
+		Rewind::Shutdown();
 		SystemTimers::Shutdown();
 		CCPU::Shutdown();
 		ExpansionInterface::Shutdown();
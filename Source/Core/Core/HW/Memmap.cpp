@@ -9,8 +9,12 @@
 // may be redirected here (for example to Read_U32()).
 
 
+#include <algorithm>
+#include <vector>
+
 #include "Common.h"
 #include "MemoryUtil.h"
+#include "Thread.h"
 #include "MemArena.h"
 #include "ChunkFile.h"
 
@@ -337,6 +341,141 @@ static const MemoryView views[] =
 };
 static const int num_views = sizeof(views) / sizeof(MemoryView);
 
+// =================================
+// Write watches
+// ----------------
+// A watched page is write protected in every view of it, so the first write
+// to it from any thread faults into HandleWriteWatchFault.  That lifts the
+// protection again and stamps the page with a new epoch; anything decoded
+// from the page before that epoch is stale.
+#if defined(_M_X64) && !defined(_M_GENERIC) && !defined(__APPLE__) && !defined(ANDROID)
+// The Mach exception handler only covers the CPU thread.
+#define HAVE_WRITE_WATCH
+#endif
+
+enum
+{
+	WATCH_PAGE_SHIFT = 12,
+	WATCH_PAGE_SIZE  = 1 << WATCH_PAGE_SHIFT,
+	WATCH_RAM_PAGES  = RAM_SIZE >> WATCH_PAGE_SHIFT,
+	WATCH_PAGES      = (RAM_SIZE + EXRAM_SIZE) >> WATCH_PAGE_SHIFT,
+};
+
+struct WatchView
+{
+	u8 *ptr;
+	u32 first_page;
+	u32 num_pages;
+};
+
+static bool s_write_watch;
+static bool s_watch_exram;
+static bool s_ram_in_state = true;
+static std::mutex s_write_watch_lock;
+static std::vector<WatchView> s_watch_views;
+static std::vector<bool> s_watched;
+static std::vector<u64> s_last_write;
+static u64 s_write_epoch;
+
+static void AddWatchView(u8 *ptr, u32 first_page, u32 size)
+{
+	for (auto& view : s_watch_views)
+	{
+		// On 32-bit, mirrors share a pointer.
+		if (view.ptr == ptr)
+			return;
+	}
+	WatchView view = {ptr, first_page, size >> WATCH_PAGE_SHIFT};
+	s_watch_views.push_back(view);
+}
+
+static void InitWriteWatch(bool wii)
+{
+#ifdef HAVE_WRITE_WATCH
+	const SCoreStartupParameter& params = SConfig::GetInstance().m_LocalCoreStartupParameter;
+	s_write_watch = (params.bTextureWriteWatch || params.bRewind) && GetPageSize() == WATCH_PAGE_SIZE;
+#else
+	s_write_watch = false;
+#endif
+	if (!s_write_watch)
+		return;
+
+	s_watch_views.clear();
+	AddWatchView(m_pRAM, 0, RAM_SIZE);
+	AddWatchView(m_pPhysicalRAM, 0, RAM_SIZE);
+	AddWatchView(m_pVirtualCachedRAM, 0, RAM_SIZE);
+	AddWatchView(m_pVirtualUncachedRAM, 0, RAM_SIZE);
+	s_watch_exram = wii;
+	if (wii)
+	{
+		AddWatchView(m_pEXRAM, WATCH_RAM_PAGES, EXRAM_SIZE);
+		AddWatchView(m_pPhysicalEXRAM, WATCH_RAM_PAGES, EXRAM_SIZE);
+		AddWatchView(m_pVirtualCachedEXRAM, WATCH_RAM_PAGES, EXRAM_SIZE);
+		AddWatchView(m_pVirtualUncachedEXRAM, WATCH_RAM_PAGES, EXRAM_SIZE);
+	}
+	s_watched.assign(WATCH_PAGES, false);
+	s_last_write.assign(WATCH_PAGES, 0);
+	s_write_epoch = 0;
+}
+
+static void ShutdownWriteWatch()
+{
+	std::lock_guard<std::mutex> lk(s_write_watch_lock);
+	s_write_watch = false;
+	s_watch_exram = false;
+	s_watch_views.clear();
+	s_watched.clear();
+	s_last_write.clear();
+}
+
+// Sets the protection of [page, page + count) in every view that has any of it.
+static void ProtectWatchPages(u32 page, u32 count, bool protect)
+{
+	for (auto& view : s_watch_views)
+	{
+		// The pages may run from RAM into EXRAM.
+		u32 first = std::max(page, view.first_page);
+		u32 end = std::min(page + count, view.first_page + view.num_pages);
+		if (first >= end)
+			continue;
+		u8 *ptr = view.ptr + ((first - view.first_page) << WATCH_PAGE_SHIFT);
+		if (protect)
+			WriteProtectMemory(ptr, (end - first) << WATCH_PAGE_SHIFT, false);
+		else
+			UnWriteProtectMemory(ptr, (end - first) << WATCH_PAGE_SHIFT, false);
+	}
+}
+
+// The pages [first, last] backing [address, address + size), if that is all in RAM or all in EXRAM.
+static bool GetWatchPages(u32 address, u32 size, u32 &first, u32 &last)
+{
+	if (!s_write_watch || size == 0)
+		return false;
+	const u8 *start = GetPointer(address);
+	const u8 *end = GetPointer(address + size - 1);
+	if (!start || end != start + size - 1)
+		return false;
+
+	u32 offset, page_base;
+	if (start >= m_pPhysicalRAM && end < m_pPhysicalRAM + RAM_SIZE)
+	{
+		offset = (u32)(start - m_pPhysicalRAM);
+		page_base = 0;
+	}
+	else if (s_watch_exram && start >= m_pPhysicalEXRAM && end < m_pPhysicalEXRAM + EXRAM_SIZE)
+	{
+		offset = (u32)(start - m_pPhysicalEXRAM);
+		page_base = WATCH_RAM_PAGES;
+	}
+	else
+	{
+		return false;
+	}
+	first = page_base + (offset >> WATCH_PAGE_SHIFT);
+	last = page_base + ((offset + size - 1) >> WATCH_PAGE_SHIFT);
+	return true;
+}
+
 void Init()
 {
 	bool wii = SConfig::GetInstance().m_LocalCoreStartupParameter.bWii;
@@ -353,6 +492,9 @@ void Init()
 	else
 		InitHWMemFuncs();
 
+	InvalidateSoftTLB();
+	InitWriteWatch(wii);
+
 	INFO_LOG(MEMMAP, "Memory system initialized. RAM at %p (mirrors at 0 @ %p, 0x80000000 @ %p , 0xC0000000 @ %p)",
 		m_pRAM, m_pPhysicalRAM, m_pVirtualCachedRAM, m_pVirtualUncachedRAM);
 	m_IsInitialized = true;
@@ -361,21 +503,27 @@ void Init()
 void DoState(PointerWrap &p)
 {
 	bool wii = SConfig::GetInstance().m_LocalCoreStartupParameter.bWii;
-	p.DoArray(m_pPhysicalRAM, RAM_SIZE);
+	if (s_ram_in_state)
+		p.DoArray(m_pPhysicalRAM, RAM_SIZE);
 //	p.DoArray(m_pVirtualEFB, EFB_SIZE);
 	p.DoArray(m_pVirtualL1Cache, L1_CACHE_SIZE);
 	p.DoMarker("Memory RAM");
 	if (bFakeVMEM)
 		p.DoArray(m_pVirtualFakeVMEM, FAKEVMEM_SIZE);
 	p.DoMarker("Memory FakeVMEM");
-	if (wii)
+	if (wii && s_ram_in_state)
 		p.DoArray(m_pEXRAM, EXRAM_SIZE);
 	p.DoMarker("Memory EXRAM");
+
+	// The segment registers and BATs come from the state, so cached translations are stale.
+	if (p.GetMode() == PointerWrap::MODE_READ)
+		InvalidateSoftTLB();
 }
 
 void Shutdown()
 {
 	m_IsInitialized = false;
+	ShutdownWriteWatch();
 	u32 flags = 0;
 	if (SConfig::GetInstance().m_LocalCoreStartupParameter.bWii) flags |= MV_WII_ONLY;
 	if (bFakeVMEM) flags |= MV_FAKE_VMEM;
@@ -575,4 +723,162 @@ bool IsRAMAddress(const u32 addr, bool allow_locked_cache, bool allow_fake_vmem)
 	}
 }
 
+bool IsWriteWatchEnabled()
+{
+	return s_write_watch;
+}
+
+// Called with s_write_watch_lock held.
+static void WatchPages(u32 first, u32 last)
+{
+	u32 page = first;
+	while (page <= last)
+	{
+		if (s_watched[page])
+		{
+			page++;
+			continue;
+		}
+		u32 end = page;
+		while (end <= last && !s_watched[end])
+			s_watched[end++] = true;
+		ProtectWatchPages(page, end - page, true);
+		page = end;
+	}
+}
+
+// Watches [_Address, _Address + _iLength) and returns the epoch to pass to WrittenSince
+// later.  Data read from the range after this returns is current until WrittenSince says otherwise.
+bool WatchRange(const u32 _Address, const u32 _iLength, u64 &_rEpoch)
+{
+	u32 first, last;
+	if (!GetWatchPages(_Address, _iLength, first, last))
+		return false;
+
+	std::lock_guard<std::mutex> lk(s_write_watch_lock);
+	_rEpoch = s_write_epoch;
+	WatchPages(first, last);
+	return true;
+}
+
+bool WrittenSince(const u32 _Address, const u32 _iLength, const u64 _Epoch)
+{
+	u32 first, last;
+	if (!GetWatchPages(_Address, _iLength, first, last))
+		return true;
+
+	std::lock_guard<std::mutex> lk(s_write_watch_lock);
+	for (u32 page = first; page <= last; page++)
+	{
+		if (s_last_write[page] > _Epoch)
+			return true;
+	}
+	return false;
+}
+
+static void UnwatchPage(u32 page)
+{
+	ProtectWatchPages(page, 1, false);
+	s_watched[page] = false;
+	s_last_write[page] = ++s_write_epoch;
+}
+
+void MarkWritten(const u32 _Address, const u32 _iLength)
+{
+	u32 first, last;
+	if (!GetWatchPages(_Address, _iLength, first, last))
+		return;
+
+	std::lock_guard<std::mutex> lk(s_write_watch_lock);
+	for (u32 page = first; page <= last; page++)
+	{
+		if (s_watched[page])
+			UnwatchPage(page);
+	}
+}
+
+void SetRAMInState(bool _bInclude)
+{
+	s_ram_in_state = _bInclude;
+}
+
+u32 GetNumWatchPages()
+{
+	if (!s_write_watch)
+		return 0;
+	return s_watch_exram ? WATCH_PAGES : WATCH_RAM_PAGES;
+}
+
+u8 *GetWatchPagePointer(const u32 _Page)
+{
+	if (_Page < WATCH_RAM_PAGES)
+		return m_pPhysicalRAM + (_Page << WATCH_PAGE_SHIFT);
+	return m_pPhysicalEXRAM + ((_Page - WATCH_RAM_PAGES) << WATCH_PAGE_SHIFT);
+}
+
+u64 WatchAllPages()
+{
+	if (!s_write_watch)
+		return 0;
+
+	std::lock_guard<std::mutex> lk(s_write_watch_lock);
+	WatchPages(0, GetNumWatchPages() - 1);
+	return s_write_epoch;
+}
+
+void UnwatchAllPages()
+{
+	std::lock_guard<std::mutex> lk(s_write_watch_lock);
+	const u32 count = GetNumWatchPages();
+	u32 page = 0;
+	while (page < count)
+	{
+		if (!s_watched[page])
+		{
+			page++;
+			continue;
+		}
+		u32 end = page;
+		while (end < count && s_watched[end])
+			s_watched[end++] = false;
+		ProtectWatchPages(page, end - page, false);
+		page = end;
+	}
+	// stamped even if they weren't watched, nothing decoded before is current
+	s_write_epoch++;
+	std::fill(s_last_write.begin(), s_last_write.end(), s_write_epoch);
+}
+
+void GetPagesWrittenSince(const u64 _Epoch, std::vector<u32> &_rPages)
+{
+	std::lock_guard<std::mutex> lk(s_write_watch_lock);
+	const u32 count = GetNumWatchPages();
+	for (u32 page = 0; page < count; page++)
+	{
+		if (s_last_write[page] > _Epoch)
+			_rPages.push_back(page);
+	}
+}
+
+// Called from the exception handler on any thread.
+bool HandleWriteWatchFault(const u8 *_pHostAddress)
+{
+	if (!s_write_watch)
+		return false;
+
+	for (auto& view : s_watch_views)
+	{
+		if (_pHostAddress < view.ptr || _pHostAddress >= view.ptr + (view.num_pages << WATCH_PAGE_SHIFT))
+			continue;
+
+		const u32 page = view.first_page + ((u32)(_pHostAddress - view.ptr) >> WATCH_PAGE_SHIFT);
+		std::lock_guard<std::mutex> lk(s_write_watch_lock);
+		// Another thread may have faulted on the same page first; either way the write can be retried.
+		if (s_watched[page])
+			UnwatchPage(page);
+		return true;
+	}
+	return false;
+}
+
 }  // namespace
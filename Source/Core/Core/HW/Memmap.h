@@ -19,6 +19,7 @@
 
 // Includes
 #include <string>
+#include <vector>
 #include "Common.h"
 
 // Enable memory checks in the Debug/DebugFast builds, but NOT in release
@@ -168,6 +169,28 @@ void DMA_LCToMemory(const u32 _iMemAddr, const u32 _iCacheAddr, const u32 _iNumB
 void DMA_MemoryToLC(const u32 _iCacheAddr, const u32 _iMemAddr, const u32 _iNumBlocks);
 void Memset(const u32 _Address, const u8 _Data, const u32 _iLength);
 
+// Write watches tell the texture cache whether the RAM a texture was decoded
+// from has been written since, without rehashing it, and rewind which pages
+// changed between snapshots.  Anything that has the host OS write to emulated
+// RAM (file reads, sockets) must call MarkWritten first, since a system call
+// fails instead of faulting on a watched page.
+bool IsWriteWatchEnabled();
+bool WatchRange(const u32 _Address, const u32 _iLength, u64 &_rEpoch);
+bool WrittenSince(const u32 _Address, const u32 _iLength, const u64 _Epoch);
+void MarkWritten(const u32 _Address, const u32 _iLength);
+bool HandleWriteWatchFault(const u8 *_pHostAddress);
+
+// Whole-memory watches, for rewind.  Watch pages cover RAM and then EXRAM.
+enum { WRITE_WATCH_PAGE_SIZE = 0x1000 };
+u32 GetNumWatchPages();
+u8 *GetWatchPagePointer(const u32 _Page);
+u64 WatchAllPages();
+void UnwatchAllPages();
+void GetPagesWrittenSince(const u64 _Epoch, std::vector<u32> &_rPages);
+
+// Leaves RAM and EXRAM out of DoState, for callers which save them on their own.
+void SetRAMInState(bool _bInclude);
+
 // TLB functions
 void SDRUpdated();
 enum XCheckTLBFlag
@@ -179,6 +202,27 @@ enum XCheckTLBFlag
 };
 u32 TranslateAddress(u32 _Address, XCheckTLBFlag _Flag);
 void InvalidateTLBEntry(u32 _Address);
+
+// The software TLB is a direct-mapped cache of effective page -> physical page
+// translations that sits in front of the BATs and the page table walk.  There
+// is one table per access type, so a read translation never skips setting the
+// changed bit of a later write.  Jit64 probes it inline for MMU titles.
+enum
+{
+	SOFTTLB_PAGE_SHIFT = 12,
+	SOFTTLB_PAGE_SIZE  = 1 << SOFTTLB_PAGE_SHIFT,
+	SOFTTLB_PAGE_MASK  = SOFTTLB_PAGE_SIZE - 1,
+	SOFTTLB_ENTRIES    = 1024,
+};
+struct SoftTLBEntry
+{
+	// Effective page address.  Empty slots hold a page that never maps to them.
+	u32 tag;
+	// Physical page address.
+	u32 paddr;
+};
+SoftTLBEntry* GetSoftTLB(XCheckTLBFlag _Flag);
+void InvalidateSoftTLB();
 void GenerateDSIException(u32 _EffectiveAdress, bool _bWrite);
 void GenerateISIException(u32 _EffectiveAdress);
 extern u32 pagetable_base;
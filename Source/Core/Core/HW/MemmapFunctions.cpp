@@ -681,6 +681,7 @@ void SDRUpdated()
 	}
 	PowerPC::ppcState.pagetable_base = htaborg<<16;
 	PowerPC::ppcState.pagetable_hashmask = ((xx<<10)|0x3ff);
+	InvalidateSoftTLB();
 }
 
 
@@ -711,6 +712,49 @@ typedef struct tlb_entry
 static tlb_entry tlb[NUM_TLBS][TLB_SIZE/TLB_WAYS][TLB_WAYS];
 #endif
 
+// Software TLB, indexed by [access type][effective page]
+static SoftTLBEntry soft_tlb[3][SOFTTLB_ENTRIES];
+
+static inline u32 SoftTLBIndex(const u32 vpa)
+{
+	return (vpa >> SOFTTLB_PAGE_SHIFT) & (SOFTTLB_ENTRIES - 1);
+}
+
+SoftTLBEntry* GetSoftTLB(const XCheckTLBFlag _Flag)
+{
+	switch (_Flag)
+	{
+	case FLAG_WRITE:  return soft_tlb[1];
+	case FLAG_OPCODE: return soft_tlb[2];
+	default:          return soft_tlb[0];
+	}
+}
+
+static inline void ClearSoftTLBEntry(SoftTLBEntry *tlbe, const u32 index)
+{
+	// The JIT compares tags with a single XOR, so an empty slot has to hold a
+	// page that can never be looked up through it.
+	tlbe->tag = ((index ^ 1) << SOFTTLB_PAGE_SHIFT);
+	tlbe->paddr = 0;
+}
+
+void InvalidateSoftTLB()
+{
+	for (auto& table : soft_tlb)
+		for (u32 i = 0; i < SOFTTLB_ENTRIES; i++)
+			ClearSoftTLBEntry(&table[i], i);
+}
+
+static void InvalidateSoftTLBEntry(const u32 vpa)
+{
+	const u32 index = SoftTLBIndex(vpa);
+	for (auto& table : soft_tlb)
+	{
+		if (table[index].tag == (vpa & ~SOFTTLB_PAGE_MASK))
+			ClearSoftTLBEntry(&table[index], index);
+	}
+}
+
 u32 LookupTLBPageAddress(const XCheckTLBFlag _Flag, const u32 vpa, u32 *paddr)
 {
 #ifdef FAST_TLB_CACHE
@@ -800,6 +844,8 @@ void UpdateTLBEntry(const XCheckTLBFlag _Flag, UPTE2 PTE2, const u32 vpa)
 
 void InvalidateTLBEntry(u32 vpa)
 {
+	InvalidateSoftTLBEntry(vpa);
+
 #ifdef FAST_TLB_CACHE
 	tlb_entry *tlbe = tlb[0][(vpa>>HW_PAGE_INDEX_SHIFT)&HW_PAGE_INDEX_MASK];
 	if(tlbe[0].tag == (vpa & ~0xfff))
@@ -999,20 +1045,22 @@ u32 TranslateAddress(const u32 _Address, const XCheckTLBFlag _Flag)
 	// Check MSR[DR] bit before translating data addresses
 	//if (((_Flag == FLAG_READ) || (_Flag == FLAG_WRITE)) && !(MSR & (1 << (31 - 27)))) return _Address;
 
+	SoftTLBEntry *tlbe = &GetSoftTLB(_Flag)[SoftTLBIndex(_Address)];
+	if (tlbe->tag == (_Address & ~SOFTTLB_PAGE_MASK))
+		return tlbe->paddr | (_Address & SOFTTLB_PAGE_MASK);
+
 	u32 tlb_addr = TranslateBlockAddress(_Address, _Flag);
 	if (tlb_addr == 0)
-	{
 		tlb_addr = TranslatePageAddress(_Address, _Flag);
-		if (tlb_addr != 0)
-		{
-			return tlb_addr;
-		}
-	}
-	else
+
+	// Debugger accesses don't update the referenced bits, so don't let them
+	// fill the TLB either.
+	if (tlb_addr != 0 && _Flag != FLAG_NO_EXCEPTION)
 	{
-		return tlb_addr;
+		tlbe->tag = _Address & ~SOFTTLB_PAGE_MASK;
+		tlbe->paddr = tlb_addr & ~SOFTTLB_PAGE_MASK;
 	}
 
-	return 0;
+	return tlb_addr;
 }
 } // namespace
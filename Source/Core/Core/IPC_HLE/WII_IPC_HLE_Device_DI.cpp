@@ -181,6 +181,7 @@ u32 CWII_IPC_HLE_Device_di::ExecuteCommand(u32 _BufferIn, u32 _BufferInSize, u32
 
 	case DVDLowReadDiskID:
 		{
+			Memory::MarkWritten(_BufferOut, _BufferOutSize);
 			VolumeHandler::RAWReadToPtr(Memory::GetPointer(_BufferOut), 0, _BufferOutSize);
 
 			INFO_LOG(WII_IPC_DVD, "DVDLowReadDiskID %s",
@@ -223,6 +224,7 @@ u32 CWII_IPC_HLE_Device_di::ExecuteCommand(u32 _BufferIn, u32 _BufferInSize, u32
 				Size = _BufferOutSize;
 			}
 
+			Memory::MarkWritten(_BufferOut, Size);
 			if (!VolumeHandler::ReadToPtr(Memory::GetPointer(_BufferOut), DVDAddress, Size))
 			{
 				PanicAlertT("DVDLowRead - Fatal Error: failed to read from volume");
@@ -317,6 +319,7 @@ u32 CWII_IPC_HLE_Device_di::ExecuteCommand(u32 _BufferIn, u32 _BufferInSize, u32
 				PanicAlertT("Detected attempt to read more data from the DVD than fit inside the out buffer. Clamp.");
 				Size = _BufferOutSize;
 			}
+			Memory::MarkWritten(_BufferOut, Size);
 			if(!VolumeHandler::RAWReadToPtr(Memory::GetPointer(_BufferOut), DVDAddress, Size))
 			{
 				PanicAlertT("DVDLowUnencryptedRead - Fatal Error: failed to read from volume");
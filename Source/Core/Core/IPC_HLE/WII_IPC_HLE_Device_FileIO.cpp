@@ -224,6 +224,7 @@ bool CWII_IPC_HLE_Device_FileIO::Read(u32 _CommandAddress)
 		{
 			INFO_LOG(WII_IPC_FILEIO, "FileIO: Read 0x%x bytes to 0x%08x from %s", Size, Address, m_Name.c_str());
 			file.Seek(m_SeekPos, SEEK_SET);
+			Memory::MarkWritten(Address, Size);
 			ReturnValue = (u32)fread(Memory::GetPointer(Address), 1, Size, file.GetHandle());
 			if (ReturnValue != Size && ferror(file.GetHandle()))
 			{
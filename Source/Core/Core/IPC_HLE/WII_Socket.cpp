@@ -374,6 +374,7 @@ void WiiSocket::update(bool read, bool write, bool except)
 					}
 					case IOCTLV_NET_SSL_READ:
 					{
+						Memory::MarkWritten(BufferIn2, BufferInSize2);
 						int ret = ssl_read(&CWII_IPC_HLE_Device_net_ssl::_SSL[sslID].ctx, Memory::GetPointer(BufferIn2), BufferInSize2);
 #ifdef DEBUG_SSL
 						if (ret > 0)
@@ -485,6 +486,7 @@ void WiiSocket::update(bool read, bool write, bool except)
 					}
 #endif
 					socklen_t addrlen = sizeof(sockaddr_in);
+					Memory::MarkWritten(BufferOut, BufferOutSize);
 					int ret = recvfrom(fd, data, data_len, flags,
 									BufferOutSize2 ? (struct sockaddr*) &local_name : NULL,
 									BufferOutSize2 ? &addrlen : 0);
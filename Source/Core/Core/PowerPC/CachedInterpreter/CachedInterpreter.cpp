@@ -0,0 +1,219 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include "CachedInterpreter.h"
+#include "../PowerPC.h"
+#include "../PPCTables.h"
+#include "../../ConfigManager.h"
+#include "../../CoreTiming.h"
+#include "../../PatchEngine.h"
+#include "../../HLE/HLE.h"
+#include "../JitCommon/JitWarmStart.h"
+
+void CachedInterpreter::Init()
+{
+	jo.enableBlocklink = false;
+
+	code.reserve(CODE_SIZE);
+	blocks.Init();
+}
+
+void CachedInterpreter::Shutdown()
+{
+	blocks.Shutdown();
+}
+
+void CachedInterpreter::ClearCache()
+{
+	blocks.Clear();
+	code.clear();
+}
+
+void CachedInterpreter::Run()
+{
+	while (!PowerPC::GetState())
+	{
+		while (CoreTiming::downcount > 0 && !PowerPC::GetState())
+			ExecuteOneBlock();
+
+		// Stopped at a breakpoint
+		if (PowerPC::GetState())
+			return;
+
+		CoreTiming::Advance();
+
+		if (PowerPC::ppcState.Exceptions)
+		{
+			PowerPC::CheckExceptions();
+			PC = NPC;
+		}
+	}
+}
+
+void CachedInterpreter::SingleStep()
+{
+	Interpreter::getInstance()->SingleStep();
+}
+
+void CachedInterpreter::ExecuteOneBlock()
+{
+	int block_num = blocks.GetBlockNumberFromStartAddress(PC);
+	if (block_num < 0)
+	{
+		JitWarmStart::CompilePending();
+		Jit(PC);
+		block_num = blocks.GetBlockNumberFromStartAddress(PC);
+		if (block_num < 0)
+		{
+			// Nothing could be fetched from here, let the interpreter raise the exception.
+			Interpreter::m_EndBlock = false;
+			CoreTiming::downcount -= Interpreter::getInstance()->SingleStepInner();
+			return;
+		}
+	}
+
+	Interpreter::m_EndBlock = false;
+
+	const Instruction *inst = (const Instruction *)blocks.GetBlock(block_num)->normalEntry;
+	for (; inst->callback; inst++)
+	{
+		PC = inst->address;
+		NPC = PC + 4;
+
+		if (inst->flags & (FLAG_CHECK_BREAKPOINT | FLAG_CHECK_FPU))
+		{
+			if (inst->flags & FLAG_CHECK_BREAKPOINT)
+			{
+				PowerPC::CheckBreakPoints();
+				if (PowerPC::GetState())
+					return;
+			}
+			if ((inst->flags & FLAG_CHECK_FPU) && !((UReg_MSR&)MSR).FP)
+			{
+				Common::AtomicOr(PowerPC::ppcState.Exceptions, EXCEPTION_FPU_UNAVAILABLE);
+				PowerPC::CheckExceptions();
+				break;
+			}
+		}
+
+		inst->callback(inst->data);
+
+		if (inst->flags)
+		{
+			if ((inst->flags & FLAG_CHECK_DSI) && (PowerPC::ppcState.Exceptions & EXCEPTION_DSI))
+			{
+				PowerPC::CheckExceptions();
+				break;
+			}
+			if (inst->flags & FLAG_HLE_HOOK_REPLACE)
+				break;
+			if (inst->flags & FLAG_HLE_HOOK_START)
+			{
+				// The original instruction is next.
+				Interpreter::m_EndBlock = false;
+				continue;
+			}
+		}
+
+		if (Interpreter::m_EndBlock)
+		{
+			// Branches the analyzer followed, and conditional ones that weren't
+			// taken, continue with the next instruction of the block.
+			if (!inst[1].callback || inst[1].address != NPC)
+				break;
+			Interpreter::m_EndBlock = false;
+		}
+	}
+
+	CoreTiming::downcount -= inst->cycles;
+	PC = NPC;
+}
+
+void CachedInterpreter::Jit(u32 em_address)
+{
+	// Blocks that can't be fetched are left to the interpreter, which raises the ISI.
+	if (em_address == 0)
+		return;
+	if (Core::g_CoreStartupParameter.bMMU && (em_address & JIT_ICACHE_VMEM_BIT) &&
+	    !Memory::TranslateAddress(em_address, Memory::FLAG_OPCODE))
+		return;
+
+	int size = 0;
+	bool broken_block = false;
+	u32 merged_addresses[32];
+	const int capacity_of_merged_addresses = sizeof(merged_addresses) / sizeof(merged_addresses[0]);
+	int size_of_merged_addresses = 0;
+	PPCAnalyst::Flatten(em_address, &size, &js.st, &js.gpa, &js.fpa, broken_block, &code_buffer,
+	                    code_buffer.GetSize(), merged_addresses, capacity_of_merged_addresses, size_of_merged_addresses);
+	if (size == 0)
+		return;
+
+	// Every instruction may get an HLE call in front of it, plus the terminator.
+	if (code.size() + 2 * size + 1 > CODE_SIZE || blocks.IsFull() || Core::g_CoreStartupParameter.bJITNoBlockCache)
+		ClearCache();
+
+	int block_num = blocks.AllocateBlock(em_address);
+	JitBlock *b = blocks.GetBlock(block_num);
+	const size_t start = code.size();
+	b->checkedEntry = (const u8 *)(code.data() + start);
+	b->normalEntry = b->checkedEntry;
+	b->runCount = 0;
+
+	u32 cycles = 0;
+	if (!Core::g_CoreStartupParameter.bEnableDebugging)
+	{
+		for (int i = 0; i < size_of_merged_addresses; ++i)
+			cycles += PatchEngine::GetSpeedhackCycles(merged_addresses[i]);
+	}
+
+	bool fpu_checked = false;
+	for (int i = 0; i < size; i++)
+	{
+		const PPCAnalyst::CodeOp &op = code_buffer.codebuffer[i];
+		cycles += op.opinfo->numCyclesMinusOne + 1;
+
+		u32 function = HLE::GetFunctionIndex(op.address);
+		if (function != 0)
+		{
+			int type = HLE::GetFunctionTypeByIndex(function);
+			if (type == HLE::HLE_HOOK_START || type == HLE::HLE_HOOK_REPLACE)
+			{
+				int flags = HLE::GetFunctionFlagsByIndex(function);
+				if (HLE::IsEnabled(flags))
+				{
+					Instruction hle = {Interpreter::HLEFunction, function, op.address, cycles,
+					                   type == HLE::HLE_HOOK_REPLACE ? (u32)FLAG_HLE_HOOK_REPLACE : (u32)FLAG_HLE_HOOK_START};
+					code.push_back(hle);
+					if (type == HLE::HLE_HOOK_REPLACE)
+						break;
+				}
+			}
+		}
+
+		if (op.skip)
+			continue;
+
+		u32 flags = 0;
+		if ((op.opinfo->flags & FL_USE_FPU) && !fpu_checked)
+		{
+			// MSR[FP] can only change at the end of a block.
+			flags |= FLAG_CHECK_FPU;
+			fpu_checked = true;
+		}
+		if (op.opinfo->flags & FL_LOADSTORE)
+			flags |= FLAG_CHECK_DSI;
+		if (Core::g_CoreStartupParameter.bEnableDebugging && PowerPC::breakpoints.IsAddressBreakPoint(op.address))
+			flags |= FLAG_CHECK_BREAKPOINT;
+
+		Instruction inst = {GetInterpreterOp(op.inst), op.inst, op.address, cycles, flags};
+		code.push_back(inst);
+	}
+
+	Instruction end = {NULL, 0, 0, cycles, 0};
+	code.push_back(end);
+
+	b->codeSize = (u32)((code.size() - start) * sizeof(Instruction));
+	b->originalSize = size;
+	blocks.FinalizeBlock(block_num, jo.enableBlocklink, b->normalEntry);
+}
@@ -0,0 +1,82 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <vector>
+
+#include "../PPCAnalyst.h"
+#include "../Interpreter/Interpreter.h"
+#include "../JitCommon/JitBase.h"
+#include "../JitCommon/JitCache.h"
+
+// An interpreter that decodes each guest block once into an array of
+// interpreter handlers with their operands, and replays that array on later
+// visits instead of fetching and dispatching every instruction again.
+// Blocks live in the regular JIT block cache, so icbi, DMA and breakpoint
+// invalidation work exactly like they do for the recompilers.
+class CachedInterpreter : public JitBase
+{
+public:
+	CachedInterpreter() : code_buffer(32000) {}
+
+	void Init() override;
+	void Shutdown() override;
+
+	void ClearCache() override;
+
+	void Run() override;
+	void SingleStep() override;
+
+	void Jit(u32 em_address) override;
+
+	JitBaseBlockCache *GetBlockCache() override { return &blocks; }
+
+	const char *GetName() override { return "Cached Interpreter"; }
+
+	// There's no host code, so there's nothing to backpatch.
+	const u8 *BackPatch(u8 *codePtr, u32 em_address, void *ctx) override { return NULL; }
+	const CommonAsmRoutinesBase *GetAsmRoutines() override { return NULL; }
+	bool IsInCodeSpace(u8 *ptr) override { return false; }
+
+private:
+	enum
+	{
+		CODE_SIZE = 1024 * 256, // in instructions
+	};
+
+	enum InstructionFlags
+	{
+		FLAG_CHECK_FPU        = (1 << 0), // first FPU instruction of the block
+		FLAG_CHECK_DSI        = (1 << 1), // loads and stores
+		FLAG_CHECK_BREAKPOINT = (1 << 2),
+		FLAG_HLE_HOOK_START   = (1 << 3), // HLE call that runs the original afterwards
+		FLAG_HLE_HOOK_REPLACE = (1 << 4), // HLE call that returns in place of the original
+	};
+
+	struct Instruction
+	{
+		// NULL marks the end of the block.
+		Interpreter::_interpreterInstruction callback;
+		UGeckoInstruction data;
+		u32 address;
+		// Cycles to charge if the block is left after this instruction.
+		u32 cycles;
+		u32 flags;
+	};
+
+	class BlockCache : public JitBaseBlockCache
+	{
+	private:
+		// Blocks are never linked, every exit goes back to ExecuteOneBlock().
+		void WriteLinkBlock(u8* location, const u8* address) override {}
+		void WriteDestroyBlock(const u8* location, u32 address) override {}
+	};
+
+	void ExecuteOneBlock();
+
+	BlockCache blocks;
+	std::vector<Instruction> code;
+	PPCAnalyst::CodeBuffer code_buffer;
+};
@@ -178,6 +178,7 @@ void Jit64::Init()
 
 	trampolines.Init();
 	AllocCodeSpace(CODE_SIZE);
+	m_code_region = 0;
 
 	blocks.Init();
 	asm_routines.Init();
@@ -188,6 +189,22 @@ void Jit64::ClearCache()
 	blocks.Clear();
 	trampolines.ClearCodeSpace();
 	ClearCodeSpace();
+	m_code_region = 0;
+}
+
+// The code space is filled one region at a time. Once the last one is full
+// we wrap around and evict the oldest region, so only the blocks that went
+// cold since the region was written get lost. Anything still hot is simply
+// recompiled into the current region the next time it runs.
+void Jit64::NextCodeRegion()
+{
+	const size_t size = CODE_SIZE / NUM_CODE_REGIONS;
+
+	m_code_region = (m_code_region + 1) % NUM_CODE_REGIONS;
+	u8 *start = region + m_code_region * size;
+	blocks.EvictBlocksInRange(start, start + size);
+	memset(start, 0xCC, size);
+	SetCodePtr(start);
 }
 
 void Jit64::Shutdown()
@@ -287,6 +304,11 @@ void Jit64::WriteExit(u32 destination, int exit_num)
 	b->exitAddress[exit_num] = destination;
 	b->exitPtrs[exit_num] = GetWritableCodePtr();
 
+	// Always emit the unlinked exit, so that it can be restored when the
+	// destination gets evicted.
+	MOV(32, M(&PC), Imm32(destination));
+	JMP(asm_routines.dispatcher, true);
+
 	// Link opportunity!
 	if (jo.enableBlocklink)
 	{
@@ -294,13 +316,11 @@ void Jit64::WriteExit(u32 destination, int exit_num)
 		if (block >= 0)
 		{
 			// It exists! Joy of joy!
-			JMP(blocks.GetBlock(block)->checkedEntry, true);
+			XEmitter emit(b->exitPtrs[exit_num]);
+			emit.JMP(blocks.GetBlock(block)->checkedEntry, true);
 			b->linkStatus[exit_num] = true;
-			return;
 		}
 	}
-	MOV(32, M(&PC), Imm32(destination));
-	JMP(asm_routines.dispatcher, true);
 }
 
 void Jit64::WriteExitDestInEAX()
@@ -341,6 +361,18 @@ void Jit64::WriteExternalExceptionExit()
 	JMP(asm_routines.dispatcher, true);
 }
 
+// Taken branch of a busy wait loop: nothing can change until the next event,
+// so skip to it, then leave through doTiming so that the interrupt it has most
+// likely raised and any change of the CPU state are noticed.
+void Jit64::WriteIdleExit(u32 destination)
+{
+	Cleanup();
+	SUB(32, M(&CoreTiming::downcount), js.downcountAmount > 127 ? Imm32(js.downcountAmount) : Imm8(js.downcountAmount));
+	ABI_CallFunction((void *)&CoreTiming::Idle);
+	MOV(32, M(&PC), Imm32(destination));
+	JMP(asm_routines.doTiming, true);
+}
+
 void STACKALIGN Jit64::Run()
 {
 	CompiledCode pExecAddr = (CompiledCode)asm_routines.enterCode;
@@ -384,10 +416,18 @@ void Jit64::Trace()
 
 void STACKALIGN Jit64::Jit(u32 em_address)
 {
-	if (GetSpaceLeft() < 0x10000 || blocks.IsFull() || Core::g_CoreStartupParameter.bJITNoBlockCache)
+	if (trampolines.GetSpaceLeft() < 0x10000 || Core::g_CoreStartupParameter.bJITNoBlockCache)
 	{
 		ClearCache();
 	}
+	else
+	{
+		const u8 *region_end = region + (m_code_region + 1) * (CODE_SIZE / NUM_CODE_REGIONS);
+		if (GetCodePtr() + 0x10000 > region_end)
+			NextCodeRegion();
+		for (int i = 0; i < NUM_CODE_REGIONS && blocks.IsFull(); i++)
+			NextCodeRegion();
+	}
 
 	int block_num = blocks.AllocateBlock(em_address);
 	JitBlock *b = blocks.GetBlock(block_num);
@@ -473,14 +513,16 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer *code_buf, JitBloc
 
 	// Conditionally add profiling code.
 	if (Profiler::g_ProfileBlocks) {
+#ifdef _M_X64
+		// The block may be out of RIP-relative range.
+		MOV(64, R(RAX), ImmPtr(&b->runCount));
+		ADD(32, MatR(RAX), Imm8(1));
+#else
 		ADD(32, M(&b->runCount), Imm8(1));
-#ifdef _WIN32
+#endif
 		b->ticCounter = 0;
 		b->ticStart = 0;
 		b->ticStop = 0;
-#else
-//TODO
-#endif
 		// get start tic
 		PROFILER_QUERY_PERFORMANCE_COUNTER(&b->ticStart);
 	}
@@ -47,6 +47,13 @@ private:
 	PPCAnalyst::CodeBuffer code_buffer;
 	Jit64AsmRoutineManager asm_routines;
 
+	// The code space is split into this many regions, which are evicted
+	// oldest first when it fills up, instead of clearing the whole cache.
+	enum { NUM_CODE_REGIONS = 8 };
+	int m_code_region;
+
+	void NextCodeRegion();
+
 public:
 	Jit64() : code_buffer(32000) {}
 	~Jit64() {}
@@ -92,6 +99,7 @@ public:
 	void WriteExitDestInEAX();
 	void WriteExceptionExit();
 	void WriteExternalExceptionExit();
+	void WriteIdleExit(u32 destination);
 	void WriteRfiExitDestInEAX();
 	void WriteCallInterpreter(UGeckoInstruction _inst);
 	void Cleanup();
@@ -83,11 +83,13 @@ void Jit64::bx(UGeckoInstruction inst)
 	if (inst.LK)
 		AND(32, M(&PowerPC::ppcState.cr), Imm32(~(0xFF000000)));
 #endif
+	if (destination == js.blockStart && js.st.isBusyWaitLoop)
+	{
+		WriteIdleExit(destination);
+		return;
+	}
 	if (destination == js.compilerPC)
 	{
-		//PanicAlert("Idle loop detected at %08x", destination);
-		//	CALL(ProtectFunction(&CoreTiming::Idle, 0));
-		//	JMP(Asm::testExceptions, true);
 		// make idle loops go faster
 		js.downcountAmount += 8;
 	}
@@ -136,7 +138,10 @@ void Jit64::bcx(UGeckoInstruction inst)
 		destination = SignExt16(inst.BD << 2);
 	else
 		destination = js.compilerPC + SignExt16(inst.BD << 2);
-	WriteExit(destination, 0);
+	if (destination == js.blockStart && js.st.isBusyWaitLoop)
+		WriteIdleExit(destination);
+	else
+		WriteExit(destination, 0);
 
 	if ((inst.BO & BO_DONT_CHECK_CONDITION) == 0)
 		SetJumpTarget( pConditionDontBranch );
@@ -115,8 +115,12 @@ void Jit64::GenerateCarry()
 }
 
 // Assumes that Sign and Zero flags were set by the last operation. Preserves all flags and registers.
+// Like ComputeRC, does nothing if the block overwrites CR0 before reading it.
 void Jit64::GenerateRC()
 {
+	if (!js.op->wantsCR0)
+		return;
+
 	FixupBranch pZero  = J_CC(CC_Z);
 	FixupBranch pNegative = J_CC(CC_S);
 	MOV(8, M(&PowerPC::ppcState.cr_fast[0]), Imm8(0x4)); // Result > 0
@@ -135,6 +139,9 @@ void Jit64::GenerateRC()
 
 void Jit64::ComputeRC(const Gen::OpArg & arg)
 {
+	if (!js.op->wantsCR0)
+		return;
+
 	if( arg.IsImm() )
 	{
 		s32 value = (s32)arg.offset;
@@ -292,8 +299,9 @@ void Jit64::reg_imm(UGeckoInstruction inst)
 	case 29: regimmop(a, s, true, inst.UIMM << 16, And, &XEmitter::AND, true); break;
 	case 26: regimmop(a, s, true, inst.UIMM,       Xor, &XEmitter::XOR, false); break; //xori
 	case 27: regimmop(a, s, true, inst.UIMM << 16, Xor, &XEmitter::XOR, false); break; //xoris
-	case 12: regimmop(d, a, false, (u32)(s32)inst.SIMM_16, Add, &XEmitter::ADD, false, true); break; //addic
-	case 13: regimmop(d, a, true, (u32)(s32)inst.SIMM_16, Add, &XEmitter::ADD, true, true); break; //addic_rc
+	// addic reads rA even when it is r0, hence binary.  It is a plain add when nothing reads the carry.
+	case 12: regimmop(d, a, true, (u32)(s32)inst.SIMM_16, Add, &XEmitter::ADD, false, js.op->wantsCA); break; //addic
+	case 13: regimmop(d, a, true, (u32)(s32)inst.SIMM_16, Add, &XEmitter::ADD, true, js.op->wantsCA); break; //addic_rc
 	default:
 		Default(inst);
 		break;
@@ -867,9 +875,33 @@ void Jit64::subfic(UGeckoInstruction inst)
 	INSTRUCTION_START
 	JITDISABLE(bJITIntegerOff)
 	int a = inst.RA, d = inst.RD;
+	int imm = inst.SIMM_16;
+	if (!js.op->wantsCA)
+	{
+		// Nothing reads the carry, so this is just d = imm - a
+		if (gpr.R(a).IsImm())
+		{
+			gpr.SetImmediate32(d, (u32)imm - (u32)gpr.R(a).offset);
+			return;
+		}
+		gpr.Lock(a, d);
+		gpr.BindToRegister(d, a == d, true);
+		if (d == a)
+		{
+			NEG(32, gpr.R(d));
+			if (imm != 0)
+				ADD(32, gpr.R(d), Imm32(imm));
+		}
+		else
+		{
+			MOV(32, gpr.R(d), Imm32(imm));
+			SUB(32, gpr.R(d), gpr.R(a));
+		}
+		gpr.UnlockAll();
+		return;
+	}
 	gpr.Lock(a, d);
 	gpr.BindToRegister(d, a == d, true);
-	int imm = inst.SIMM_16;
 	if (d == a)
 	{
 		if (imm == 0)
@@ -921,7 +953,9 @@ void Jit64::subfcx(UGeckoInstruction inst)
 	gpr.Lock(a, b, d);
 	gpr.BindToRegister(d, (d == a || d == b), true);
 
-	JitClearCAOV(inst.OE);
+	bool carry = js.op->wantsCA || inst.OE;
+	if (carry)
+		JitClearCAOV(inst.OE);
 	if (d == b)
 	{
 		SUB(32, gpr.R(d), gpr.R(a));
@@ -940,7 +974,8 @@ void Jit64::subfcx(UGeckoInstruction inst)
 	if (inst.Rc) {
 		GenerateRC();
 	}
-	FinalizeCarryOverflow(inst.OE, true);
+	if (carry)
+		FinalizeCarryOverflow(inst.OE, true);
 
 	gpr.UnlockAll();
 }
@@ -1570,33 +1605,38 @@ void Jit64::addcx(UGeckoInstruction inst)
 	INSTRUCTION_START
 	JITDISABLE(bJITIntegerOff)
 	int a = inst.RA, b = inst.RB, d = inst.RD;
+	bool carry = js.op->wantsCA || inst.OE;
 
 	if ((d == a) || (d == b))
 	{
 		int operand = ((d == a) ? b : a);
 		gpr.Lock(a, b, d);
 		gpr.BindToRegister(d, true);
-		JitClearCAOV(inst.OE);
+		if (carry)
+			JitClearCAOV(inst.OE);
 		ADD(32, gpr.R(d), gpr.R(operand));
 		if (inst.Rc)
 		{
 			GenerateRC();
 		}
-		FinalizeCarryOverflow(inst.OE);
+		if (carry)
+			FinalizeCarryOverflow(inst.OE);
 		gpr.UnlockAll();
 	}
 	else
 	{
 		gpr.Lock(a, b, d);
 		gpr.BindToRegister(d, false);
-		JitClearCAOV(inst.OE);
+		if (carry)
+			JitClearCAOV(inst.OE);
 		MOV(32, gpr.R(d), gpr.R(a));
 		ADD(32, gpr.R(d), gpr.R(b));
 		if (inst.Rc)
 		{
 			GenerateRC();
 		}
-		FinalizeCarryOverflow(inst.OE);
+		if (carry)
+			FinalizeCarryOverflow(inst.OE);
 		gpr.UnlockAll();
 	}
 }
@@ -2086,7 +2126,26 @@ void Jit64::srawix(UGeckoInstruction inst)
 	int a = inst.RA;
 	int s = inst.RS;
 	int amount = inst.SH;
-	if (amount != 0)
+	if (amount != 0 && !js.op->wantsCA)
+	{
+		// Nothing reads the carry, so this is a plain arithmetic shift
+		if (gpr.R(s).IsImm())
+		{
+			gpr.SetImmediate32(a, (u32)((s32)gpr.R(s).offset >> amount));
+			if (inst.Rc)
+				ComputeRC(gpr.R(a));
+			return;
+		}
+		gpr.Lock(a, s);
+		gpr.BindToRegister(a, a == s, true);
+		if (a != s)
+			MOV(32, gpr.R(a), gpr.R(s));
+		SAR(32, gpr.R(a), Imm8(amount));
+		if (inst.Rc)
+			GenerateRC();
+		gpr.UnlockAll();
+	}
+	else if (amount != 0)
 	{
 		gpr.Lock(a, s);
 		gpr.BindToRegister(a, a == s, true);
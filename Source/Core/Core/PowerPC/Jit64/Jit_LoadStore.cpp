@@ -90,50 +90,6 @@ void Jit64::lXXx(UGeckoInstruction inst)
 		PanicAlert("Invalid instruction");
 	}
 
-	// TODO(ector): Make it dynamically enable/disable idle skipping where appropriate
-	// Will give nice boost to dual core mode
-	// (mb2): I agree,
-	// IMHO those Idles should always be skipped and replaced by a more controllable "native" Idle methode
-	// ... maybe the throttle one already do that :p
-	// if (CommandProcessor::AllowIdleSkipping() && PixelEngine::AllowIdleSkipping())
-	if (SConfig::GetInstance().m_LocalCoreStartupParameter.bSkipIdle &&
-		inst.OPCD == 32 &&
-		(inst.hex & 0xFFFF0000) == 0x800D0000 &&
-		(Memory::ReadUnchecked_U32(js.compilerPC + 4) == 0x28000000 ||
-		(SConfig::GetInstance().m_LocalCoreStartupParameter.bWii && Memory::ReadUnchecked_U32(js.compilerPC + 4) == 0x2C000000)) &&
-		Memory::ReadUnchecked_U32(js.compilerPC + 8) == 0x4182fff8)
-	{
-		// TODO(LinesPrower):
-		// - Rewrite this!
-		// It seems to be ugly and inefficient, but I don't know JIT stuff enough to make it right
-		// It only demonstrates the idea
-
-		// do our job at first
-		s32 offset = (s32)(s16)inst.SIMM_16;
-		gpr.BindToRegister(d, false, true);
-		SafeLoadToReg(gpr.RX(d), gpr.R(a), accessSize, offset, RegistersInUse(), signExtend);
-
-		// if it's still 0, we can wait until the next event
-		TEST(32, gpr.R(d), gpr.R(d));
-		FixupBranch noIdle = J_CC(CC_NZ);
-
-		u32 registersInUse = RegistersInUse();
-		ABI_PushRegistersAndAdjustStack(registersInUse, false);
-
-		ABI_CallFunctionC((void *)&PowerPC::OnIdle, PowerPC::ppcState.gpr[a] + (s32)(s16)inst.SIMM_16);
-
-		ABI_PopRegistersAndAdjustStack(registersInUse, false);
-
-		// ! we must continue executing of the loop after exception handling, maybe there is still 0 in r0
-		//MOV(32, M(&PowerPC::ppcState.pc), Imm32(js.compilerPC));
-		WriteExceptionExit();
-
-		SetJumpTarget(noIdle);
-
-		//js.compilerPC += 8;
-		return;
-	}
-
 	// Determine whether this instruction updates inst.RA
 	bool update;
 	if (inst.OPCD == 31)
@@ -163,7 +119,14 @@ void Jit64::lXXx(UGeckoInstruction inst)
 	}
 	else
 	{
-		if ((inst.OPCD != 31) && gpr.R(a).IsImm() && !js.memcheck)
+		if (js.op->knownAddress && !js.memcheck)
+		{
+			// The analyzer knows the address even if the register cache has lost it
+			opAddress = Imm32(js.op->effectiveAddress);
+			if (update)
+				gpr.SetImmediate32(a, js.op->effectiveAddress);
+		}
+		else if ((inst.OPCD != 31) && gpr.R(a).IsImm() && !js.memcheck)
 		{
 			u32 val = (u32)gpr.R(a).offset + (s32)inst.SIMM_16;
 			opAddress = Imm32(val);
@@ -274,12 +237,16 @@ void Jit64::stX(UGeckoInstruction inst)
 		default: _assert_msg_(DYNA_REC, 0, "AWETKLJASDLKF"); return;
 		}
 
-		if ((a == 0) || gpr.R(a).IsImm())
+		bool knownAddress = js.op->knownAddress && !js.memcheck;
+		if ((a == 0) || gpr.R(a).IsImm() || knownAddress)
 		{
 			// If we already know the address through constant folding, we can do some
 			// fun tricks...
-			u32 addr = ((a == 0) ? 0 : (u32)gpr.R(a).offset);
-			addr += offset;
+			u32 addr;
+			if (knownAddress)
+				addr = js.op->effectiveAddress;
+			else
+				addr = ((a == 0) ? 0 : (u32)gpr.R(a).offset) + offset;
 			if ((addr & 0xFFFFF000) == 0xCC008000 && jo.optimizeGatherPipe)
 			{
 				MOV(32, M(&PC), Imm32(jit->js.compilerPC)); // Helps external systems know which instruction triggered the write
@@ -411,6 +378,8 @@ void Jit64::stXx(UGeckoInstruction inst)
 		ADD(32, gpr.R(a), gpr.R(b));
 		MOV(32, R(EDX), gpr.R(a));
 		MEMCHECK_END
+	} else if (js.op->knownAddress) {
+		MOV(32, R(EDX), Imm32(js.op->effectiveAddress));
 	} else {
 		MOV(32, R(EDX), gpr.R(a));
 		ADD(32, R(EDX), gpr.R(b));
@@ -176,7 +176,6 @@ public:
 	void mcrf(UGeckoInstruction _inst);
 	void mfcr(UGeckoInstruction _inst);
 	void mtcrf(UGeckoInstruction _inst);
-	void mtsr(UGeckoInstruction _inst);
 	void mfsr(UGeckoInstruction _inst);
 	void mcrxr(UGeckoInstruction _inst);
 	void twx(UGeckoInstruction _inst);
@@ -159,14 +159,6 @@ void JitArm::mtcrf(UGeckoInstruction inst)
 	gpr.Unlock(rA);
 }
 
-void JitArm::mtsr(UGeckoInstruction inst)
-{
-	INSTRUCTION_START
-	JITDISABLE(bJITSystemRegistersOff)
-
-	STR(gpr.R(inst.RS), R9, PPCSTATE_OFF(sr[inst.SR]));
-}
-
 void JitArm::mfsr(UGeckoInstruction inst)
 {
 	INSTRUCTION_START
@@ -5,6 +5,7 @@
 #include <sstream>
 
 #include "JitBase.h"
+#include "JitWarmStart.h"
 #include "PowerPCDisasm.h"
 #include "disasm.h"
 
@@ -12,6 +13,7 @@ JitBase *jit;
 
 void Jit(u32 em_address)
 {
+	JitWarmStart::CompilePending();
 	jit->Jit(em_address);
 }
 
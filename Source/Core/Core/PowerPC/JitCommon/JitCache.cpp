@@ -9,17 +9,25 @@
 // performance hit, it's not enabled by default, but it's useful for
 // locating performance issues.
 
+#include <algorithm>
+#include <cinttypes>
+
 #include "Common.h"
 
 #ifdef _WIN32
 #include <windows.h>
+#else
+#include <unistd.h>
 #endif
 
 #include "JitBase.h"
 #include "MemoryUtil.h"
+#include "StringUtil.h"
 #include "disasm.h"
 
 #include "../JitInterface.h"
+#include "../PPCSymbolDB.h"
+#include "../../Core.h"
 
 #if defined USE_OPROFILE && USE_OPROFILE
 #include <opagent.h>
@@ -37,9 +45,128 @@ using namespace Gen;
 
 #define INVALID_EXIT 0xFFFFFFFF
 
+	JitBlockIndex::JitBlockIndex()
+		: m_free_entry(-1), m_used_slots(0), m_shift(32 - MIN_SLOT_BITS)
+	{
+		Slot empty = { EMPTY_KEY, -1 };
+		m_slots.assign(1 << MIN_SLOT_BITS, empty);
+	}
+
+	void JitBlockIndex::Clear()
+	{
+		Slot empty = { EMPTY_KEY, -1 };
+		m_slots.assign(1 << MIN_SLOT_BITS, empty);
+		m_entries.clear();
+		m_free_entry = -1;
+		m_used_slots = 0;
+		m_shift = 32 - MIN_SLOT_BITS;
+	}
+
+	int JitBlockIndex::FindSlot(u32 key) const
+	{
+		const u32 mask = (u32)m_slots.size() - 1;
+		for (u32 slot = Hash(key); ; slot = (slot + 1) & mask)
+		{
+			if (m_slots[slot].key == key)
+				return (int)slot;
+			if (m_slots[slot].key == EMPTY_KEY)
+				return -1;
+		}
+	}
+
+	void JitBlockIndex::Insert(u32 key, int block_num)
+	{
+		int slot = FindSlot(key);
+		if (slot < 0)
+		{
+			// Keep the load factor at or below one half.
+			if ((m_used_slots + 1) * 2 > m_slots.size())
+				Rehash();
+
+			const u32 mask = (u32)m_slots.size() - 1;
+			u32 s = Hash(key);
+			while (m_slots[s].key != EMPTY_KEY)
+				s = (s + 1) & mask;
+			m_slots[s].key = key;
+			m_slots[s].head = -1;
+			m_used_slots++;
+			slot = (int)s;
+		}
+
+		int e;
+		if (m_free_entry >= 0)
+		{
+			e = m_free_entry;
+			m_free_entry = m_entries[e].next;
+		}
+		else
+		{
+			e = (int)m_entries.size();
+			m_entries.push_back(Entry());
+		}
+		m_entries[e].block_num = block_num;
+		m_entries[e].next = m_slots[slot].head;
+		m_slots[slot].head = e;
+	}
+
+	void JitBlockIndex::Erase(u32 key, int block_num)
+	{
+		int slot = FindSlot(key);
+		if (slot < 0)
+			return;
+
+		// Keys whose chain runs empty stay in the table until the next rehash,
+		// so that probing never needs tombstones.
+		for (int *link = &m_slots[slot].head; *link >= 0; link = &m_entries[*link].next)
+		{
+			if (m_entries[*link].block_num == block_num)
+			{
+				int e = *link;
+				*link = m_entries[e].next;
+				m_entries[e].next = m_free_entry;
+				m_free_entry = e;
+				return;
+			}
+		}
+	}
+
+	void JitBlockIndex::Rehash()
+	{
+		std::vector<Slot> old_slots;
+		old_slots.swap(m_slots);
+
+		u32 live = 0;
+		for (auto& slot : old_slots)
+		{
+			if (slot.key != EMPTY_KEY && slot.head >= 0)
+				live++;
+		}
+
+		u32 bits = MIN_SLOT_BITS;
+		while ((1u << bits) < (live + 1) * 4)
+			bits++;
+		const u32 size = 1u << bits;
+
+		Slot empty = { EMPTY_KEY, -1 };
+		m_slots.assign(size, empty);
+		m_used_slots = 0;
+		m_shift = 32 - bits;
+
+		for (auto& slot : old_slots)
+		{
+			if (slot.key == EMPTY_KEY || slot.head < 0)
+				continue;
+			u32 s = Hash(slot.key);
+			while (m_slots[s].key != EMPTY_KEY)
+				s = (s + 1) & (size - 1);
+			m_slots[s] = slot;
+			m_used_slots++;
+		}
+	}
+
 	bool JitBaseBlockCache::IsFull() const
 	{
-		return GetNumBlocks() >= MAX_NUM_BLOCKS - 1;
+		return free_blocks.empty() && GetNumBlocks() >= MAX_NUM_BLOCKS - 1;
 	}
 
 	void JitBaseBlockCache::Init()
@@ -67,6 +194,12 @@ using namespace Gen;
 		memset(iCacheEx, JIT_ICACHE_INVALID_BYTE, JIT_ICACHEEX_SIZE);
 		memset(iCacheVMEM, JIT_ICACHE_INVALID_BYTE, JIT_ICACHE_SIZE);
 		Clear();
+
+#ifndef _WIN32
+		// perf picks up symbols for JIT code from this file by convention.
+		if (Core::g_CoreStartupParameter.bJITPerfMap)
+			perf_map.Open(StringFromFormat("/tmp/perf-%d.map", getpid()), "w");
+#endif
 	}
 
 	void JitBaseBlockCache::Shutdown()
@@ -85,6 +218,7 @@ using namespace Gen;
 		blocks = 0;
 		blockCodePointers = 0;
 		num_blocks = 0;
+		perf_map.Close();
 #if defined USE_OPROFILE && USE_OPROFILE
 		op_close_agent(agent);
 #endif
@@ -109,9 +243,10 @@ using namespace Gen;
 		{
 			DestroyBlock(i, false);
 		}
-		links_to.clear();
-		block_map.clear();
+		links_to.Clear();
+		block_pages.Clear();
 		valid_block.reset();
+		free_blocks.clear();
 		num_blocks = 0;
 		memset(blockCodePointers, 0, sizeof(u8*)*MAX_NUM_BLOCKS);
 	}
@@ -164,7 +299,18 @@ using namespace Gen;
 
 	int JitBaseBlockCache::AllocateBlock(u32 em_address)
 	{
-		JitBlock &b = blocks[num_blocks];
+		int block_num;
+		if (!free_blocks.empty())
+		{
+			block_num = free_blocks.back();
+			free_blocks.pop_back();
+		}
+		else
+		{
+			block_num = num_blocks++; //commit the current block
+		}
+
+		JitBlock &b = blocks[block_num];
 		b.invalid = false;
 		b.originalAddress = em_address;
 		b.exitAddress[0] = INVALID_EXIT;
@@ -173,8 +319,7 @@ using namespace Gen;
 		b.exitPtrs[1] = 0;
 		b.linkStatus[0] = false;
 		b.linkStatus[1] = false;
-		num_blocks++; //commit the current block
-		return num_blocks - 1;
+		return block_num;
 	}
 
 	void JitBaseBlockCache::FinalizeBlock(int block_num, bool block_link, const u8 *code_ptr)
@@ -190,19 +335,27 @@ using namespace Gen;
 		for (u32 i = 0; i < (b.originalSize + 7) / 8; ++i)
 			valid_block[pAddr / 32 + i] = true;
 
-		block_map[std::make_pair(pAddr + 4 * b.originalSize - 1, pAddr)] = block_num;
+		AddBlockPages(block_num);
 		if (block_link)
 		{
 			for (int i = 0; i < 2; i++)
 			{
 				if (b.exitAddress[i] != INVALID_EXIT)
-					links_to.insert(std::pair<u32, int>(b.exitAddress[i], block_num));
+					links_to.Insert(b.exitAddress[i], block_num);
 			}
 
 			LinkBlock(block_num);
 			LinkBlockExits(block_num);
 		}
 
+		if (perf_map)
+		{
+			const u32 size = (u32)(b.normalEntry - b.checkedEntry) + b.codeSize;
+			fprintf(perf_map.GetHandle(), "%" PRIx64 " %x EmuCode_%08x %s\n",
+			        (u64)(uintptr_t)b.checkedEntry, size, b.originalAddress,
+			        g_symbolDB.GetDescription(b.originalAddress));
+		}
+
 #if defined USE_OPROFILE && USE_OPROFILE
 		char buf[100];
 		sprintf(buf, "EmuCode%x", b.originalAddress);
@@ -234,11 +387,11 @@ using namespace Gen;
 	u32* JitBaseBlockCache::GetICachePtr(u32 addr)
 	{
 		if (addr & JIT_ICACHE_VMEM_BIT)
-			return (u32*)(jit->GetBlockCache()->iCacheVMEM + (addr & JIT_ICACHE_MASK));
+			return (u32*)(iCacheVMEM + (addr & JIT_ICACHE_MASK));
 		else if (addr & JIT_ICACHE_EXRAM_BIT)
-			return (u32*)(jit->GetBlockCache()->iCacheEx + (addr & JIT_ICACHEEX_MASK));
+			return (u32*)(iCacheEx + (addr & JIT_ICACHEEX_MASK));
 		else
-			return (u32*)(jit->GetBlockCache()->iCache + (addr & JIT_ICACHE_MASK));
+			return (u32*)(iCache + (addr & JIT_ICACHE_MASK));
 	}
 
 	int JitBaseBlockCache::GetBlockNumberFromStartAddress(u32 addr)
@@ -289,39 +442,50 @@ using namespace Gen;
 		}
 	}
 
-	using namespace std;
-
 	void JitBaseBlockCache::LinkBlock(int i)
 	{
 		LinkBlockExits(i);
 		JitBlock &b = blocks[i];
-		pair<multimap<u32, int>::iterator, multimap<u32, int>::iterator> ppp;
-		// equal_range(b) returns pair<iterator,iterator> representing the range
-		// of element with key b
-		ppp = links_to.equal_range(b.originalAddress);
-		if (ppp.first == ppp.second)
-			return;
-		for (multimap<u32, int>::iterator iter = ppp.first; iter != ppp.second; ++iter) {
-			// PanicAlert("Linking block %i to block %i", iter->second, i);
-			LinkBlockExits(iter->second);
-		}
+		links_to.ForEach(b.originalAddress, [&](int source) {
+			// PanicAlert("Linking block %i to block %i", source, i);
+			LinkBlockExits(source);
+		});
 	}
 
 	void JitBaseBlockCache::UnlinkBlock(int i)
 	{
 		JitBlock &b = blocks[i];
-		pair<multimap<u32, int>::iterator, multimap<u32, int>::iterator> ppp;
-		ppp = links_to.equal_range(b.originalAddress);
-		if (ppp.first == ppp.second)
-			return;
-		for (multimap<u32, int>::iterator iter = ppp.first; iter != ppp.second; ++iter) {
-			JitBlock &sourceBlock = blocks[iter->second];
+		links_to.ForEach(b.originalAddress, [&](int source) {
+			JitBlock &sourceBlock = blocks[source];
 			for (int e = 0; e < 2; e++)
 			{
 				if (sourceBlock.exitAddress[e] == b.originalAddress)
 					sourceBlock.linkStatus[e] = false;
 			}
-		}
+		});
+	}
+
+	// The physical range [start, end] covered by the code of a block.
+	void JitBaseBlockCache::GetPhysicalRange(const JitBlock &b, u32 *start, u32 *end) const
+	{
+		*start = b.originalAddress & 0x1FFFFFFF;
+		*end = *start + 4 * std::max<u32>(b.originalSize, 1) - 1;
+	}
+
+	void JitBaseBlockCache::AddBlockPages(int block_num)
+	{
+		u32 start, end;
+		GetPhysicalRange(blocks[block_num], &start, &end);
+		for (u32 page = start >> BLOCK_PAGE_SHIFT; page <= end >> BLOCK_PAGE_SHIFT; page++)
+			block_pages.Insert(page, block_num);
+	}
+
+	void JitBaseBlockCache::RemoveBlockPages(int block_num)
+	{
+		u32 start, end;
+		GetPhysicalRange(blocks[block_num], &start, &end);
+		for (u32 page = start >> BLOCK_PAGE_SHIFT; page <= end >> BLOCK_PAGE_SHIFT; page++)
+			block_pages.Erase(page, block_num);
 	}
 
 	void JitBaseBlockCache::DestroyBlock(int block_num, bool invalidate)
@@ -349,6 +513,69 @@ using namespace Gen;
 		WriteDestroyBlock(b.checkedEntry, b.originalAddress);
 	}
 
+	void JitBaseBlockCache::EvictBlocksInRange(const u8 *start, const u8 *end)
+	{
+		std::vector<u32> addresses;
+
+		for (int i = 0; i < num_blocks; i++)
+		{
+			JitBlock &b = blocks[i];
+			if (b.checkedEntry < start || b.checkedEntry >= end)
+				continue;
+
+			// Blocks invalidated by icbi still have their code here, and their
+			// incoming exits may still jump to it, so they are freed too.
+			if (!b.invalid)
+			{
+				b.invalid = true;
+				u32 *icp = GetICachePtr(b.originalAddress);
+				if (*icp == (u32)i)
+					*icp = JIT_ICACHE_INVALID_WORD;
+				RemoveBlockPages(i);
+			}
+
+			// This block won't link anywhere any more.
+			for (int e = 0; e < 2; e++)
+			{
+				if (b.exitAddress[e] != INVALID_EXIT)
+					links_to.Erase(b.exitAddress[e], i);
+			}
+
+			addresses.push_back(b.originalAddress);
+			b.checkedEntry = NULL;
+			b.normalEntry = NULL;
+			b.runCount = 0;
+			blockCodePointers[i] = NULL;
+			free_blocks.push_back(i);
+		}
+
+		std::sort(addresses.begin(), addresses.end());
+		addresses.erase(std::unique(addresses.begin(), addresses.end()), addresses.end());
+
+		// Unlink every live exit to the evicted addresses, then relink those
+		// that have a live block to go to elsewhere.
+		for (u32 address : addresses)
+		{
+			links_to.ForEach(address, [&](int source) {
+				JitBlock &sourceBlock = blocks[source];
+				if (sourceBlock.invalid)
+					return;
+				for (int e = 0; e < 2; e++)
+				{
+					if (sourceBlock.exitAddress[e] == address)
+					{
+						WriteDestroyBlock(sourceBlock.exitPtrs[e], address);
+						sourceBlock.linkStatus[e] = false;
+					}
+				}
+			});
+
+			int block_num = GetBlockNumberFromStartAddress(address);
+			if (block_num >= 0 && !blocks[block_num].invalid)
+				LinkBlock(block_num);
+		}
+	}
+
 	void JitBaseBlockCache::InvalidateICache(u32 address, const u32 length)
 	{
 		// Convert the logical address to a physical address for the block map
@@ -365,20 +592,30 @@ using namespace Gen;
 		}
 
 		// destroy JIT blocks
-		// !! this works correctly under assumption that any two overlapping blocks end at the same address
-		if (destroy_block)
+		if (destroy_block && length > 0)
 		{
-			std::map<pair<u32,u32>, u32>::iterator it1 = block_map.lower_bound(std::make_pair(pAddr, 0)), it2 = it1;
-			while (it2 != block_map.end() && it2->first.second < pAddr + length)
-		{
-				JitBlock &b = blocks[it2->second];
-				*GetICachePtr(b.originalAddress) = JIT_ICACHE_INVALID_WORD;
-				DestroyBlock(it2->second, true);
-				++it2;
+			const u32 pEnd = pAddr + length - 1;
+			std::vector<int> overlapping;
+			for (u32 page = pAddr >> BLOCK_PAGE_SHIFT; page <= pEnd >> BLOCK_PAGE_SHIFT; page++)
+			{
+				block_pages.ForEach(page, [&](int block_num) {
+					u32 start, end;
+					GetPhysicalRange(blocks[block_num], &start, &end);
+					if (!blocks[block_num].invalid && start <= pEnd && end >= pAddr)
+						overlapping.push_back(block_num);
+				});
 			}
-			if (it1 != it2)
+
+			// Blocks spanning several pages show up once per page.
+			std::sort(overlapping.begin(), overlapping.end());
+			overlapping.erase(std::unique(overlapping.begin(), overlapping.end()), overlapping.end());
+
+			for (int block_num : overlapping)
 			{
-				block_map.erase(it1, it2);
+				JitBlock &b = blocks[block_num];
+				*GetICachePtr(b.originalAddress) = JIT_ICACHE_INVALID_WORD;
+				RemoveBlockPages(block_num);
+				DestroyBlock(block_num, true);
 			}
 		}
 
@@ -5,9 +5,9 @@
 #pragma once
 
 #include <bitset>
-#include <map>
 #include <vector>
 
+#include "FileUtil.h"
 #include "../Gekko.h"
 #include "../PPCAnalyst.h"
 
@@ -46,13 +46,11 @@ struct JitBlock
 	bool invalid;
 	bool linkStatus[2];
 
-#ifdef _WIN32
 	// we don't really need to save start and stop
 	// TODO (mb2): ticStart and ticStop -> "local var" mean "in block" ... low priority ;)
 	u64 ticStart;		// for profiling - time.
 	u64 ticStop;		// for profiling - time.
 	u64 ticCounter;	// for profiling - time.
-#endif
 
 #ifdef USE_VTUNE
 	char blockName[32];
@@ -61,21 +59,85 @@ struct JitBlock
 
 typedef void (*CompiledCode)();
 
+// A multimap from u32 keys to block numbers, kept in flat arrays: an
+// open-addressing hash table of keys, each heading a chain of entries in a
+// shared pool. The block cache hits these on every link, destroy and icbi,
+// so they avoid the node allocations and pointer chasing of std::multimap.
+class JitBlockIndex
+{
+public:
+	JitBlockIndex();
+
+	void Clear();
+	void Insert(u32 key, int block_num);
+	void Erase(u32 key, int block_num);
+
+	// Calls func(block_num) for every block stored under key. func must not
+	// modify the index.
+	template <typename F>
+	void ForEach(u32 key, F func) const
+	{
+		int slot = FindSlot(key);
+		if (slot < 0)
+			return;
+		for (int e = m_slots[slot].head; e >= 0; e = m_entries[e].next)
+			func(m_entries[e].block_num);
+	}
+
+private:
+	enum { EMPTY_KEY = 0xFFFFFFFF, MIN_SLOT_BITS = 10 };
+
+	struct Slot
+	{
+		u32 key;
+		int head;
+	};
+
+	struct Entry
+	{
+		int block_num;
+		int next;
+	};
+
+	std::vector<Slot> m_slots; // size is a power of two
+	std::vector<Entry> m_entries;
+	int m_free_entry;
+	u32 m_used_slots;
+	u32 m_shift; // 32 - log2(m_slots.size())
+
+	// Fibonacci hashing; the product's high bits depend on every bit of the key.
+	u32 Hash(u32 key) const { return (u32)(key * 0x9E3779B1u) >> m_shift; }
+	int FindSlot(u32 key) const;
+	void Rehash();
+};
+
 
 class JitBaseBlockCache
 {
 	const u8 **blockCodePointers;
 	JitBlock *blocks;
 	int num_blocks;
-	std::multimap<u32, int> links_to;
-	std::map<std::pair<u32,u32>, u32> block_map; // (end_addr, start_addr) -> number
+	JitBlockIndex links_to; // exit address -> blocks exiting there
+	JitBlockIndex block_pages; // physical page -> blocks with code in it
 	std::bitset<0x20000000 / 32> valid_block;
+	std::vector<int> free_blocks; // numbers of evicted blocks, ready for reuse
+	File::IOFile perf_map; // symbols for Linux perf, see Init()
 	enum
 	{
 		MAX_NUM_BLOCKS = 65536*2
 	};
 
+	enum
+	{
+		// Granularity of block_pages. Small enough that an icbi of a single
+		// cache line only looks at a handful of blocks.
+		BLOCK_PAGE_SHIFT = 10
+	};
+
 	bool RangeIntersect(int s1, int e1, int s2, int e2) const;
+	void GetPhysicalRange(const JitBlock &b, u32 *start, u32 *end) const;
+	void AddBlockPages(int block_num);
+	void RemoveBlockPages(int block_num);
 	void LinkBlockExits(int i);
 	void LinkBlock(int i);
 	void UnlinkBlock(int i);
@@ -119,6 +181,12 @@ public:
 	void InvalidateICache(u32 address, const u32 length);
 	void DestroyBlock(int block_num, bool invalidate);
 
+	// Frees every block whose code starts in [start, end), so the range can
+	// be reused, and points the exits of other blocks that jump into it back
+	// at the dispatcher. Only usable if the backend leaves room for an
+	// unlinked exit (WriteDestroyBlock) behind every linked one.
+	void EvictBlocksInRange(const u8 *start, const u8 *end);
+
 	// Not currently used
 	//void DestroyBlocksWithFlag(BlockFlag death_flag);
 };
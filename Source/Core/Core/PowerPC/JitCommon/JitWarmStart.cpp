@@ -0,0 +1,199 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Common.h"
+#include "FileUtil.h"
+#include "Hash.h"
+
+#include "JitBase.h"
+#include "JitWarmStart.h"
+#include "../Profiler.h"
+#include "../../ConfigManager.h"
+#include "../../CoreTiming.h"
+#include "../../HW/Memmap.h"
+#include "../../HW/SystemTimers.h"
+
+namespace JitWarmStart
+{
+
+struct Entry
+{
+	u32 address;
+	u32 size;  // in instructions
+	u32 hash;  // of the code, see GetCodeHash
+	u32 score; // runs of the block if profiling, otherwise sessions it was compiled in
+};
+
+enum
+{
+	PROFILE_MAGIC = 0x4d52574a, // "JWRM"
+	PROFILE_VERSION = 1,
+	MAX_ENTRIES = 16384,
+	// Work done per block cache miss.
+	CHECKS_PER_CALL = 64,
+	COMPILES_PER_CALL = 8,
+	// Entries whose code hasn't shown up after this much emulated time are dropped.
+	GIVE_UP_SECONDS = 300,
+};
+
+static std::string s_filename;
+static std::vector<Entry> s_profile; // as loaded
+static std::vector<Entry> s_pending; // not compiled yet
+static u32 s_cursor;
+static u64 s_give_up_ticks;
+
+// The code of a block is only checked as one contiguous run of RAM; blocks
+// spanning several blocks of memory aren't profiled.
+static bool GetCodeHash(u32 address, u32 size, u32 *hash)
+{
+	const u32 length = size * 4;
+	if (length == 0 || !Memory::IsRAMAddress(address) || !Memory::IsRAMAddress(address + length - 1))
+		return false;
+	const u8 *ptr = Memory::GetPointer(address);
+	if (Memory::GetPointer(address + length - 1) != ptr + length - 1)
+		return false;
+	*hash = HashAdler32(ptr, length);
+	return true;
+}
+
+static bool HigherScore(const Entry &a, const Entry &b)
+{
+	return a.score > b.score;
+}
+
+void Init()
+{
+	s_filename.clear();
+	s_profile.clear();
+	s_pending.clear();
+	s_cursor = 0;
+	s_give_up_ticks = 0;
+
+	const SCoreStartupParameter &startup = SConfig::GetInstance().m_LocalCoreStartupParameter;
+	const std::string &unique_id = startup.GetUniqueID();
+	if (!startup.bJITWarmStart || startup.bMMU || startup.bJITNoBlockCache || unique_id.size() != 6)
+		return;
+
+	s_filename = File::GetUserPath(D_CACHE_IDX) + "jit-" + unique_id + ".profile";
+
+	File::IOFile f(s_filename, "rb");
+	u32 header[3];
+	if (!f || !f.ReadArray(header, 3) || header[0] != PROFILE_MAGIC || header[1] != PROFILE_VERSION ||
+	    header[2] == 0 || header[2] > MAX_ENTRIES)
+		return;
+	s_profile.resize(header[2]);
+	if (!f.ReadArray(&s_profile[0], s_profile.size()))
+	{
+		s_profile.clear();
+		return;
+	}
+
+	s_pending = s_profile;
+	INFO_LOG(DYNA_REC, "JIT warm start: %u blocks in %s", (u32)s_pending.size(), s_filename.c_str());
+}
+
+void Shutdown()
+{
+	if (s_filename.empty() || !jit)
+		return;
+
+	// Blocks that weren't run this time fade out of the profile.
+	std::map<u32, Entry> merged;
+	for (Entry entry : s_profile)
+	{
+		entry.score /= 2;
+		if (entry.score)
+			merged[entry.address] = entry;
+	}
+
+	JitBaseBlockCache *blocks = jit->GetBlockCache();
+	for (int i = 0; i < blocks->GetNumBlocks(); i++)
+	{
+		const JitBlock *b = blocks->GetBlock(i);
+		u32 hash;
+		if (b->invalid || !GetCodeHash(b->originalAddress, b->originalSize, &hash))
+			continue;
+
+		u64 score = (Profiler::g_ProfileBlocks && b->runCount > 1) ? b->runCount : 1;
+		Entry &entry = merged[b->originalAddress];
+		if (entry.hash == hash && entry.size == b->originalSize)
+			score += (u64)entry.score * 2;
+		entry.address = b->originalAddress;
+		entry.size = b->originalSize;
+		entry.hash = hash;
+		entry.score = (u32)std::min<u64>(score, 0xFFFFFFFF);
+	}
+
+	std::vector<Entry> profile;
+	for (auto& entry : merged)
+		profile.push_back(entry.second);
+	std::stable_sort(profile.begin(), profile.end(), HigherScore);
+	if (profile.size() > MAX_ENTRIES)
+		profile.resize(MAX_ENTRIES);
+
+	File::CreateFullPath(s_filename);
+	File::IOFile f(s_filename, "wb");
+	const u32 header[3] = { PROFILE_MAGIC, PROFILE_VERSION, (u32)profile.size() };
+	if (!f || !f.WriteArray(header, 3) || (!profile.empty() && !f.WriteArray(&profile[0], profile.size())))
+		ERROR_LOG(DYNA_REC, "JIT warm start: failed to write %s", s_filename.c_str());
+
+	s_filename.clear();
+	s_profile.clear();
+	s_pending.clear();
+}
+
+void CompilePending()
+{
+	if (s_pending.empty())
+		return;
+
+	if (!s_give_up_ticks)
+	{
+		s_give_up_ticks = CoreTiming::GetTicks() + (u64)GIVE_UP_SECONDS * SystemTimers::GetTicksPerSecond();
+	}
+	else if (CoreTiming::GetTicks() > s_give_up_ticks)
+	{
+		INFO_LOG(DYNA_REC, "JIT warm start: %u blocks never showed up", (u32)s_pending.size());
+		s_pending.clear();
+		return;
+	}
+
+	JitBaseBlockCache *blocks = jit->GetBlockCache();
+	int compiled = 0;
+	for (int i = 0; i < CHECKS_PER_CALL && compiled < COMPILES_PER_CALL && !s_pending.empty(); i++)
+	{
+		if (s_cursor >= s_pending.size())
+			s_cursor = 0;
+
+		const Entry &entry = s_pending[s_cursor];
+		u32 hash;
+		if (!GetCodeHash(entry.address, entry.size, &hash) || hash != entry.hash)
+		{
+			s_cursor++;
+			continue;
+		}
+
+		if (blocks->GetBlockNumberFromStartAddress(entry.address) < 0)
+		{
+			// Leave room for the blocks actually being run.
+			if (blocks->IsFull())
+			{
+				s_pending.clear();
+				return;
+			}
+			jit->Jit(entry.address);
+			compiled++;
+		}
+
+		s_pending[s_cursor] = s_pending.back();
+		s_pending.pop_back();
+	}
+}
+
+}  // namespace JitWarmStart
@@ -0,0 +1,19 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+// Warm start: the blocks the JIT ran in earlier sessions of a game are kept in
+// a profile in the cache directory, and compiled as soon as the same code is
+// in RAM again rather than one by one as execution first reaches them.
+namespace JitWarmStart
+{
+	// Loads the profile of the game being started.
+	void Init();
+	// Merges the blocks currently in the cache into the profile and writes it out.
+	void Shutdown();
+	// Compiles a few of the profiled blocks whose code has shown up. Only call
+	// where jit->Jit() may be called, i.e. when looking up a block misses.
+	void CompilePending();
+}
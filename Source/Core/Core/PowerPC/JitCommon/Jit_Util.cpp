@@ -117,6 +117,67 @@ u8 *EmuCodeBlock::UnsafeLoadToReg(X64Reg reg_value, Gen::OpArg opAddress, int ac
 	return result;
 }
 
+#ifdef _M_X64
+FixupBranch EmuCodeBlock::SoftTLBLookup(X64Reg reg_addr, X64Reg reg_host, X64Reg reg_entry, Memory::XCheckTLBFlag flag)
+{
+	MOV(32, R(reg_host), R(reg_addr));
+	SHR(32, R(reg_host), Imm8(Memory::SOFTTLB_PAGE_SHIFT));
+	AND(32, R(reg_host), Imm32(Memory::SOFTTLB_ENTRIES - 1));
+	MOV(64, R(reg_entry), ImmPtr(Memory::GetSoftTLB(flag)));
+	LEA(64, reg_entry, MComplex(reg_entry, reg_host, SCALE_8, 0));
+	// tag ^ address is the page offset if and only if the tag matches.
+	MOV(32, R(reg_host), MatR(reg_entry));
+	XOR(32, R(reg_host), R(reg_addr));
+	CMP(32, R(reg_host), Imm32(Memory::SOFTTLB_PAGE_SIZE));
+	FixupBranch miss = J_CC(CC_AE);
+	OR(32, R(reg_host), MDisp(reg_entry, offsetof(Memory::SoftTLBEntry, paddr)));
+	AND(32, R(reg_host), Imm32(Memory::RAM_MASK));
+	return miss;
+}
+
+FixupBranch EmuCodeBlock::SoftTLBLoadFromEAX(X64Reg reg_value, int accessSize, bool signExtend)
+{
+	PUSH(RCX);
+	PUSH(RDX);
+	FixupBranch miss = SoftTLBLookup(EAX, ECX, RDX, Memory::FLAG_READ);
+	UnsafeLoadRegToReg(ECX, EAX, accessSize, 0, signExtend);
+	POP(RDX);
+	POP(RCX);
+	if (reg_value != EAX)
+		MOV(32, R(reg_value), R(EAX));
+	FixupBranch hit = J(true);
+	SetJumpTarget(miss);
+	POP(RDX);
+	POP(RCX);
+	return hit;
+}
+
+FixupBranch EmuCodeBlock::SoftTLBWriteRegToReg(X64Reg reg_value, X64Reg reg_addr, int accessSize, bool swap)
+{
+	// Borrow two registers the store doesn't need.
+	static const X64Reg candidates[] = {RAX, RCX, RDX, RSI};
+	X64Reg temps[2];
+	int num_temps = 0;
+	for (X64Reg reg : candidates)
+	{
+		if (num_temps < 2 && reg != reg_value && reg != reg_addr)
+			temps[num_temps++] = reg;
+	}
+
+	PUSH(temps[0]);
+	PUSH(temps[1]);
+	FixupBranch miss = SoftTLBLookup(reg_addr, temps[0], temps[1], Memory::FLAG_WRITE);
+	UnsafeWriteRegToReg(reg_value, temps[0], accessSize, 0, swap);
+	POP(temps[1]);
+	POP(temps[0]);
+	FixupBranch hit = J(true);
+	SetJumpTarget(miss);
+	POP(temps[1]);
+	POP(temps[0]);
+	return hit;
+}
+#endif
+
 void EmuCodeBlock::SafeLoadToReg(X64Reg reg_value, const Gen::OpArg & opAddress, int accessSize, s32 offset, u32 registersInUse, bool signExtend, int flags)
 {
 	if (!jit->js.memcheck)
@@ -162,6 +223,17 @@ void EmuCodeBlock::SafeLoadToReg(X64Reg reg_value, const Gen::OpArg & opAddress,
 			}
 			else
 			{
+#ifdef _M_X64
+				// Hardware registers are never translated, so don't bother probing for them.
+				bool softTLB = Core::g_CoreStartupParameter.bMMU && (address & 0xC8000000) != 0xC8000000;
+				FixupBranch tlbHit;
+				if (softTLB)
+				{
+					MOV(32, R(EAX), Imm32(address));
+					tlbHit = SoftTLBLoadFromEAX(reg_value, accessSize, signExtend);
+				}
+#endif
+
 				ABI_PushRegistersAndAdjustStack(registersInUse, false);
 				switch (accessSize)
 				{
@@ -184,6 +256,11 @@ void EmuCodeBlock::SafeLoadToReg(X64Reg reg_value, const Gen::OpArg & opAddress,
 				}
 
 				MEMCHECK_END
+
+#ifdef _M_X64
+				if (softTLB)
+					SetJumpTarget(tlbHit);
+#endif
 			}
 		}
 		else
@@ -195,6 +272,12 @@ void EmuCodeBlock::SafeLoadToReg(X64Reg reg_value, const Gen::OpArg & opAddress,
 				TEST(32, R(EAX), Imm32(mem_mask));
 				FixupBranch fast = J_CC(CC_Z, true);
 
+#ifdef _M_X64
+				FixupBranch tlbHit;
+				if (Core::g_CoreStartupParameter.bMMU)
+					tlbHit = SoftTLBLoadFromEAX(reg_value, accessSize, signExtend);
+#endif
+
 				ABI_PushRegistersAndAdjustStack(registersInUse, false);
 				switch (accessSize)
 				{
@@ -222,12 +305,25 @@ void EmuCodeBlock::SafeLoadToReg(X64Reg reg_value, const Gen::OpArg & opAddress,
 				SetJumpTarget(fast);
 				UnsafeLoadToReg(reg_value, R(EAX), accessSize, 0, signExtend);
 				SetJumpTarget(exit);
+#ifdef _M_X64
+				if (Core::g_CoreStartupParameter.bMMU)
+					SetJumpTarget(tlbHit);
+#endif
 			}
 			else
 			{
 				TEST(32, opAddress, Imm32(mem_mask));
 				FixupBranch fast = J_CC(CC_Z, true);
 
+#ifdef _M_X64
+				FixupBranch tlbHit;
+				if (Core::g_CoreStartupParameter.bMMU)
+				{
+					MOV(32, R(EAX), opAddress);
+					tlbHit = SoftTLBLoadFromEAX(reg_value, accessSize, signExtend);
+				}
+#endif
+
 				ABI_PushRegistersAndAdjustStack(registersInUse, false);
 				switch (accessSize)
 				{
@@ -255,6 +351,10 @@ void EmuCodeBlock::SafeLoadToReg(X64Reg reg_value, const Gen::OpArg & opAddress,
 				SetJumpTarget(fast);
 				UnsafeLoadToReg(reg_value, opAddress, accessSize, offset, signExtend);
 				SetJumpTarget(exit);
+#ifdef _M_X64
+				if (Core::g_CoreStartupParameter.bMMU)
+					SetJumpTarget(tlbHit);
+#endif
 			}
 		}
 	}
@@ -326,6 +426,11 @@ void EmuCodeBlock::SafeWriteRegToReg(X64Reg reg_value, X64Reg reg_addr, int acce
 	FixupBranch fast = J_CC(CC_Z, true);
 	bool noProlog = (0 != (flags & SAFE_LOADSTORE_NO_PROLOG));
 	bool swap = !(flags & SAFE_LOADSTORE_NO_SWAP);
+#ifdef _M_X64
+	FixupBranch tlbHit;
+	if (Core::g_CoreStartupParameter.bMMU)
+		tlbHit = SoftTLBWriteRegToReg(reg_value, reg_addr, accessSize, swap);
+#endif
 	ABI_PushRegistersAndAdjustStack(registersInUse, noProlog);
 	switch (accessSize)
 	{
@@ -338,6 +443,10 @@ void EmuCodeBlock::SafeWriteRegToReg(X64Reg reg_value, X64Reg reg_addr, int acce
 	SetJumpTarget(fast);
 	UnsafeWriteRegToReg(reg_value, reg_addr, accessSize, 0, swap);
 	SetJumpTarget(exit);
+#ifdef _M_X64
+	if (Core::g_CoreStartupParameter.bMMU)
+		SetJumpTarget(tlbHit);
+#endif
 }
 
 void EmuCodeBlock::SafeWriteFloatToReg(X64Reg xmm_value, X64Reg reg_addr, u32 registersInUse, int flags)
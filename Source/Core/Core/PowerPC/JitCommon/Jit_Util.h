@@ -5,6 +5,7 @@
 #pragma once
 
 #include "x64Emitter.h"
+#include "../../HW/Memmap.h"
 #include <unordered_map>
 
 #define MEMCHECK_START \
@@ -33,6 +34,15 @@ public:
 		SAFE_LOADSTORE_NO_PROLOG = 2,
 		SAFE_LOADSTORE_NO_FASTMEM = 4
 	};
+#ifdef _M_X64
+	// Software TLB probes for MMU titles.
+	// Leaves the translated address of reg_addr, relative to RBX, in reg_host.  Returns the branch taken on a miss.
+	Gen::FixupBranch SoftTLBLookup(Gen::X64Reg reg_addr, Gen::X64Reg reg_host, Gen::X64Reg reg_entry, Memory::XCheckTLBFlag flag);
+	// These emit the access for a hit and return a branch to be pointed past the slow path.
+	// A miss falls through with all registers intact.
+	Gen::FixupBranch SoftTLBLoadFromEAX(Gen::X64Reg reg_value, int accessSize, bool signExtend);
+	Gen::FixupBranch SoftTLBWriteRegToReg(Gen::X64Reg reg_value, Gen::X64Reg reg_addr, int accessSize, bool swap);
+#endif
 	void SafeLoadToReg(Gen::X64Reg reg_value, const Gen::OpArg & opAddress, int accessSize, s32 offset, u32 registersInUse, bool signExtend, int flags = 0);
 	void SafeWriteRegToReg(Gen::X64Reg reg_value, Gen::X64Reg reg_addr, int accessSize, s32 offset, u32 registersInUse, int flags = 0);
 
@@ -4,6 +4,8 @@
 
 #include <algorithm>
 #include <cinttypes>
+#include <map>
+#include <string>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -11,6 +13,8 @@
 
 #include "JitInterface.h"
 #include "JitCommon/JitBase.h"
+#include "JitCommon/JitWarmStart.h"
+#include "CachedInterpreter/CachedInterpreter.h"
 
 #ifndef _M_GENERIC
 #include "Jit64IL/JitIL.h"
@@ -30,6 +34,8 @@
 #include "PPCSymbolDB.h"
 #include "HW/Memmap.h"
 #include "ConfigManager.h"
+#include "FileUtil.h"
+#include "StringUtil.h"
 
 bool bFakeVMEM = false;
 bool bMMU = false;
@@ -73,6 +79,11 @@ namespace JitInterface
 				break;
 			}
 			#endif
+			case 5:
+			{
+				ptr = new CachedInterpreter();
+				break;
+			}
 			default:
 			{
 				PanicAlert("Unrecognizable cpu_core: %d", core);
@@ -83,6 +94,9 @@ namespace JitInterface
 		}
 		jit = static_cast<JitBase*>(ptr);
 		jit->Init();
+		JitWarmStart::Init();
+		if (SConfig::GetInstance().m_LocalCoreStartupParameter.bJITProfileBlocks)
+			Profiler::g_ProfileBlocks = true;
 		return ptr;
 	}
 	void InitTables(int core)
@@ -113,6 +127,11 @@ namespace JitInterface
 				break;
 			}
 			#endif
+			case 5:
+			{
+				// Uses the interpreter tables.
+				break;
+			}
 			default:
 			{
 				PanicAlert("Unrecognizable cpu_core: %d", core);
@@ -133,26 +152,19 @@ namespace JitInterface
 		std::vector<BlockStat> stats;
 		stats.reserve(jit->GetBlockCache()->GetNumBlocks());
 		u64 cost_sum = 0;
-	#ifdef _WIN32
 		u64 timecost_sum = 0;
-		u64 countsPerSec;
-		QueryPerformanceFrequency((LARGE_INTEGER *)&countsPerSec);
-	#endif
+		u64 countsPerSec = Profiler::GetTicksPerSecond();
 		for (int i = 0; i < jit->GetBlockCache()->GetNumBlocks(); i++)
 		{
 			const JitBlock *block = jit->GetBlockCache()->GetBlock(i);
 			// Rough heuristic.  Mem instructions should cost more.
 			u64 cost = block->originalSize * (block->runCount / 4);
-	#ifdef _WIN32
 			u64 timecost = block->ticCounter;
-	#endif
 			// Todo: tweak.
 			if (block->runCount >= 1)
 				stats.push_back(BlockStat(i, cost));
 			cost_sum += cost;
-	#ifdef _WIN32
 			timecost_sum += timecost;
-	#endif
 		}
 
 		sort(stats.begin(), stats.end());
@@ -162,6 +174,17 @@ namespace JitInterface
 			PanicAlert("Failed to open %s", filename);
 			return;
 		}
+
+		// Per-function totals, filled in while the blocks are written.
+		struct FunctionStat
+		{
+			std::string name;
+			u64 runCount;
+			u64 timecost;
+			bool operator <(const FunctionStat &other) const { return timecost > other.timecost; }
+		};
+		std::map<u32, FunctionStat> function_stats;
+
 		fprintf(f.GetHandle(), "origAddr\tblkName\tcost\ttimeCost\tpercent\ttimePercent\tOvAllinBlkTime(ms)\tblkCodeSize\n");
 		for (auto& stat : stats)
 		{
@@ -170,23 +193,43 @@ namespace JitInterface
 			{
 				std::string name = g_symbolDB.GetDescription(block->originalAddress);
 				double percent = 100.0 * (double)stat.cost / (double)cost_sum;
-	#ifdef _WIN32
-				double timePercent = 100.0 * (double)block->ticCounter / (double)timecost_sum;
-				fprintf(f.GetHandle(), "%08x\t%s\t%" PRIu64 "\t%" PRIu64 "\t%.2lf\t%llf\t%lf\t%i\n",
+				double timePercent = timecost_sum ? 100.0 * (double)block->ticCounter / (double)timecost_sum : 0.0;
+				double time_ms = countsPerSec ? (double)block->ticCounter * 1000.0 / (double)countsPerSec : 0.0;
+				fprintf(f.GetHandle(), "%08x\t%s\t%" PRIu64 "\t%" PRIu64 "\t%.2lf\t%.2lf\t%lf\t%i\n",
 						block->originalAddress, name.c_str(), stat.cost,
-						block->ticCounter, percent, timePercent,
-						(double)block->ticCounter*1000.0/(double)countsPerSec, block->codeSize);
-	#else
-				fprintf(f.GetHandle(), "%08x\t%s\t%" PRIu64 "\t???\t%.2lf\t???\t???\t%i\n",
-						block->originalAddress, name.c_str(), stat.cost,  percent, block->codeSize);
-	#endif
+						block->ticCounter, percent, timePercent, time_ms, block->codeSize);
+
+				Symbol *symbol = g_symbolDB.GetSymbolFromAddr(block->originalAddress);
+				FunctionStat &function = function_stats[symbol ? symbol->address : block->originalAddress];
+				if (function.name.empty())
+				{
+					function.name = symbol ? symbol->name : StringFromFormat("block_%08x", block->originalAddress);
+					function.runCount = 0;
+					function.timecost = 0;
+				}
+				function.runCount += block->runCount;
+				function.timecost += block->ticCounter;
 			}
 		}
+
+		std::vector<FunctionStat> functions;
+		for (auto& entry : function_stats)
+			functions.push_back(entry.second);
+		sort(functions.begin(), functions.end());
+
+		fprintf(f.GetHandle(), "\nfunction\tblkRuns\ttimeCost\ttimePercent\tOvAllinFuncTime(ms)\n");
+		for (auto& function : functions)
+		{
+			double timePercent = timecost_sum ? 100.0 * (double)function.timecost / (double)timecost_sum : 0.0;
+			double time_ms = countsPerSec ? (double)function.timecost * 1000.0 / (double)countsPerSec : 0.0;
+			fprintf(f.GetHandle(), "%s\t%" PRIu64 "\t%" PRIu64 "\t%.2lf\t%lf\n",
+					function.name.c_str(), function.runCount, function.timecost, timePercent, time_ms);
+		}
 		#endif
 	}
 	bool IsInCodeSpace(u8 *ptr)
 	{
-		return jit->IsInCodeSpace(ptr);
+		return jit && jit->IsInCodeSpace(ptr);
 	}
 	const u8 *BackPatch(u8 *codePtr, u32 em_address, void *ctx)
 	{
@@ -239,6 +282,13 @@ namespace JitInterface
 	{
 		if (jit)
 		{
+			if (SConfig::GetInstance().m_LocalCoreStartupParameter.bJITProfileBlocks)
+			{
+				std::string filename = File::GetUserPath(D_DUMP_IDX) + "Debug/profiler.txt";
+				File::CreateFullPath(filename);
+				WriteProfileResults(filename.c_str());
+			}
+			JitWarmStart::Shutdown();
 			jit->Shutdown();
 			delete jit;
 			jit = NULL;
@@ -14,7 +14,9 @@
 #include "SignatureDB.h"
 #include "PPCAnalyst.h"
 #include "../ConfigManager.h"
+#include "../Core.h"
 #include "../GeckoCode.h"
+#include "../HLE/HLE.h"
 
 // Analyzes PowerPC code in memory to find functions
 // After running, for each function we will know what functions it calls
@@ -212,6 +214,172 @@ void AnalyzeFunction2(Symbol *func)
 	func->flags = flags;
 }
 
+// Tracks which GPRs hold known constants through the block, starting with
+// none, and records the effective address of loads and stores that only
+// depend on them.
+static void PropagateConstants(CodeOp *code, int num_inst)
+{
+	u32 known = 0;
+	u32 value[32] = {};
+
+	for (int i = 0; i < num_inst; i++)
+	{
+		CodeOp &op = code[i];
+		const UGeckoInstruction inst = op.inst;
+		const int flags = op.opinfo->flags;
+		const bool knownA = inst.RA == 0 || (known & (1U << inst.RA));
+		const u32 base = inst.RA == 0 ? 0 : value[inst.RA];
+
+		op.knownAddress = false;
+		if ((flags & FL_LOADSTORE) && !(flags & FL_EVIL) && knownA)
+		{
+			if (inst.OPCD >= 32 && inst.OPCD <= 55)
+			{
+				op.knownAddress = true;
+				op.effectiveAddress = base + (s32)inst.SIMM_16;
+			}
+			else if (inst.OPCD == 31 && (known & (1U << inst.RB)))
+			{
+				op.knownAddress = true;
+				op.effectiveAddress = base + value[inst.RB];
+			}
+		}
+
+		bool knownResult = false;
+		u32 result = 0;
+		switch (inst.OPCD)
+		{
+		case 14: // addi
+			knownResult = knownA;
+			result = base + (s32)inst.SIMM_16;
+			break;
+		case 15: // addis
+			knownResult = knownA;
+			result = base + ((u32)inst.SIMM_16 << 16);
+			break;
+		case 21: // rlwinm
+			knownResult = (known & (1U << inst.RS)) != 0;
+			result = _rotl(value[inst.RS], inst.SH) & Interpreter::Helper_Mask(inst.MB, inst.ME);
+			break;
+		case 24: // ori
+			knownResult = (known & (1U << inst.RS)) != 0;
+			result = value[inst.RS] | inst.UIMM;
+			break;
+		case 25: // oris
+			knownResult = (known & (1U << inst.RS)) != 0;
+			result = value[inst.RS] | (inst.UIMM << 16);
+			break;
+		case 31:
+			if (inst.SUBOP10 == 444) // or, mr
+			{
+				knownResult = (known & (1U << inst.RS)) && (known & (1U << inst.RB));
+				result = value[inst.RS] | value[inst.RB];
+			}
+			break;
+		}
+
+		// The tables don't list every register an instruction writes: load and
+		// store multiple/string write a range of them, and not all of the
+		// update forms of the FP and paired loads and stores name rA.
+		if ((flags & FL_EVIL) || op.opinfo->type == OPTYPE_SYSTEM || op.opinfo->type == OPTYPE_SPR ||
+			HLE::GetFunctionIndex(op.address) != 0)
+		{
+			known = 0;
+		}
+		else if (flags & FL_LOADSTORE)
+		{
+			if (inst.OPCD == 4 || (inst.OPCD >= 32 && (inst.OPCD & 1)) || (inst.OPCD == 31 && (inst.SUBOP10 & 32)))
+				known &= ~(1U << inst.RA);
+		}
+
+		for (int j = 0; j < 2; j++)
+		{
+			if (op.regsOut[j] >= 0)
+				known &= ~(1U << op.regsOut[j]);
+		}
+
+		if (knownResult && op.regsOut[0] >= 0)
+		{
+			known |= 1U << op.regsOut[0];
+			value[op.regsOut[0]] = result;
+		}
+	}
+}
+
+// A busy wait loop is a block that branches back to its own start and whose
+// only way out is a change made by something else: an interrupt, DMA or
+// hardware register.  Every iteration then computes exactly the same thing,
+// so the CPU may as well skip to the next event instead of spinning.
+//
+// That holds if the loop stores nothing, only runs integer, load and branch
+// instructions, and every register (including CR and CA) it reads is either
+// left alone by the loop or written earlier in the same iteration.
+static bool IsBusyWaitLoop(const CodeOp *code, int num_inst, u32 blockstart)
+{
+	if (num_inst == 0)
+		return false;
+
+	const CodeOp &last = code[num_inst - 1];
+	const UGeckoInstruction branch = last.inst;
+	u32 destination;
+	if (branch.OPCD == 16)
+		destination = (branch.AA ? 0 : last.address) + SignExt16(branch.BD << 2);
+	else if (branch.OPCD == 18)
+		destination = (branch.AA ? 0 : last.address) + SignExt26(branch.LI << 2);
+	else
+		return false;
+	if (destination != blockstart || branch.LK)
+		return false;
+
+	u32 read_first = 0, written = 0;
+	bool cr_read_first = false, cr_written = false;
+	bool ca_read_first = false, ca_written = false;
+	for (int i = 0; i < num_inst; i++)
+	{
+		const CodeOp &op = code[i];
+		const int flags = op.opinfo->flags;
+		if (flags & FL_EVIL)
+			return false;
+		if (HLE::GetFunctionIndex(op.address) != 0)
+			return false;
+
+		// The tables don't give every branch OPTYPE_BRANCH.
+		const UGeckoInstruction inst = op.inst;
+		if (inst.OPCD == 16 || (inst.OPCD == 19 && (inst.SUBOP10 == 16 || inst.SUBOP10 == 528)))
+		{
+			// bdnz and friends count down CTR on every iteration.
+			if (!(inst.BO & BO_DONT_DECREMENT_FLAG))
+				return false;
+			if (!(inst.BO & BO_DONT_CHECK_CONDITION))
+				cr_read_first |= !cr_written;
+		}
+		else if (inst.OPCD != 18 && op.opinfo->type != OPTYPE_INTEGER && op.opinfo->type != OPTYPE_LOAD)
+		{
+			return false;
+		}
+
+		if (flags & FL_READ_CA)
+			ca_read_first |= !ca_written;
+		if (flags & FL_SET_CA)
+			ca_written = true;
+		if (op.outputCR0 || op.outputCR1 || (flags & FL_SET_CRn))
+			cr_written = true;
+
+		for (int j = 0; j < 3; j++)
+		{
+			if (op.regsIn[j] >= 0 && !(written & (1U << op.regsIn[j])))
+				read_first |= 1U << op.regsIn[j];
+		}
+		for (int j = 0; j < 2; j++)
+		{
+			if (op.regsOut[j] >= 0)
+				written |= 1U << op.regsOut[j];
+		}
+	}
+
+	return !(read_first & written) && !(cr_read_first && cr_written) && !(ca_read_first && ca_written);
+}
+
 // IMPORTANT - CURRENTLY ASSUMES THAT A IS A COMPARE
 bool CanSwapAdjacentOps(const CodeOp &a, const CodeOp &b)
 {
@@ -338,6 +506,17 @@ u32 Flatten(u32 address, int *realsize, BlockStats *st, BlockRegStats *gpa,
 
 			int flags = opinfo->flags;
 
+			code[i].wantsCA = (flags & FL_READ_CA) ? true : false;
+			code[i].outputCA = (flags & FL_SET_CA) ? true : false;
+
+			// Anything that can leave the block in the middle needs every
+			// flag to be up to date when it does.
+			code[i].canEndBlock = (flags & (FL_ENDBLOCK | FL_CHECKEXCEPTIONS | FL_USE_FPU)) != 0 ||
+				opinfo->type == OPTYPE_BRANCH ||
+				((flags & FL_LOADSTORE) && (bMMU || opinfo->type == OPTYPE_STORE || opinfo->type == OPTYPE_STOREFP)) ||
+				HLE::GetFunctionIndex(address) != 0 ||
+				SConfig::GetInstance().m_LocalCoreStartupParameter.bEnableDebugging;
+
 			if (flags & FL_USE_FPU)
 				fpa->any = true;
 
@@ -414,20 +593,20 @@ u32 Flatten(u32 address, int *realsize, BlockStats *st, BlockRegStats *gpa,
 			case OPTYPE_STORE:
 			case OPTYPE_LOADFP:
 			case OPTYPE_STOREFP:
+			case OPTYPE_PS:
 				break;
 			case OPTYPE_FPU:
 				break;
-			case OPTYPE_BRANCH:
-				if (code[i].inst.hex == 0x4e800020)
-				{
-					// For analysis purposes, we can assume that blr eats flags.
-					code[i].outputCR0 = true;
-					code[i].outputCR1 = true;
-				}
-				break;
 			case OPTYPE_SYSTEM:
 			case OPTYPE_SYSTEMFP:
 				numSystemInstructions++;
+				// fall through
+			default:
+				// Branches, CR logic, SPR and system instructions may read
+				// any of the flags.
+				code[i].wantsCR0 = true;
+				code[i].wantsCR1 = true;
+				code[i].wantsCA = true;
 				break;
 			}
 
@@ -537,27 +716,33 @@ u32 Flatten(u32 address, int *realsize, BlockStats *st, BlockRegStats *gpa,
 		broken_block = true;
 	}
 
-	// Scan for CR0 dependency
-	// assume next block wants CR0 to be safe
+	// Scan for flag dependencies
+	// assume next block wants the flags to be safe
 	bool wantsCR0 = true;
 	bool wantsCR1 = true;
 	bool wantsPS1 = true;
+	bool wantsCA = true;
 	for (int i = num_inst - 1; i >= 0; i--)
 	{
-		if (code[i].outputCR0)
-			wantsCR0 = false;
-		if (code[i].outputCR1)
-			wantsCR1 = false;
-		if (code[i].outputPS1)
-			wantsPS1 = false;
-		wantsCR0 |= code[i].wantsCR0;
-		wantsCR1 |= code[i].wantsCR1;
-		wantsPS1 |= code[i].wantsPS1;
+		bool readsCR0 = code[i].wantsCR0 || code[i].canEndBlock;
+		bool readsCR1 = code[i].wantsCR1 || code[i].canEndBlock;
+		bool readsPS1 = code[i].wantsPS1 || code[i].canEndBlock;
+		bool readsCA = code[i].wantsCA || code[i].canEndBlock;
 		code[i].wantsCR0 = wantsCR0;
 		code[i].wantsCR1 = wantsCR1;
 		code[i].wantsPS1 = wantsPS1;
+		code[i].wantsCA = wantsCA;
+		wantsCR0 = (wantsCR0 && !code[i].outputCR0) || readsCR0;
+		wantsCR1 = (wantsCR1 && !code[i].outputCR1) || readsCR1;
+		wantsPS1 = (wantsPS1 && !code[i].outputPS1) || readsPS1;
+		wantsCA = (wantsCA && !code[i].outputCA) || readsCA;
 	}
 
+	PropagateConstants(code, num_inst);
+
+	if (Core::g_CoreStartupParameter.bSkipIdle)
+		st->isBusyWaitLoop = IsBusyWaitLoop(code, num_inst, blockstart);
+
 	*realsize = num_inst;
 	// ...
 	return address;
@@ -32,19 +32,28 @@ struct CodeOp //16B
 	s8 fregOut;
 	s8 fregsIn[3];
 	bool isBranchTarget;
+	// The wants* flags are true if the value left by this instruction may be
+	// read before it is overwritten, by a later instruction or by anything
+	// outside the block.
 	bool wantsCR0;
 	bool wantsCR1;
 	bool wantsPS1;
+	bool wantsCA;
 	bool outputCR0;
 	bool outputCR1;
 	bool outputPS1;
+	bool outputCA;
+	bool canEndBlock; // may leave the block before or after executing
 	bool skip;  // followed BL-s for example
+	bool knownAddress; // a load or store whose effective address is a constant
+	u32 effectiveAddress;
 };
 
 struct BlockStats
 {
 	bool isFirstBlockOfFunction;
 	bool isLastBlockOfFunction;
+	bool isBusyWaitLoop; // branches back to itself without changing any state, see IsBusyWaitLoop
 	int numCycles;
 };
 
@@ -3,6 +3,15 @@
 // Refer to the license.txt file included.
 
 #include "JitInterface.h"
+#include "Thread.h"
+#include "Timer.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <intrin.h>
+#elif defined(_M_X64)
+#include <x86intrin.h>
+#endif
 
 namespace Profiler
 {
@@ -15,4 +24,23 @@ void WriteProfileResults(const char *filename)
 	JitInterface::WriteProfileResults(filename);
 }
 
+u64 GetTicksPerSecond()
+{
+#if defined(_M_X64)
+	// The TSC has no architectural frequency, so measure it against the wall clock.
+	const u32 start_ms = Common::Timer::GetTimeMs();
+	const u64 start_ticks = __rdtsc();
+	Common::SleepCurrentThread(100);
+	const u64 ticks = __rdtsc() - start_ticks;
+	const u32 ms = Common::Timer::GetTimeMs() - start_ms;
+	return ms ? ticks * 1000 / ms : 0;
+#elif defined(_WIN32)
+	u64 countsPerSec;
+	QueryPerformanceFrequency((LARGE_INTEGER *)&countsPerSec);
+	return countsPerSec;
+#else
+	return 0;
+#endif
+}
+
 }  // namespace
@@ -5,13 +5,33 @@
 
 #pragma once
 
-#ifdef _WIN32
+#if defined(_M_X64)
+
+// rdtsc leaves the timestamp in EDX:EAX. The JitBlocks live on the heap, out
+// of RIP-relative range, so they are addressed through RDX.
+#define PROFILER_QUERY_PERFORMANCE_COUNTER(pt)		\
+					RDTSC();	\
+					SHL(64, R(RDX), Imm8(32));	\
+					OR(64, R(RAX), R(RDX));	\
+					MOV(64, R(RDX), ImmPtr(pt));	\
+					MOV(64, MatR(RDX), R(RAX))
+// asm write : (u64) dt += t1-t0
+#define PROFILER_ADD_DIFF_LARGE_INTEGER(pdt, pt1, pt0)	\
+					MOV(64, R(RDX), ImmPtr(pt1));	\
+					MOV(64, R(RAX), MatR(RDX));	\
+					MOV(64, R(RDX), ImmPtr(pt0));	\
+					SUB(64, R(RAX), MatR(RDX));	\
+					MOV(64, R(RDX), ImmPtr(pdt));	\
+					ADD(64, MatR(RDX), R(RAX))
+
+#define PROFILER_VPUSH	PUSHF();PUSH(RAX);PUSH(RDX)
+#define PROFILER_VPOP	POP(RDX);POP(RAX);POPF()
+
+#elif defined(_WIN32) && defined(_M_IX86)
 
-#ifdef _M_IX86
 #define PROFILER_QUERY_PERFORMANCE_COUNTER(pt)		\
 					LEA(32, EAX, M(pt)); PUSH(EAX);	\
 					CALL(QueryPerformanceCounter)
-// TODO: r64 way
 // asm write : (u64) dt += t1-t0
 #define PROFILER_ADD_DIFF_LARGE_INTEGER(pdt, pt1, pt0)	\
 					MOV(32, R(EAX), M(pt1));	\
@@ -27,14 +47,6 @@
 #define PROFILER_VPUSH	PUSH(EAX);PUSH(ECX);PUSH(EDX)
 #define PROFILER_VPOP	POP(EDX);POP(ECX);POP(EAX)
 
-#else
-
-#define PROFILER_QUERY_PERFORMANCE_COUNTER(pt)
-#define PROFILER_ADD_DIFF_LARGE_INTEGER(pdt, pt1, pt0)
-#define PROFILER_VPUSH
-#define PROFILER_VPOP
-#endif
-
 #else
 // TODO
 #define PROFILER_QUERY_PERFORMANCE_COUNTER(pt)
@@ -59,4 +71,7 @@ extern bool g_ProfileBlocks;
 extern bool g_ProfileInstructions;
 
 void WriteProfileResults(const char *filename);
+
+// Frequency of the counter behind the PROFILER_ macros, or 0 if there is none.
+u64 GetTicksPerSecond();
 }
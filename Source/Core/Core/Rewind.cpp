@@ -0,0 +1,450 @@
+// Copyright 2013 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include "Common.h"
+#include "Thread.h"
+
+#include <deque>
+#include <vector>
+
+#include "ConfigManager.h"
+#include "Core.h"
+#include "CoreTiming.h"
+#include "Rewind.h"
+#include "State.h"
+#include "HW/Memmap.h"
+
+// Snapshots are taken with State::SaveToBuffer() every few frames. Only the
+// newest one is kept in full; every older one is stored as the XOR between
+// it and the snapshot that followed, as runs of changed bytes. Memory pages
+// the game did not touch in between are equal in both snapshots and take no
+// space at all, so a snapshot mostly costs the pages that were written.
+//
+// Snapshots are taken on the CPU thread from a CoreTiming event, which keeps
+// them at the same emulated time as with other save states. Encoding happens
+// on a worker thread so the CPU thread only pays for the serialization.
+//
+// With write watches, RAM and EXRAM are left out of the save state. Only the
+// pages written since the previous snapshot are copied, and the worker keeps
+// the rest in s_ram. Each delta then also holds the older contents of the
+// pages that changed.
+
+namespace Rewind
+{
+
+static const u32 PAGE_SIZE = 4096;
+
+// changed bytes separated by fewer unchanged ones are stored in one run
+static const u32 MIN_GAP = 8;
+
+struct Delta
+{
+	// size of the older snapshot
+	u32 size;
+	// records of u32 offset, u32 length and length XOR bytes
+	std::vector<u8> data;
+	// watch pages that changed, as they were in the older snapshot
+	std::vector<u32> pages;
+	std::vector<u8> pageData;
+};
+
+struct Snapshot
+{
+	std::vector<u8> state;
+	// watch pages written since the previous snapshot and their contents
+	std::vector<u32> pages;
+	std::vector<u8> pageData;
+};
+
+static bool s_enabled = false;
+static u32 s_interval;
+static size_t s_maxMemory;
+static u32 s_frameCount;
+static int s_event;
+
+// newest snapshot and the deltas leading back from it, oldest first
+static std::mutex s_ringLock;
+static std::vector<u8> s_snapshot;
+static std::deque<Delta> s_deltas;
+static size_t s_deltaMemory;
+// RAM and EXRAM at the newest snapshot, when they are tracked by page
+static bool s_trackPages;
+static std::vector<u8> s_ram;
+// bumped by StepBack so snapshots taken before it are not added on top,
+// changed with both locks held
+static u32 s_generation;
+
+// snapshot handed from the CPU thread to the worker
+static std::mutex s_pendingLock;
+static Snapshot s_pending;
+static Snapshot s_spare;
+static bool s_hasPending;
+static u32 s_pendingGeneration;
+// the next snapshot copies every page, s_ram doesn't match what was written since
+static bool s_captureAll;
+
+// only used with the CPU paused
+static u64 s_watchEpoch;
+
+static std::thread s_worker;
+static Common::Event s_workAvailable;
+static volatile bool s_workerRunning;
+
+static void WriteRecord(std::vector<u8>& out, u32 offset, const u8* xor_data, u32 length)
+{
+	size_t pos = out.size();
+	out.resize(pos + 8 + length);
+	memcpy(&out[pos], &offset, 4);
+	memcpy(&out[pos + 4], &length, 4);
+	memcpy(&out[pos + 8], xor_data, length);
+}
+
+// Encodes what has to be applied to newer to get back older
+static void EncodeDelta(const std::vector<u8>& older, const std::vector<u8>& newer, Delta& delta)
+{
+	const u32 size = (u32)older.size();
+	const u32 common = (u32)std::min(older.size(), newer.size());
+
+	delta.size = size;
+	delta.data.clear();
+
+	u8 page[PAGE_SIZE];
+
+	for (u32 page_start = 0; page_start < size; page_start += PAGE_SIZE)
+	{
+		const u32 page_len = std::min(PAGE_SIZE, size - page_start);
+
+		// untouched page
+		if (page_start + page_len <= common && memcmp(&older[page_start], &newer[page_start], page_len) == 0)
+			continue;
+
+		// bytes past the end of the newer snapshot are XORed with zero
+		for (u32 i = 0; i < page_len; i++)
+		{
+			u32 pos = page_start + i;
+			page[i] = older[pos] ^ (pos < common ? newer[pos] : 0);
+		}
+
+		u32 i = 0;
+		while (i < page_len)
+		{
+			if (!page[i])
+			{
+				i++;
+				continue;
+			}
+
+			u32 run_start = i;
+			u32 run_end = i + 1;
+			u32 gap = 0;
+			for (i++; i < page_len && gap < MIN_GAP; i++)
+			{
+				if (page[i])
+				{
+					run_end = i + 1;
+					gap = 0;
+				}
+				else
+				{
+					gap++;
+				}
+			}
+
+			WriteRecord(delta.data, page_start + run_start, &page[run_start], run_end - run_start);
+			i = run_end;
+		}
+	}
+}
+
+// Turns state into the snapshot the delta was encoded against
+static void ApplyDelta(std::vector<u8>& state, const Delta& delta)
+{
+	state.resize(delta.size);
+
+	size_t pos = 0;
+	while (pos < delta.data.size())
+	{
+		u32 offset, length;
+		memcpy(&offset, &delta.data[pos], 4);
+		memcpy(&length, &delta.data[pos + 4], 4);
+
+		const u8* xor_data = &delta.data[pos + 8];
+		for (u32 i = 0; i < length; i++)
+			state[offset + i] ^= xor_data[i];
+
+		pos += 8 + length;
+	}
+}
+
+static size_t GetDeltaMemory(const Delta& delta)
+{
+	return delta.data.size() + delta.pages.size() * sizeof(u32) + delta.pageData.size();
+}
+
+// Copies the written pages into s_ram, keeping the ones that changed in delta
+static void UpdatePages(const Snapshot& snapshot, Delta* delta)
+{
+	const u32 size = Memory::WRITE_WATCH_PAGE_SIZE;
+
+	if (s_ram.empty())
+		s_ram.resize(Memory::GetNumWatchPages() * size);
+
+	for (size_t i = 0; i < snapshot.pages.size(); i++)
+	{
+		u8* older = &s_ram[snapshot.pages[i] * size];
+		const u8* newer = &snapshot.pageData[i * size];
+		if (memcmp(older, newer, size) == 0)
+			continue;
+
+		if (delta)
+		{
+			delta->pages.push_back(snapshot.pages[i]);
+			delta->pageData.insert(delta->pageData.end(), older, older + size);
+		}
+		memcpy(older, newer, size);
+	}
+}
+
+static void AddSnapshot(Snapshot& snapshot, u32 generation)
+{
+	std::lock_guard<std::mutex> lk(s_ringLock);
+
+	// taken before a rewind, it is newer than the state we are in now
+	if (generation != s_generation)
+		return;
+
+	Delta* delta = NULL;
+	if (!s_snapshot.empty())
+	{
+		s_deltas.push_back(Delta());
+		delta = &s_deltas.back();
+		EncodeDelta(s_snapshot, snapshot.state, *delta);
+	}
+
+	if (s_trackPages)
+		UpdatePages(snapshot, delta);
+
+	if (delta)
+		s_deltaMemory += GetDeltaMemory(*delta);
+
+	s_snapshot.swap(snapshot.state);
+
+	// drop the oldest snapshots once the ring is full
+	while (!s_deltas.empty() && s_snapshot.size() + s_ram.size() + s_deltaMemory > s_maxMemory)
+	{
+		s_deltaMemory -= GetDeltaMemory(s_deltas.front());
+		s_deltas.pop_front();
+	}
+}
+
+static void WorkerThread()
+{
+	Common::SetCurrentThreadName("Rewind thread");
+
+	Snapshot snapshot;
+	u32 generation;
+	while (true)
+	{
+		s_workAvailable.Wait();
+		if (!s_workerRunning)
+			break;
+
+		{
+			std::lock_guard<std::mutex> lk(s_pendingLock);
+			if (!s_hasPending)
+				continue;
+			std::swap(snapshot, s_pending);
+			generation = s_pendingGeneration;
+			s_hasPending = false;
+		}
+
+		AddSnapshot(snapshot, generation);
+
+		// a copy of every page is rare, don't keep its buffer around
+		if (s_trackPages && snapshot.pages.size() == Memory::GetNumWatchPages())
+			std::vector<u8>().swap(snapshot.pageData);
+
+		// hand the buffer back, saves reallocating it for the next snapshot
+		std::lock_guard<std::mutex> lk(s_pendingLock);
+		std::swap(s_spare, snapshot);
+	}
+}
+
+// Saves the state without RAM and EXRAM and copies the pages written since the last call
+static void SaveTrackedState(Snapshot& snapshot, bool capture_all)
+{
+	const u32 size = Memory::WRITE_WATCH_PAGE_SIZE;
+
+	bool wasUnpaused = Core::PauseAndLock(true);
+
+	Memory::SetRAMInState(false);
+	State::SaveToBuffer(snapshot.state);
+	Memory::SetRAMInState(true);
+
+	snapshot.pages.clear();
+	if (capture_all)
+	{
+		for (u32 page = 0; page < Memory::GetNumWatchPages(); page++)
+			snapshot.pages.push_back(page);
+	}
+	else
+	{
+		Memory::GetPagesWrittenSince(s_watchEpoch, snapshot.pages);
+	}
+	s_watchEpoch = Memory::WatchAllPages();
+
+	snapshot.pageData.resize(snapshot.pages.size() * size);
+	for (size_t i = 0; i < snapshot.pages.size(); i++)
+		memcpy(&snapshot.pageData[i * size], Memory::GetWatchPagePointer(snapshot.pages[i]), size);
+
+	Core::PauseAndLock(false, wasUnpaused);
+}
+
+// Loads the state without RAM and EXRAM and writes all of s_ram back
+static void LoadTrackedState()
+{
+	const u32 size = Memory::WRITE_WATCH_PAGE_SIZE;
+
+	bool wasUnpaused = Core::PauseAndLock(true);
+
+	Memory::SetRAMInState(false);
+	State::LoadFromBuffer(s_snapshot);
+	Memory::SetRAMInState(true);
+
+	// lifts every watch first rather than faulting on each page
+	Memory::UnwatchAllPages();
+	for (u32 page = 0; page < Memory::GetNumWatchPages(); page++)
+		memcpy(Memory::GetWatchPagePointer(page), &s_ram[page * size], size);
+
+	Core::PauseAndLock(false, wasUnpaused);
+}
+
+static void TakeSnapshot(u64 userdata, int cyclesLate)
+{
+	Snapshot snapshot;
+	u32 generation;
+	bool capture_all;
+	{
+		std::lock_guard<std::mutex> lk(s_pendingLock);
+		// the worker is still busy with the previous snapshot, skip this one
+		if (s_hasPending)
+			return;
+		std::swap(snapshot, s_spare);
+		generation = s_generation;
+		capture_all = s_captureAll;
+		s_captureAll = false;
+	}
+
+	if (s_trackPages)
+		SaveTrackedState(snapshot, capture_all);
+	else
+		State::SaveToBuffer(snapshot.state);
+
+	{
+		std::lock_guard<std::mutex> lk(s_pendingLock);
+		std::swap(s_pending, snapshot);
+		s_pendingGeneration = generation;
+		s_hasPending = true;
+	}
+	s_workAvailable.Set();
+}
+
+void Init()
+{
+	const SCoreStartupParameter& params = SConfig::GetInstance().m_LocalCoreStartupParameter;
+
+	s_enabled = params.bRewind;
+	if (!s_enabled)
+		return;
+
+	s_interval = std::max(params.iRewindFrames, 1);
+	s_maxMemory = (size_t)std::max(params.iRewindMemory, 1) * 1024 * 1024;
+	s_frameCount = 0;
+	s_deltaMemory = 0;
+	s_generation = 0;
+	s_hasPending = false;
+	s_trackPages = Memory::IsWriteWatchEnabled();
+	s_captureAll = true;
+	s_watchEpoch = 0;
+
+	s_event = CoreTiming::RegisterEvent("RewindSnapshot", TakeSnapshot);
+
+	s_workerRunning = true;
+	s_worker = std::thread(WorkerThread);
+}
+
+void Shutdown()
+{
+	if (!s_enabled)
+		return;
+
+	s_workerRunning = false;
+	s_workAvailable.Set();
+	s_worker.join();
+
+	std::vector<u8>().swap(s_snapshot);
+	std::vector<u8>().swap(s_ram);
+	s_pending = Snapshot();
+	s_spare = Snapshot();
+	std::deque<Delta>().swap(s_deltas);
+	s_enabled = false;
+}
+
+void FrameUpdate()
+{
+	if (!s_enabled)
+		return;
+
+	// the VI event is being handled right now, a state saved from it would
+	// miss it, so take the snapshot from an event of its own
+	if (++s_frameCount >= s_interval)
+	{
+		s_frameCount = 0;
+		CoreTiming::ScheduleEvent(0, s_event);
+	}
+}
+
+bool StepBack()
+{
+	if (!s_enabled)
+		return false;
+
+	std::lock_guard<std::mutex> lk(s_ringLock);
+
+	// anything not encoded yet is newer than where we are going, including
+	// a snapshot the worker has already taken off s_pending
+	{
+		std::lock_guard<std::mutex> pending_lk(s_pendingLock);
+		s_generation++;
+		s_hasPending = false;
+		// s_ram goes back past the state being loaded, so the next delta needs every page
+		s_captureAll = true;
+	}
+
+	if (s_snapshot.empty())
+		return false;
+
+	if (s_trackPages)
+		LoadTrackedState();
+	else
+		State::LoadFromBuffer(s_snapshot);
+
+	if (!s_deltas.empty())
+	{
+		Delta& delta = s_deltas.back();
+		ApplyDelta(s_snapshot, delta);
+		for (size_t i = 0; i < delta.pages.size(); i++)
+		{
+			const u32 size = Memory::WRITE_WATCH_PAGE_SIZE;
+			memcpy(&s_ram[delta.pages[i] * size], &delta.pageData[i * size], size);
+		}
+		s_deltaMemory -= GetDeltaMemory(delta);
+		s_deltas.pop_back();
+	}
+
+	Core::DisplayMessage("Rewound state", 1000);
+	return true;
+}
+
+}
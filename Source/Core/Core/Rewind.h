@@ -0,0 +1,25 @@
+// Copyright 2013 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+
+// In-memory save state history for stepping backwards.
+
+#pragma once
+
+#include "Common.h"
+
+namespace Rewind
+{
+
+void Init();
+void Shutdown();
+
+// Called by the VI at the end of every field
+void FrameUpdate();
+
+// Loads the most recent snapshot, every further call goes back one more
+// snapshot until the oldest one is reached. Returns false if there is none.
+bool StepBack();
+
+}
@@ -18,7 +18,9 @@
 #include "PowerPC/JitCommon/JitBase.h"
 #include "VideoBackendBase.h"
 
+#include <algorithm>
 #include <lzo/lzo1x.h>
+#include "zlib.h"
 #include "HW/Memmap.h"
 #include "HW/VideoInterface.h"
 #include "HW/SystemTimers.h"
@@ -38,10 +40,13 @@ static const u32 OUT_LEN = IN_LEN + (IN_LEN / 16) + 64 + 3;
 
 static unsigned char __LZO_MMODEL out[OUT_LEN];
 
-#define HEAP_ALLOC(var, size) \
-	lzo_align_t __LZO_MMODEL var[((size) + (sizeof(lzo_align_t) - 1)) / sizeof(lzo_align_t)]
-
-static HEAP_ALLOC(wrkmem, LZO1X_1_MEM_COMPRESS);
+// Compressed states are split into chunks that are deflated independently,
+// so they can be (de)compressed on all cores. An index of the compressed
+// chunk sizes follows the header. States written by older versions store a
+// sequence of LZO blocks instead, each prefixed by its size, which can never
+// be as large as the magic.
+static const u32 CHUNKED_STATE_MAGIC = 0x5A435344; // "DSCZ"
+static const u32 CHUNK_SIZE = 1024 * 1024;
 
 static std::string g_last_filename;
 
@@ -59,7 +64,7 @@ static Common::Event g_compressAndDumpStateSyncEvent;
 static std::thread g_save_thread;
 
 // Don't forget to increase this after doing changes on the savestate system
-static const u32 STATE_VERSION = 21;
+static const u32 STATE_VERSION = 22;
 
 enum
 {
@@ -196,6 +201,29 @@ std::map<double, int> GetSavedStates()
 	return m;
 }
 
+// Calls func for every chunk, spread over all cores
+template <typename Func>
+static void RunChunkWorkers(u32 num_chunks, Func func)
+{
+	u32 num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+	num_threads = std::min(num_threads, num_chunks);
+
+	auto worker = [&](u32 first)
+	{
+		for (u32 chunk = first; chunk < num_chunks; chunk += num_threads)
+			func(chunk);
+	};
+
+	std::vector<std::thread> threads;
+	for (u32 i = 1; i < num_threads; i++)
+		threads.push_back(std::thread(worker, i));
+
+	worker(0);
+
+	for (auto& thread : threads)
+		thread.join();
+}
+
 struct CompressAndDumpState_args
 {
 	std::vector<u8>* buffer_vector;
@@ -254,33 +282,30 @@ void CompressAndDumpState(CompressAndDumpState_args save_args)
 
 	if (0 != header.size)	// non-zero header size means the state is compressed
 	{
-		lzo_uint i = 0;
-		while (true)
-		{
-			lzo_uint32 cur_len = 0;
-			lzo_uint out_len = 0;
+		const u32 num_chunks = (u32)((buffer_size + CHUNK_SIZE - 1) / CHUNK_SIZE);
+		std::vector<std::vector<u8>> chunks(num_chunks);
+		std::vector<u32> chunk_sizes(num_chunks);
 
-			if ((i + IN_LEN) >= buffer_size)
-			{
-				cur_len = (lzo_uint32)(buffer_size - i);
-			}
-			else
-			{
-				cur_len = IN_LEN;
-			}
-
-			if (lzo1x_1_compress(buffer_data + i, cur_len, out, &out_len, wrkmem) != LZO_E_OK)
-				PanicAlertT("Internal LZO Error - compression failed");
-
-			// The size of the data to write is 'out_len'
-			f.WriteArray((lzo_uint32*)&out_len, 1);
-			f.WriteBytes(out, out_len);
-
-			if (cur_len != IN_LEN)
-				break;
-
-			i += cur_len;
-		}
+		RunChunkWorkers(num_chunks, [&](u32 chunk)
+		{
+			const size_t offset = (size_t)chunk * CHUNK_SIZE;
+			const uLong in_len = (uLong)std::min<size_t>(CHUNK_SIZE, buffer_size - offset);
+
+			uLongf out_len = compressBound(in_len);
+			chunks[chunk].resize(out_len);
+			if (compress2(&chunks[chunk][0], &out_len, buffer_data + offset, in_len, Z_BEST_SPEED) != Z_OK)
+				out_len = 0;
+			chunk_sizes[chunk] = (u32)out_len;
+		});
+
+		if (std::find(chunk_sizes.begin(), chunk_sizes.end(), 0) != chunk_sizes.end())
+			PanicAlertT("Internal zlib Error - compression failed");
+
+		f.WriteArray(&CHUNKED_STATE_MAGIC, 1);
+		f.WriteArray(&num_chunks, 1);
+		f.WriteArray(&chunk_sizes[0], num_chunks);
+		for (u32 i = 0; i < num_chunks; i++)
+			f.WriteBytes(&chunks[i][0], chunk_sizes[i]);
 	}
 	else	// uncompressed
 	{
@@ -352,6 +377,43 @@ bool ReadHeader(const std::string filename, StateHeader& header)
 	return true;
 }
 
+static bool LoadChunkedStateData(File::IOFile& f, std::vector<u8>& buffer)
+{
+	u32 num_chunks = 0;
+	if (!f.ReadArray(&num_chunks, 1) || num_chunks != (buffer.size() + CHUNK_SIZE - 1) / CHUNK_SIZE)
+		return false;
+
+	std::vector<u32> chunk_sizes(num_chunks);
+	std::vector<u64> chunk_offsets(num_chunks);
+	if (!f.ReadArray(&chunk_sizes[0], num_chunks))
+		return false;
+
+	u64 compressed_size = 0;
+	for (u32 i = 0; i < num_chunks; i++)
+	{
+		chunk_offsets[i] = compressed_size;
+		compressed_size += chunk_sizes[i];
+	}
+
+	std::vector<u8> compressed((size_t)compressed_size);
+	if (!f.ReadBytes(&compressed[0], (size_t)compressed_size))
+		return false;
+
+	// one flag per chunk, the workers must not share one
+	std::vector<u8> chunk_ok(num_chunks);
+	RunChunkWorkers(num_chunks, [&](u32 chunk)
+	{
+		const size_t offset = (size_t)chunk * CHUNK_SIZE;
+		const uLong expected_len = (uLong)std::min<size_t>(CHUNK_SIZE, buffer.size() - offset);
+
+		uLongf out_len = expected_len;
+		chunk_ok[chunk] = uncompress(&buffer[offset], &out_len, &compressed[(size_t)chunk_offsets[chunk]], chunk_sizes[chunk]) == Z_OK &&
+			out_len == expected_len;
+	});
+
+	return std::find(chunk_ok.begin(), chunk_ok.end(), 0) == chunk_ok.end();
+}
+
 void LoadFileStateData(const std::string& filename, std::vector<u8>& ret_data)
 {
 	Flush();
@@ -380,26 +442,44 @@ void LoadFileStateData(const std::string& filename, std::vector<u8>& ret_data)
 
 		buffer.resize(header.size);
 
-		lzo_uint i = 0;
-		while (true)
-		{
-			lzo_uint32 cur_len = 0;  // number of bytes to read
-			lzo_uint new_len = 0;  // number of bytes to write
-
-			if (!f.ReadArray(&cur_len, 1))
-				break;
+		u32 magic = 0;
+		f.ReadArray(&magic, 1);
 
-			f.ReadBytes(out, cur_len);
-			const int res = lzo1x_decompress(out, cur_len, &buffer[i], &new_len, NULL);
-			if (res != LZO_E_OK)
+		if (magic == CHUNKED_STATE_MAGIC)
+		{
+			if (!LoadChunkedStateData(f, buffer))
 			{
-				// This doesn't seem to happen anymore.
-				PanicAlertT("Internal LZO Error - decompression failed (%d) (%li, %li) \n"
-					"Try loading the state again", res, i, new_len);
+				PanicAlertT("Internal zlib Error - decompression failed\n"
+					"Try loading the state again");
 				return;
 			}
+		}
+		else
+		{
+			// LZO compressed state from an older version
+			f.Seek(sizeof(StateHeader), SEEK_SET);
 
-			i += new_len;
+			lzo_uint i = 0;
+			while (true)
+			{
+				lzo_uint32 cur_len = 0;  // number of bytes to read
+				lzo_uint new_len = 0;  // number of bytes to write
+
+				if (!f.ReadArray(&cur_len, 1))
+					break;
+
+				f.ReadBytes(out, cur_len);
+				const int res = lzo1x_decompress(out, cur_len, &buffer[i], &new_len, NULL);
+				if (res != LZO_E_OK)
+				{
+					// This doesn't seem to happen anymore.
+					PanicAlertT("Internal LZO Error - decompression failed (%d) (%li, %li) \n"
+						"Try loading the state again", res, i, new_len);
+					return;
+				}
+
+				i += new_len;
+			}
 		}
 	}
 	else	// uncompressed
@@ -42,6 +42,10 @@ void print_trace(const char * msg)
 
 bool DoFault(u64 bad_address, SContext *ctx)
 {
+	// A write to a watched page.  The write is simply retried.
+	if (Memory::HandleWriteWatchFault((u8*)bad_address))
+		return true;
+
 	if (!JitInterface::IsInCodeSpace((u8*) ctx->CTX_PC))
 	{
 		// Let's not prevent debugging.
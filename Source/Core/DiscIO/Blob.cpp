@@ -2,6 +2,8 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <algorithm>
+
 #include "Blob.h"
 #include "CDUtils.h"
 #include "CISOBlob.h"
@@ -17,34 +19,177 @@ namespace DiscIO
 // Provides caching and split-operation-to-block-operations facilities.
 // Used for compressed blob reading and direct drive reading.
 
+SectorReader::SectorReader()
+	: m_blocksize(0)
+	, m_age(0)
+	, m_last_block((u64)(s64) - 1)
+	, m_sequential(0)
+	, m_exit(false)
+{
+	for (int i = 0; i < CACHE_SIZE; i++)
+	{
+		cache[i] = NULL;
+		cache_tags[i] = (u64)(s64) - 1;
+		cache_age[i] = 0;
+		cache_state[i] = SLOT_EMPTY;
+	}
+}
+
 void SectorReader::SetSectorSize(int blocksize)
 {
 	for (int i = 0; i < CACHE_SIZE; i++)
 	{
+		delete [] cache[i];
 		cache[i] = new u8[blocksize];
 		cache_tags[i] = (u64)(s64) - 1;
+		cache_state[i] = SLOT_EMPTY;
 	}
 	m_blocksize = blocksize;
 }
 
 SectorReader::~SectorReader() {
+	StopReadAhead();
 	for (int i = 0; i < CACHE_SIZE; i++)
 		delete [] cache[i];
 }
 
+void SectorReader::StartReadAhead(int num_threads)
+{
+	m_exit = false;
+	for (int i = 0; i < std::min<int>(num_threads, MAX_WORKERS); i++)
+		m_workers.push_back(std::thread(&SectorReader::WorkerThread, this));
+}
+
+void SectorReader::StopReadAhead()
+{
+	if (m_workers.empty())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lk(m_lock);
+		m_exit = true;
+	}
+	m_queue_cv.notify_all();
+	for (auto& worker : m_workers)
+		worker.join();
+	m_workers.clear();
+
+	// Drop whatever was still queued.
+	for (int slot : m_queue)
+	{
+		cache_tags[slot] = (u64)(s64) - 1;
+		cache_state[slot] = SLOT_EMPTY;
+	}
+	m_queue.clear();
+}
+
+void SectorReader::WorkerThread()
+{
+	Common::SetCurrentThreadName("Blob read-ahead");
+
+	std::unique_lock<std::mutex> lk(m_lock);
+	while (true)
+	{
+		while (!m_exit && m_queue.empty())
+			m_queue_cv.wait(lk);
+		if (m_exit)
+			break;
+
+		int slot = m_queue.front();
+		m_queue.pop_front();
+		u64 block_num = cache_tags[slot];
+
+		lk.unlock();
+		GetBlock(block_num, cache[slot]);
+		lk.lock();
+
+		cache_state[slot] = SLOT_READY;
+		m_done_cv.notify_all();
+	}
+}
+
+int SectorReader::FindSlot(u64 block_num) const
+{
+	for (int i = 0; i < CACHE_SIZE; i++)
+	{
+		if (cache_state[i] != SLOT_EMPTY && cache_tags[i] == block_num)
+			return i;
+	}
+	return -1;
+}
+
+// Picks the least recently used slot that isn't being filled.
+int SectorReader::GetFreeSlot()
+{
+	int lru = -1;
+	for (int i = 0; i < CACHE_SIZE; i++)
+	{
+		if (cache_state[i] == SLOT_EMPTY)
+			return i;
+		if (cache_state[i] == SLOT_READY && (lru < 0 || cache_age[i] < cache_age[lru]))
+			lru = i;
+	}
+	return lru;
+}
+
+// Queues the blocks following block_num that aren't cached yet.
+// The queue is capped so pending slots never crowd out the ready ones.
+void SectorReader::ReadAhead(u64 block_num)
+{
+	const u64 num_blocks = (GetDataSize() + m_blocksize - 1) / m_blocksize;
+
+	for (u64 block = block_num + 1; block <= block_num + READ_AHEAD && block < num_blocks; block++)
+	{
+		if (m_queue.size() >= READ_AHEAD)
+			break;
+		if (FindSlot(block) >= 0)
+			continue;
+
+		int slot = GetFreeSlot();
+		cache_tags[slot] = block;
+		cache_state[slot] = SLOT_PENDING;
+		cache_age[slot] = ++m_age;
+		m_queue.push_back(slot);
+		m_queue_cv.notify_one();
+	}
+}
+
 const u8 *SectorReader::GetBlockData(u64 block_num)
 {
-	// TODO : Expand usage of the cache to more than one block :P
-	if (cache_tags[0] == block_num)
+	std::unique_lock<std::mutex> lk(m_lock);
+
+	if (block_num == m_last_block + 1)
+		m_sequential++;
+	else if (block_num != m_last_block)
+		m_sequential = 0;
+	m_last_block = block_num;
+
+	int slot = FindSlot(block_num);
+	if (slot < 0)
 	{
-		return cache[0];
+		slot = GetFreeSlot();
+		cache_tags[slot] = block_num;
+		cache_state[slot] = SLOT_PENDING;
+
+		// Let the workers carry on while we fill this one.
+		lk.unlock();
+		GetBlock(block_num, cache[slot]);
+		lk.lock();
+
+		cache_state[slot] = SLOT_READY;
 	}
 	else
 	{
-		GetBlock(block_num, cache[0]);
-		cache_tags[0] = block_num;
-		return cache[0];
+		while (cache_state[slot] == SLOT_PENDING)
+			m_done_cv.wait(lk);
 	}
+	cache_age[slot] = ++m_age;
+
+	// Two sequential hits in a row is a streaming read.
+	if (!m_workers.empty() && m_sequential >= 2)
+		ReadAhead(block_num);
+
+	return cache[slot];
 }
 
 bool SectorReader::Read(u64 offset, u64 size, u8* out_ptr)
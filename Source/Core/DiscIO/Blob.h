@@ -14,7 +14,11 @@
 // detect whether the file is a compressed blob, or just a big hunk of data, or a drive, and
 // automatically do the right thing.
 
+#include <deque>
+#include <vector>
+
 #include "CommonTypes.h"
+#include "Thread.h"
 
 namespace DiscIO
 {
@@ -36,19 +40,49 @@ protected:
 
 // Provides caching and split-operation-to-block-operations facilities.
 // Used for compressed blob reading and direct drive reading.
-// Currently only uses a single entry cache.
-// Multi-block reads are not cached.
+// Blocks are kept in a small LRU cache. Readers whose GetBlock can run on
+// several threads at once may start read-ahead: once a sequential run is
+// detected, the following blocks are fetched on background threads.
+// Multi-block reads are only cached if the reader doesn't override
+// ReadMultipleAlignedBlocks.
 class SectorReader : public IBlobReader
 {
 private:
-	enum { CACHE_SIZE = 32 };
+	// At most READ_AHEAD queued plus one in flight per worker may be pending,
+	// which must leave some slots to evict.
+	enum { CACHE_SIZE = 32, READ_AHEAD = 8, MAX_WORKERS = 4 };
+	enum { SLOT_EMPTY, SLOT_PENDING, SLOT_READY };
 	int m_blocksize;
 	u8* cache[CACHE_SIZE];
 	u64 cache_tags[CACHE_SIZE];
-	int cache_age[CACHE_SIZE];
+	u32 cache_age[CACHE_SIZE];
+	int cache_state[CACHE_SIZE];
+	u32 m_age;
+	u64 m_last_block;
+	int m_sequential;
+
+	// Read-ahead. m_lock protects everything above except the block data
+	// of pending slots, which belongs to whoever is filling it.
+	std::vector<std::thread> m_workers;
+	std::deque<int> m_queue;
+	std::mutex m_lock;
+	std::condition_variable m_queue_cv;
+	std::condition_variable m_done_cv;
+	bool m_exit;
+
+	int FindSlot(u64 block_num) const;
+	int GetFreeSlot();
+	void ReadAhead(u64 block_num);
+	void WorkerThread();
 
 protected:
+	SectorReader();
 	void SetSectorSize(int blocksize);
+	// GetBlock must be thread-safe when read-ahead is used. A reader that
+	// starts it has to stop it in its own destructor, since the workers call
+	// back into GetBlock.
+	void StartReadAhead(int num_threads);
+	void StopReadAhead();
 	virtual void GetBlock(u64 block_num, u8 *out) = 0;
 	// This one is uncached. The default implementation is to simply call GetBlockData multiple times and memcpy.
 	virtual bool ReadMultipleAlignedBlocks(u64 block_num, u64 num_blocks, u8 *out_ptr);
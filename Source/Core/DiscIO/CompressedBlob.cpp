@@ -9,7 +9,9 @@
 #include <unistd.h>
 #endif
 
+#include <algorithm>
 #include <cinttypes>
+#include <deque>
 
 #include "CompressedBlob.h"
 #include "DiscScrubber.h"
@@ -39,11 +41,8 @@ CompressedBlobReader::CompressedBlobReader(const char *filename) : file_name(fil
 		+ (sizeof(u64)) * header.num_blocks   // skip block pointers
 		+ (sizeof(u32)) * header.num_blocks;  // skip hashes
 
-	// A compressed block is never ever longer than a decompressed block, so just header.block_size should be fine.
-	// I still add some safety margin.
-	zlib_buffer_size = header.block_size + 64;
-	zlib_buffer = new u8[zlib_buffer_size];
-	memset(zlib_buffer, 0, zlib_buffer_size);
+	// GetBlock is thread-safe, so inflate upcoming blocks in the background.
+	StartReadAhead(std::max(std::thread::hardware_concurrency(), 2u) - 1);
 }
 
 CompressedBlobReader* CompressedBlobReader::Create(const char* filename)
@@ -56,7 +55,7 @@ CompressedBlobReader* CompressedBlobReader::Create(const char* filename)
 
 CompressedBlobReader::~CompressedBlobReader()
 {
-	delete [] zlib_buffer;
+	StopReadAhead();
 	delete [] block_pointers;
 	delete [] hashes;
 }
@@ -88,13 +87,15 @@ void CompressedBlobReader::GetBlock(u64 block_num, u8 *out_ptr)
 		offset &= ~(1ULL << 63);
 	}
 
-	// clear unused part of zlib buffer. maybe this can be deleted when it works fully.
-	memset(zlib_buffer + comp_block_size, 0, zlib_buffer_size - comp_block_size);
-
-	m_file.Seek(offset, SEEK_SET);
-	m_file.ReadBytes(zlib_buffer, comp_block_size);
+	// This can be called from the read-ahead threads, so only the file is shared.
+	std::vector<u8> zlib_buffer(comp_block_size);
+	{
+		std::lock_guard<std::mutex> lk(m_file_lock);
+		m_file.Seek(offset, SEEK_SET);
+		m_file.ReadBytes(zlib_buffer.data(), comp_block_size);
+	}
 
-	u8* source = zlib_buffer;
+	u8* source = zlib_buffer.data();
 	u8* dest = out_ptr;
 
 	// First, check hash.
@@ -136,6 +137,63 @@ void CompressedBlobReader::GetBlock(u64 block_num, u8 *out_ptr)
 	}
 }
 
+namespace
+{
+
+// A block travelling through the compression pipeline. The reader fills
+// in_buf, a compressor thread fills the rest, and the writer consumes it.
+struct CompressJob
+{
+	enum { FREE, READ, DONE };
+	int state;
+	std::vector<u8> in_buf;
+	std::vector<u8> out_buf;
+	u32 size;
+	u32 hash;
+	bool stored;
+	bool failed;
+};
+
+// Blocks are compressed independently with the same settings as always, so
+// the output doesn't depend on how many threads did the work.
+void CompressBlock(CompressJob& job, int block_size)
+{
+	z_stream z;
+	memset(&z, 0, sizeof(z));
+	z.zalloc = Z_NULL;
+	z.zfree  = Z_NULL;
+	z.opaque = Z_NULL;
+	z.next_in   = &job.in_buf[0];
+	z.avail_in  = block_size;
+	z.next_out  = &job.out_buf[0];
+	z.avail_out = block_size;
+
+	job.failed = deflateInit(&z, 9) != Z_OK;
+	if (job.failed)
+		return;
+
+	int status = deflate(&z, Z_FINISH);
+	int comp_size = block_size - z.avail_out;
+	if ((status != Z_STREAM_END) || (z.avail_out < 10))
+	{
+		// let's store uncompressed
+		job.stored = true;
+		job.size = block_size;
+		job.hash = HashAdler32(&job.in_buf[0], block_size);
+	}
+	else
+	{
+		// let's store compressed
+		job.stored = false;
+		job.size = comp_size;
+		job.hash = HashAdler32(&job.out_buf[0], comp_size);
+	}
+
+	deflateEnd(&z);
+}
+
+}  // namespace
+
 bool CompressFileToBlob(const char* infile, const char* outfile, u32 sub_type,
 						int block_size, CompressCB callback, void* arg)
 {
@@ -177,25 +235,95 @@ bool CompressFileToBlob(const char* infile, const char* outfile, u32 sub_type,
 
 	u64* offsets = new u64[header.num_blocks];
 	u32* hashes = new u32[header.num_blocks];
-	u8* out_buf = new u8[block_size];
-	u8* in_buf = new u8[block_size];
 
 	// seek past the header (we will write it at the end)
 	f.Seek(sizeof(CompressedBlobHeader), SEEK_CUR);
 	// seek past the offset and hash tables (we will write them at the end)
 	f.Seek((sizeof(u64) + sizeof(u32)) * header.num_blocks, SEEK_CUR);
 
+	// The work is split into a pipeline: a reader thread feeds the blocks in
+	// order (the scrubber needs to see them that way), a pool of threads
+	// deflates them, and this thread writes the results back in order.
+	const u32 num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+	std::vector<CompressJob> jobs(num_threads * 4);
+	for (auto& job : jobs)
+	{
+		job.state = CompressJob::FREE;
+		job.in_buf.resize(block_size);
+		job.out_buf.resize(block_size);
+	}
+
+	std::deque<CompressJob*> queue;
+	std::mutex lock;
+	std::condition_variable cv;
+	bool stop = false;
+
+	std::thread reader([&]
+	{
+		for (u32 i = 0; i < header.num_blocks; i++)
+		{
+			CompressJob& job = jobs[i % jobs.size()];
+			{
+				std::unique_lock<std::mutex> lk(lock);
+				while (!stop && job.state != CompressJob::FREE)
+					cv.wait(lk);
+				if (stop)
+					return;
+			}
+
+			std::fill(job.in_buf.begin(), job.in_buf.end(), 0);
+			if (scrubbing)
+				DiscScrubber::GetNextBlock(inf, &job.in_buf[0]);
+			else
+				inf.ReadBytes(&job.in_buf[0], header.block_size);
+
+			{
+				std::lock_guard<std::mutex> lk(lock);
+				job.state = CompressJob::READ;
+				queue.push_back(&job);
+			}
+			cv.notify_all();
+		}
+	});
+
+	std::vector<std::thread> compressors;
+	for (u32 t = 0; t < num_threads; t++)
+	{
+		compressors.push_back(std::thread([&]
+		{
+			std::unique_lock<std::mutex> lk(lock);
+			while (true)
+			{
+				while (!stop && queue.empty())
+					cv.wait(lk);
+				if (stop)
+					return;
+
+				CompressJob& job = *queue.front();
+				queue.pop_front();
+
+				lk.unlock();
+				CompressBlock(job, block_size);
+				lk.lock();
+
+				job.state = CompressJob::DONE;
+				cv.notify_all();
+			}
+		}));
+	}
+
 	// Now we are ready to write compressed data!
 	u64 position = 0;
 	int num_compressed = 0;
 	int num_stored = 0;
 	int progress_monitor = max<int>(1, header.num_blocks / 1000);
+	bool success = true;
 
 	for (u32 i = 0; i < header.num_blocks; i++)
 	{
 		if (i % progress_monitor == 0)
 		{
-			const u64 inpos = inf.Tell();
+			const u64 inpos = (u64)i * block_size;
 			int ratio = 0;
 			if (inpos != 0)
 				ratio = (int)(100 * position / inpos);
@@ -204,74 +332,70 @@ bool CompressFileToBlob(const char* infile, const char* outfile, u32 sub_type,
 			callback(temp, (float)i / (float)header.num_blocks, arg);
 		}
 
-		offsets[i] = position;
-		// u64 start = i * header.block_size;
-		// u64 size = header.block_size;
-		std::fill(in_buf, in_buf + header.block_size, 0);
-		if (scrubbing)
-			DiscScrubber::GetNextBlock(inf, in_buf);
-		else
-			inf.ReadBytes(in_buf, header.block_size);
-		z_stream z;
-		memset(&z, 0, sizeof(z));
-		z.zalloc = Z_NULL;
-		z.zfree  = Z_NULL;
-		z.opaque = Z_NULL;
-		z.next_in   = in_buf;
-		z.avail_in  = header.block_size;
-		z.next_out  = out_buf;
-		z.avail_out = block_size;
-		int retval = deflateInit(&z, 9);
-
-		if (retval != Z_OK)
+		CompressJob& job = jobs[i % jobs.size()];
+		{
+			std::unique_lock<std::mutex> lk(lock);
+			while (job.state != CompressJob::DONE)
+				cv.wait(lk);
+		}
+
+		if (job.failed)
 		{
 			ERROR_LOG(DISCIO, "Deflate failed");
-			goto cleanup;
+			success = false;
+			break;
 		}
 
-		int status = deflate(&z, Z_FINISH);
-		int comp_size = block_size - z.avail_out;
-		if ((status != Z_STREAM_END) || (z.avail_out < 10))
+		offsets[i] = position;
+		hashes[i] = job.hash;
+		if (job.stored)
 		{
-			//PanicAlert("%i %i Store %i", i*block_size, position, comp_size);
-			// let's store uncompressed
 			offsets[i] |= 0x8000000000000000ULL;
-			f.WriteBytes(in_buf, block_size);
-			hashes[i] = HashAdler32(in_buf, block_size);
-			position += block_size;
+			f.WriteBytes(&job.in_buf[0], job.size);
 			num_stored++;
 		}
 		else
 		{
-			// let's store compressed
-			//PanicAlert("Comp %i to %i", block_size, comp_size);
-			f.WriteBytes(out_buf, comp_size);
-			hashes[i] = HashAdler32(out_buf, comp_size);
-			position += comp_size;
+			f.WriteBytes(&job.out_buf[0], job.size);
 			num_compressed++;
 		}
+		position += job.size;
 
-		deflateEnd(&z);
+		{
+			std::lock_guard<std::mutex> lk(lock);
+			job.state = CompressJob::FREE;
+		}
+		cv.notify_all();
 	}
 
-	header.compressed_data_size = position;
+	{
+		std::lock_guard<std::mutex> lk(lock);
+		stop = true;
+	}
+	cv.notify_all();
+	reader.join();
+	for (auto& compressor : compressors)
+		compressor.join();
 
-	// Okay, go back and fill in headers
-	f.Seek(0, SEEK_SET);
-	f.WriteArray(&header, 1);
-	f.WriteArray(offsets, header.num_blocks);
-	f.WriteArray(hashes, header.num_blocks);
+	if (success)
+	{
+		header.compressed_data_size = position;
+
+		// Okay, go back and fill in headers
+		f.Seek(0, SEEK_SET);
+		f.WriteArray(&header, 1);
+		f.WriteArray(offsets, header.num_blocks);
+		f.WriteArray(hashes, header.num_blocks);
+	}
 
-cleanup:
 	// Cleanup
-	delete[] in_buf;
-	delete[] out_buf;
 	delete[] offsets;
 	delete[] hashes;
 
 	DiscScrubber::Cleanup();
-	callback("Done compressing disc image.", 1.0f, arg);
-	return true;
+	if (success)
+		callback("Done compressing disc image.", 1.0f, arg);
+	return success;
 }
 
 bool DecompressBlobToFile(const char* infile, const char* outfile, CompressCB callback, void* arg)
@@ -15,9 +15,11 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include "Blob.h"
 #include "FileUtil.h"
+#include "Thread.h"
 
 namespace DiscIO
 {
@@ -60,9 +62,8 @@ private:
 	u32 *hashes;
 	int data_offset;
 	File::IOFile m_file;
+	std::mutex m_file_lock;
 	u64 file_size;
-	u8 *zlib_buffer;
-	int zlib_buffer_size;
 	std::string file_name;
 };
 
@@ -51,6 +51,7 @@ Core::GetWindowHandle().
 #include "IPC_HLE/WII_IPC_HLE_Device_usb.h"
 //#include "IPC_HLE/WII_IPC_HLE_Device_FileIO.h"
 #include "State.h"
+#include "Rewind.h"
 #include "VolumeHandler.h"
 #include "NANDContentLoader.h"
 #include "WXInputBase.h"
@@ -157,6 +158,7 @@ void CFrame::CreateMenu()
 	loadMenu->Append(IDM_LOADSTATEFILE,  GetMenuLabel(HK_LOAD_STATE_FILE));
 
 	loadMenu->Append(IDM_UNDOLOADSTATE, GetMenuLabel(HK_UNDO_LOAD_STATE));
+	loadMenu->Append(IDM_REWIND, GetMenuLabel(HK_REWIND));
 	loadMenu->AppendSeparator();
 
 	for (unsigned int i = 1; i <= State::NUM_STATES; i++)
@@ -425,6 +427,7 @@ wxString CFrame::GetMenuLabel(int Id)
 		case HK_SAVE_FIRST_STATE: Label = wxString("Save Oldest State"); break;
 		case HK_UNDO_LOAD_STATE: Label = wxString("Undo Load State"); break;
 		case HK_UNDO_SAVE_STATE: Label = wxString("Undo Save State"); break;
+		case HK_REWIND: Label = wxString("Rewind"); break;
 
 		default:
 			Label = wxString::Format(_("Undefined %i"), Id);
@@ -1528,6 +1531,12 @@ void CFrame::OnUndoSaveState(wxCommandEvent& WXUNUSED (event))
 		State::UndoSaveState();
 }
 
+void CFrame::OnRewind(wxCommandEvent& WXUNUSED (event))
+{
+	if (Core::IsRunningAndStarted())
+		Rewind::StepBack();
+}
+
 
 void CFrame::OnLoadState(wxCommandEvent& event)
 {
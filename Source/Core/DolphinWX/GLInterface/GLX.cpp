@@ -122,8 +122,50 @@ bool cInterfaceGLX::Create(void *&window_handle)
 	return true;
 }
 
+cInterfaceBase* cInterfaceGLX::CreateSharedContext()
+{
+	// Find the framebuffer config of the window's visual; it needs to support pbuffers too.
+	int num_configs = 0;
+	GLXFBConfig *configs = glXGetFBConfigs(GLWin.dpy, GLWin.screen, &num_configs);
+	GLXFBConfig config = NULL;
+	for (int i = 0; i < num_configs && !config; ++i)
+	{
+		int visual_id = 0, drawable_type = 0;
+		glXGetFBConfigAttrib(GLWin.dpy, configs[i], GLX_VISUAL_ID, &visual_id);
+		glXGetFBConfigAttrib(GLWin.dpy, configs[i], GLX_DRAWABLE_TYPE, &drawable_type);
+		if ((VisualID)visual_id == GLWin.vi->visualid && (drawable_type & GLX_PBUFFER_BIT))
+			config = configs[i];
+	}
+	if (configs)
+		XFree(configs);
+	if (!config)
+	{
+		WARN_LOG(VIDEO, "No pbuffer config for the window's visual, can't create a shared GLX context.");
+		return NULL;
+	}
+
+	int pbuffer_attribs[] = {GLX_PBUFFER_WIDTH, 1, GLX_PBUFFER_HEIGHT, 1, None};
+	GLXContext ctx = glXCreateNewContext(GLWin.dpy, config, GLX_RGBA_TYPE, GLWin.ctx, GL_TRUE);
+	GLXPbuffer pbuffer = ctx ? glXCreatePbuffer(GLWin.dpy, config, pbuffer_attribs) : 0;
+	if (!pbuffer)
+	{
+		WARN_LOG(VIDEO, "Unable to create a shared GLX context.");
+		if (ctx)
+			glXDestroyContext(GLWin.dpy, ctx);
+		return NULL;
+	}
+
+	cInterfaceGLX *shared = new cInterfaceGLX;
+	shared->m_shared_ctx = ctx;
+	shared->m_pbuffer = pbuffer;
+	return shared;
+}
+
 bool cInterfaceGLX::MakeCurrent()
 {
+	if (m_shared_ctx)
+		return glXMakeContextCurrent(GLWin.dpy, m_pbuffer, m_pbuffer, m_shared_ctx);
+
 	// connect the glx-context to the window
 	#if defined(HAVE_WX) && (HAVE_WX)
 	Host_GetRenderWindowSize(GLWin.x, GLWin.y,
@@ -136,6 +178,9 @@ bool cInterfaceGLX::MakeCurrent()
 
 bool cInterfaceGLX::ClearCurrent()
 {
+	if (m_shared_ctx)
+		return glXMakeContextCurrent(GLWin.dpy, None, None, NULL);
+
 	return glXMakeCurrent(GLWin.dpy, None, NULL);
 }
 
@@ -143,6 +188,15 @@ bool cInterfaceGLX::ClearCurrent()
 // Close backend
 void cInterfaceGLX::Shutdown()
 {
+	if (m_shared_ctx)
+	{
+		glXDestroyPbuffer(GLWin.dpy, m_pbuffer);
+		glXDestroyContext(GLWin.dpy, m_shared_ctx);
+		m_pbuffer = 0;
+		m_shared_ctx = NULL;
+		return;
+	}
+
 	XWindow.DestroyXWindow();
 	if (GLWin.ctx)
 	{
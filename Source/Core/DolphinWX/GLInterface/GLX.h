@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <GL/glx.h>
+
 #include "X11_Util.h"
 #include "InterfaceBase.h"
 
@@ -11,8 +13,13 @@ class cInterfaceGLX : public cInterfaceBase
 {
 private:
 	cX11Window XWindow;
+
+	// Only set for shared contexts, which render to a pbuffer instead of the window.
+	GLXContext m_shared_ctx;
+	GLXPbuffer m_pbuffer;
 public:
 	friend class cX11Window;
+	cInterfaceGLX() : m_shared_ctx(NULL), m_pbuffer(0) {}
 	void SwapInterval(int Interval);
 	void Swap();
 	void UpdateFPSDisplay(const char *Text);
@@ -21,4 +28,5 @@ public:
 	bool MakeCurrent();
 	bool ClearCurrent();
 	void Shutdown();
+	cInterfaceBase* CreateSharedContext();
 };
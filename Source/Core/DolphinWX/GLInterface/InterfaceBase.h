@@ -20,6 +20,7 @@ protected:
 
 	u32 s_opengl_mode;
 public:
+	virtual ~cInterfaceBase() {}
 	virtual void Swap() {}
 	virtual void UpdateFPSDisplay(const char *Text) {}
 	virtual void SetMode(u32 mode) { s_opengl_mode = GLInterfaceMode::MODE_OPENGL; }
@@ -36,4 +37,8 @@ public:
 	virtual void SetBackBufferDimensions(u32 W, u32 H) {s_backbuffer_width = W; s_backbuffer_height = H; }
 	virtual void Update() { }
 	virtual bool PeekMessages() { return false; }
+
+	// Returns a context that shares objects with this one, to be made current
+	// on another thread, or NULL if the platform can't do that.
+	virtual cInterfaceBase* CreateSharedContext() { return NULL; }
 };
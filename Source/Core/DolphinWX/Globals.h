@@ -27,6 +27,7 @@ enum
 	IDM_UNDOLOADSTATE,
 	IDM_UNDOSAVESTATE,
 	IDM_LOADSTATEFILE,
+	IDM_REWIND,
 	IDM_SAVESTATEFILE,
 	IDM_SAVESLOT1,
 	IDM_SAVESLOT2,
@@ -250,6 +250,7 @@ void HotkeyConfigDialog::CreateHotkeyGUIControls(void)
 		_("Undo Save State"),
 		_("Save State"),
 		_("Load State"),
+		_("Rewind"),
 	};
 
 	const int page_breaks[3] = {HK_OPEN, HK_LOAD_STATE_SLOT_1, NUM_HOTKEYS};
@@ -74,10 +74,10 @@ bool TextureCache::TCacheEntry::Save(const std::string filename, unsigned int le
 	return saved_png;
 }
 
-void TextureCache::TCacheEntry::Load(unsigned int width, unsigned int height,
+void TextureCache::TCacheEntry::Load(const u8* data, unsigned int width, unsigned int height,
 	unsigned int expanded_width, unsigned int level)
 {
-	D3D::ReplaceRGBATexture2D(texture->GetTex(), TextureCache::temp, width, height, expanded_width, level, usage);
+	D3D::ReplaceRGBATexture2D(texture->GetTex(), data, width, height, expanded_width, level, usage);
 }
 
 TextureCache::TCacheEntryBase* TextureCache::CreateTexture(unsigned int width,
@@ -116,7 +116,7 @@ TextureCache::TCacheEntryBase* TextureCache::CreateTexture(unsigned int width,
 	SAFE_RELEASE(pTexture);
 
 	if (tex_levels != 1)
-		entry->Load(width, height, expanded_width, 0);
+		entry->Load(TextureCache::temp, width, height, expanded_width, 0);
 
 	return entry;
 }
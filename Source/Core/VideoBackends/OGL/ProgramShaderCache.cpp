@@ -2,7 +2,12 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <deque>
+#include <thread>
+#include <vector>
+
 #include "ProgramShaderCache.h"
+#include "CPUDetect.h"
 #include "DriverDetails.h"
 #include "MathUtil.h"
 #include "StreamBuffer.h"
@@ -31,14 +36,43 @@ ProgramShaderCache::PCacheEntry* ProgramShaderCache::last_entry;
 SHADERUID ProgramShaderCache::last_uid;
 UidChecker<PixelShaderUid,PixelShaderCode> ProgramShaderCache::pixel_uid_checker;
 UidChecker<VertexShaderUid,VertexShaderCode> ProgramShaderCache::vertex_uid_checker;
+std::map<VertexShaderUid, ProgramShaderCache::PCacheEntry*> ProgramShaderCache::fallback_entries;
 
 static char s_glsl_header[1024] = "";
 
+// Programs are compiled by a pool of threads, each with its own context sharing
+// objects with the GPU thread's.  Finished programs are handed back to the GPU
+// thread, which is the only one touching pshaders.
+struct CompileJob
+{
+	SHADERUID uid;
+	std::string vcode, pcode;
+	// Results: the program, 0 if it failed, and its binary for the disk cache
+	// with the binary format in front.
+	GLuint glprogid;
+	std::vector<u8> binary;
+};
+
+static const int MAX_COMPILE_THREADS = 4;
+
+static std::vector<std::thread> s_compile_threads;
+static std::vector<cInterfaceBase*> s_compile_contexts;
+static std::mutex s_compile_lock;
+static std::condition_variable s_compile_wakeup;
+static std::deque<CompileJob*> s_compile_queue;
+static std::vector<CompileJob*> s_compile_done;
+static bool s_compile_quit;
+
 void SHADER::SetProgramVariables()
 {
 	// glsl shader must be bind to set samplers
 	Bind();
+	SetProgramUniforms();
+}
 
+// The program must be in use already.
+void SHADER::SetProgramUniforms()
+{
 	// Bind UBO
 	if (!g_ActiveConfig.backend_info.bSupportShadingLanguage420pack)
 	{
@@ -135,6 +169,9 @@ GLuint ProgramShaderCache::GetCurrentProgram(void)
 
 SHADER* ProgramShaderCache::SetShader ( DSTALPHA_MODE dstAlphaMode, u32 components )
 {
+	if (!s_compile_threads.empty())
+		FinishCompiles();
+
 	SHADERUID uid;
 	GetShaderId(&uid, dstAlphaMode, components);
 
@@ -156,6 +193,11 @@ SHADER* ProgramShaderCache::SetShader ( DSTALPHA_MODE dstAlphaMode, u32 componen
 	if (iter != pshaders.end())
 	{
 		PCacheEntry *entry = &iter->second;
+		if (entry->pending)
+		{
+			last_entry = NULL;
+			return SetFallbackShader(uid);
+		}
 		last_entry = entry;
 
 		GFX_DEBUGGER_PAUSE_AT(NEXT_PIXEL_SHADER_CHANGE, true);
@@ -190,20 +232,204 @@ SHADER* ProgramShaderCache::SetShader ( DSTALPHA_MODE dstAlphaMode, u32 componen
 	}
 #endif
 
+	if (!s_compile_threads.empty())
+	{
+		CompileJob *job = new CompileJob;
+		job->uid = uid;
+		job->vcode = vcode.GetBuffer();
+		job->pcode = pcode.GetBuffer();
+		job->glprogid = 0;
+		{
+			std::lock_guard<std::mutex> lk(s_compile_lock);
+			s_compile_queue.push_back(job);
+		}
+		s_compile_wakeup.notify_one();
+
+		newentry.pending = true;
+		last_entry = NULL;
+		return SetFallbackShader(uid);
+	}
+
 	if (!CompileShader(newentry.shader, vcode.GetBuffer(), pcode.GetBuffer())) {
 		GFX_DEBUGGER_PAUSE_AT(NEXT_ERROR, true);
 		return NULL;
 	}
 
-	INCSTAT(stats.numPixelShadersCreated);
-	SETSTAT(stats.numPixelShadersAlive, pshaders.size());
+	AddProgram(uid, &newentry);
 	GFX_DEBUGGER_PAUSE_AT(NEXT_PIXEL_SHADER_CHANGE, true);
 
 	last_entry->shader.Bind();
 	return &last_entry->shader;
 }
 
+// Stands in for a program that is still being compiled.  NULL means the draw should be skipped.
+SHADER* ProgramShaderCache::SetFallbackShader(const SHADERUID& uid)
+{
+	if (g_ActiveConfig.iAsyncShaderMode != ASYNC_SHADERS_FALLBACK)
+		return NULL;
+
+	auto iter = fallback_entries.find(uid.vuid);
+	if (iter == fallback_entries.end())
+		return NULL;
+
+	iter->second->shader.Bind();
+	return &iter->second->shader;
+}
+
+// Bookkeeping for a program that is ready to use.
+void ProgramShaderCache::AddProgram(const SHADERUID& uid, PCacheEntry* entry)
+{
+	fallback_entries[uid.vuid] = entry;
+
+	INCSTAT(stats.numPixelShadersCreated);
+	SETSTAT(stats.numPixelShadersAlive, pshaders.size());
+}
+
+void ProgramShaderCache::CompileThread(cInterfaceBase* context)
+{
+	Common::SetCurrentThreadName("Shader compile thread");
+	context->MakeCurrent();
+
+	while (true)
+	{
+		CompileJob *job;
+		{
+			std::unique_lock<std::mutex> lk(s_compile_lock);
+			while (!s_compile_quit && s_compile_queue.empty())
+				s_compile_wakeup.wait(lk);
+			if (s_compile_quit)
+				break;
+			job = s_compile_queue.front();
+			s_compile_queue.pop_front();
+		}
+
+		SHADER shader;
+		if (LinkProgram(shader, job->vcode.c_str(), job->pcode.c_str()))
+		{
+			glUseProgram(shader.glprogid);
+			shader.SetProgramUniforms();
+			glUseProgram(0);
+
+			if (g_ogl_config.bSupportsGLSLCache && !g_ActiveConfig.bEnableShaderDebugging)
+			{
+				GLint binary_size = 0;
+				glGetProgramiv(shader.glprogid, GL_PROGRAM_BINARY_LENGTH, &binary_size);
+				if (binary_size)
+				{
+					job->binary.resize(binary_size + sizeof(GLenum));
+					glGetProgramBinary(shader.glprogid, binary_size, NULL, (GLenum*)&job->binary[0], &job->binary[sizeof(GLenum)]);
+				}
+			}
+
+			// The GPU thread's context may only use the program once it's complete.
+			glFinish();
+			job->glprogid = shader.glprogid;
+		}
+
+		std::lock_guard<std::mutex> lk(s_compile_lock);
+		s_compile_done.push_back(job);
+	}
+
+	context->ClearCurrent();
+}
+
+// Hands programs finished by the compile threads to their cache entries.
+void ProgramShaderCache::FinishCompiles()
+{
+	std::vector<CompileJob*> done;
+	{
+		std::lock_guard<std::mutex> lk(s_compile_lock);
+		if (s_compile_done.empty())
+			return;
+		done.swap(s_compile_done);
+	}
+
+	for (CompileJob *job : done)
+	{
+		PCacheEntry &entry = pshaders[job->uid];
+		entry.pending = false;
+		entry.shader.glprogid = job->glprogid;
+		if (job->glprogid)
+		{
+			if (!job->binary.empty())
+			{
+				g_program_disk_cache.Append(job->uid, &job->binary[0], (u32)job->binary.size());
+				entry.in_cache = 1;
+			}
+			AddProgram(job->uid, &entry);
+		}
+		else
+		{
+			GFX_DEBUGGER_PAUSE_AT(NEXT_ERROR, true);
+		}
+		delete job;
+	}
+}
+
+void ProgramShaderCache::StartCompileThreads()
+{
+	// Dumping and debugging shaders want them as they are drawn with.
+	if (g_ActiveConfig.iAsyncShaderMode == ASYNC_SHADERS_OFF || g_ActiveConfig.bEnableShaderDebugging ||
+		(g_ActiveConfig.iLog & CONF_SAVESHADERS))
+		return;
+
+	// Leave the CPU and GPU threads a core each.
+	const int num_threads = std::min(MAX_COMPILE_THREADS, std::max(1, cpu_info.num_cores - 2));
+	s_compile_quit = false;
+	for (int i = 0; i < num_threads; ++i)
+	{
+		cInterfaceBase *context = GLInterface->CreateSharedContext();
+		if (!context)
+			break;
+		s_compile_contexts.push_back(context);
+		s_compile_threads.push_back(std::thread(CompileThread, context));
+	}
+
+	if (s_compile_threads.empty())
+		WARN_LOG(VIDEO, "Shared contexts aren't supported here, shaders are compiled on the GPU thread.");
+	else
+		INFO_LOG(VIDEO, "Compiling shaders on %d threads.", (int)s_compile_threads.size());
+}
+
+void ProgramShaderCache::StopCompileThreads()
+{
+	if (s_compile_threads.empty())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lk(s_compile_lock);
+		s_compile_quit = true;
+		for (CompileJob *job : s_compile_queue)
+			delete job;
+		s_compile_queue.clear();
+	}
+	s_compile_wakeup.notify_all();
+
+	for (auto& thread : s_compile_threads)
+		thread.join();
+	s_compile_threads.clear();
+
+	for (cInterfaceBase *context : s_compile_contexts)
+	{
+		context->Shutdown();
+		delete context;
+	}
+	s_compile_contexts.clear();
+
+	FinishCompiles();
+}
+
 bool ProgramShaderCache::CompileShader ( SHADER& shader, const char* vcode, const char* pcode )
+{
+	if (!LinkProgram(shader, vcode, pcode))
+		return false;
+
+	shader.SetProgramVariables();
+	return true;
+}
+
+// Like CompileShader, but doesn't touch the current program, so it can be used on any thread.
+bool ProgramShaderCache::LinkProgram ( SHADER& shader, const char* vcode, const char* pcode )
 {
 	GLuint vsid = CompileSingleShader(GL_VERTEX_SHADER, vcode);
 	GLuint psid = CompileSingleShader(GL_FRAGMENT_SHADER, pcode);
@@ -268,8 +494,6 @@ bool ProgramShaderCache::CompileShader ( SHADER& shader, const char* vcode, cons
 		return false;
 	}
 
-	shader.SetProgramVariables();
-
 	return true;
 }
 
@@ -395,17 +619,21 @@ void ProgramShaderCache::Init(void)
 
 	CurrentProgram = 0;
 	last_entry = NULL;
+
+	StartCompileThreads();
 }
 
 void ProgramShaderCache::Shutdown(void)
 {
+	StopCompileThreads();
+
 	// store all shaders in cache on disk
 	if (g_ogl_config.bSupportsGLSLCache && !g_Config.bEnableShaderDebugging)
 	{
 		PCache::iterator iter = pshaders.begin();
 		for (; iter != pshaders.end(); ++iter)
 		{
-			if(iter->second.in_cache) continue;
+			if(iter->second.in_cache || !iter->second.shader.glprogid) continue;
 
 			GLint binary_size;
 			glGetProgramiv(iter->second.shader.glprogid, GL_PROGRAM_BINARY_LENGTH, &binary_size);
@@ -430,6 +658,7 @@ void ProgramShaderCache::Shutdown(void)
 	for (; iter != pshaders.end(); ++iter)
 		iter->second.Destroy();
 	pshaders.clear();
+	fallback_entries.clear();
 
 	pixel_uid_checker.Invalidate();
 	vertex_uid_checker.Invalidate();
@@ -502,6 +731,7 @@ void ProgramShaderCache::ProgramShaderCacheInserter::Read ( const SHADERUID& key
 	if (success)
 	{
 		pshaders[key] = entry;
+		fallback_entries[key.vuid] = &pshaders[key];
 		entry.shader.SetProgramVariables();
 	}
 	else
@@ -58,6 +58,7 @@ struct SHADER
 	u32 UniformSize[NUM_UNIFORMS];
 
 	void SetProgramVariables();
+	void SetProgramUniforms();
 	void SetProgramBindings();
 	void Bind();
 };
@@ -70,6 +71,10 @@ public:
 	{
 		SHADER shader;
 		bool in_cache;
+		// Set while a compile thread is still working on the program.
+		bool pending;
+
+		PCacheEntry() : in_cache(false), pending(false) {}
 
 		void Destroy()
 		{
@@ -85,6 +90,7 @@ public:
 	static void GetShaderId(SHADERUID *uid, DSTALPHA_MODE dstAlphaMode, u32 components);
 
 	static bool CompileShader(SHADER &shader, const char* vcode, const char* pcode);
+	static bool LinkProgram(SHADER &shader, const char* vcode, const char* pcode);
 	static GLuint CompileSingleShader(GLuint type, const char *code);
 	static void UploadConstants();
 
@@ -99,10 +105,21 @@ private:
 		void Read(const SHADERUID &key, const u8 *value, u32 value_size) override;
 	};
 
+	static SHADER* SetFallbackShader(const SHADERUID& uid);
+	static void AddProgram(const SHADERUID& uid, PCacheEntry* entry);
+
+	static void StartCompileThreads();
+	static void StopCompileThreads();
+	static void CompileThread(cInterfaceBase* context);
+	static void FinishCompiles();
+
 	static PCache pshaders;
 	static PCacheEntry* last_entry;
 	static SHADERUID last_uid;
 
+	// The latest ready program for each vertex shader, for ASYNC_SHADERS_FALLBACK.
+	static std::map<VertexShaderUid, PCacheEntry*> fallback_entries;
+
 	static UidChecker<PixelShaderUid,PixelShaderCode> pixel_uid_checker;
 	static UidChecker<VertexShaderUid,VertexShaderCode> vertex_uid_checker;
 
@@ -191,7 +191,7 @@ TextureCache::TCacheEntryBase* TextureCache::CreateTexture(unsigned int width,
 	glBindTexture(GL_TEXTURE_2D, entry.texture);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, tex_levels - 1);
 
-	entry.Load(width, height, expanded_width, 0);
+	entry.Load(temp, width, height, expanded_width, 0);
 
 	// This isn't needed as Load() also reset the stage in the end
 	//TextureCache::SetStage();
@@ -199,7 +199,7 @@ TextureCache::TCacheEntryBase* TextureCache::CreateTexture(unsigned int width,
 	return &entry;
 }
 
-void TextureCache::TCacheEntry::Load(unsigned int width, unsigned int height,
+void TextureCache::TCacheEntry::Load(const u8* data, unsigned int width, unsigned int height,
 	unsigned int expanded_width, unsigned int level)
 {
 	if (pcfmt != PC_TEX_FMT_DXT1)
@@ -210,7 +210,7 @@ void TextureCache::TCacheEntry::Load(unsigned int width, unsigned int height,
 		if (expanded_width != width)
 			glPixelStorei(GL_UNPACK_ROW_LENGTH, expanded_width);
 
-		glTexImage2D(GL_TEXTURE_2D, level, gl_iformat, width, height, 0, gl_format, gl_type, temp);
+		glTexImage2D(GL_TEXTURE_2D, level, gl_iformat, width, height, 0, gl_format, gl_type, data);
 
 		if (expanded_width != width)
 			glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
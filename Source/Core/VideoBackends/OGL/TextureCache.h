@@ -40,7 +40,7 @@ private:
 		TCacheEntry();
 		~TCacheEntry();
 
-		void Load(unsigned int width, unsigned int height,
+		void Load(const u8* data, unsigned int width, unsigned int height,
 			unsigned int expanded_width, unsigned int level) override;
 
 		void FromRenderTarget(u32 dstAddr, unsigned int dstFormat,
@@ -151,22 +151,30 @@ void VertexManager::vFlush()
 	bool dualSourcePossible = g_ActiveConfig.backend_info.bSupportsDualSourceBlend;
 
 	// finally bind
+	SHADER *shader;
 	if (dualSourcePossible)
 	{
 		if (useDstAlpha)
 		{
 			// If host supports GL_ARB_blend_func_extended, we can do dst alpha in
 			// the same pass as regular rendering.
-			ProgramShaderCache::SetShader(DSTALPHA_DUAL_SOURCE_BLEND, g_nativeVertexFmt->m_components);
+			shader = ProgramShaderCache::SetShader(DSTALPHA_DUAL_SOURCE_BLEND, g_nativeVertexFmt->m_components);
 		}
 		else
 		{
-			ProgramShaderCache::SetShader(DSTALPHA_NONE,g_nativeVertexFmt->m_components);
+			shader = ProgramShaderCache::SetShader(DSTALPHA_NONE,g_nativeVertexFmt->m_components);
 		}
 	}
 	else
 	{
-		ProgramShaderCache::SetShader(DSTALPHA_NONE,g_nativeVertexFmt->m_components);
+		shader = ProgramShaderCache::SetShader(DSTALPHA_NONE,g_nativeVertexFmt->m_components);
+	}
+
+	// The program is still being compiled in the background.
+	if (!shader && g_ActiveConfig.iAsyncShaderMode != ASYNC_SHADERS_OFF)
+	{
+		ClearEFBCache();
+		return;
 	}
 
 	// upload global constants
@@ -185,14 +193,16 @@ void VertexManager::vFlush()
 	// run through vertex groups again to set alpha
 	if (useDstAlpha && !dualSourcePossible)
 	{
-		ProgramShaderCache::SetShader(DSTALPHA_ALPHA_PASS,g_nativeVertexFmt->m_components);
-
 		// only update alpha
-		glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_TRUE);
+		if (ProgramShaderCache::SetShader(DSTALPHA_ALPHA_PASS,g_nativeVertexFmt->m_components) ||
+			g_ActiveConfig.iAsyncShaderMode == ASYNC_SHADERS_OFF)
+		{
+			glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_TRUE);
 
-		glDisable(GL_BLEND);
+			glDisable(GL_BLEND);
 
-		Draw(stride);
+			Draw(stride);
+		}
 
 		// restore color mask
 		g_renderer->SetColorMask();
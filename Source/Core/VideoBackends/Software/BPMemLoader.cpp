@@ -10,6 +10,8 @@
 #include "Rasterizer.h"
 #include "SWPixelEngine.h"
 #include "Tev.h"
+#include "TevJit.h"
+#include "TextureSampler.h"
 #include "HW/Memmap.h"
 #include "Core.h"
 
@@ -20,13 +22,71 @@ void InitBPMemory()
 	bpmem.bpMask = 0xFFFFFF;
 }
 
+// Writes which act on the EFB, TMEM or the PE registers right away
+static bool IsBPCommand(int address)
+{
+	switch (address)
+	{
+	case BPMEM_SETDRAWDONE:
+	case BPMEM_PE_TOKEN_ID:
+	case BPMEM_PE_TOKEN_INT_ID:
+	case BPMEM_TRIGGER_EFB_COPY:
+	case BPMEM_CLEARBBOX1:
+	case BPMEM_CLEARBBOX2:
+	case BPMEM_CLEAR_PIXEL_PERF:
+	case BPMEM_PRELOAD_MODE:
+	case BPMEM_LOADTLUT1:
+	case BPMEM_TEXINVALIDATE:
+		return true;
+	default:
+		return false;
+	}
+}
+
+// Registers which are only read when a triangle is set up or by the commands
+// above, binned triangles don't depend on them
+static bool IsReadWhenShading(int address)
+{
+	if (address >= BPMEM_EFB_TL && address <= BPMEM_COPYFILTER1)
+		return false;
+	if (address >= BPMEM_PRELOAD_ADDR && address <= BPMEM_BUSCLOCK1)
+		return false;
+
+	switch (address)
+	{
+	case BPMEM_DISPLAYCOPYFILER:
+	case BPMEM_DISPLAYCOPYFILER + 1:
+	case BPMEM_DISPLAYCOPYFILER + 2:
+	case BPMEM_DISPLAYCOPYFILER + 3:
+	case BPMEM_SCISSORTL:
+	case BPMEM_SCISSORBR:
+	case BPMEM_SCISSOROFFSET:
+	case BPMEM_LINEPTWIDTH:
+	case BPMEM_PERF0_TRI:
+	case BPMEM_PERF0_QUAD:
+	case BPMEM_BUSCLOCK0:
+	case BPMEM_BP_MASK:
+		return false;
+	default:
+		return true;
+	}
+}
+
 void SWLoadBPReg(u32 value)
 {
 	//handle the mask register
 	int address = value >> 24;
+
 	int oldval = ((u32*)&bpmem)[address];
 	int newval = (oldval & ~bpmem.bpMask) | (value & bpmem.bpMask);
 
+	// triangles still waiting to be shaded must see the old state
+	if (IsBPCommand(address) || (newval != oldval && IsReadWhenShading(address)))
+	{
+		Rasterizer::Flush();
+		TevJit::Invalidate();
+	}
+
 	((u32*)&bpmem)[address] = newval;
 
 	//reset the mask register
@@ -38,6 +98,14 @@ void SWLoadBPReg(u32 value)
 
 void SWBPWritten(int address, int newvalue)
 {
+	// texture registers and everything selecting the sampled texmaps
+	if ((address >= BPMEM_TX_SETMODE0 && address < BPMEM_TX_SETLUT_4 + 4) ||
+		(address >= BPMEM_TREF && address < BPMEM_TREF + 8) ||
+		address == BPMEM_IREF || address == BPMEM_GENMODE || address == BPMEM_LOADTLUT1)
+	{
+		TextureSampler::RecheckCache();
+	}
+
 	switch (address)
 	{
 	case BPMEM_SCISSORTL:
@@ -68,6 +136,7 @@ void SWBPWritten(int address, int newvalue)
 		break;
 	case BPMEM_TRIGGER_EFB_COPY:
 		EfbCopy::CopyEfb();
+		TextureSampler::InvalidateCache();
 		break;
 	case BPMEM_CLEARBBOX1:
 		SWPixelEngine::pereg.boxRight = newvalue >> 10;
@@ -114,9 +183,15 @@ void SWBPWritten(int address, int newvalue)
 			break;
 		}
 
+	case BPMEM_TEXINVALIDATE:
+		TextureSampler::InvalidateCache();
+		break;
+
 	case BPMEM_PRELOAD_MODE:
 		if (newvalue != 0)
 		{
+			TextureSampler::InvalidateCache();
+
 			// TODO: Not quite sure if this is completely correct (likely not)
 			// NOTE: libogc's implementation of GX_PreloadEntireTexture seems flawed, so it's not necessarily a good reference for RE'ing this feature.
 
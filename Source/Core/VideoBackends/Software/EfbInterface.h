@@ -6,6 +6,8 @@
 
 #include "VideoCommon.h"
 
+extern u8 efb[EFB_WIDTH*EFB_HEIGHT*6];
+
 namespace EfbInterface
 {
 	const int DEPTH_BUFFER_START = EFB_WIDTH * EFB_HEIGHT * 3;
@@ -3,6 +3,13 @@
 // Refer to the license.txt file included.
 
 #include "Common.h"
+#include "Thread.h"
+
+#include <vector>
+
+#ifndef _M_GENERIC
+#include <emmintrin.h>
+#endif
 
 #include "Rasterizer.h"
 #include "HwRasterizer.h"
@@ -10,13 +17,21 @@
 #include "BPMemLoader.h"
 #include "XFMemLoader.h"
 #include "Tev.h"
-#include "SWPixelEngine.h"
+#include "TevJit.h"
+#include "TextureSampler.h"
 #include "SWStatistics.h"
 #include "SWVideoConfig.h"
 
 
 #define BLOCK_SIZE 2
 
+// Triangles are binned into TILE_SIZE x TILE_SIZE screen tiles which are shaded
+// in parallel. Every tile is drawn by a single thread in submission order.
+#define TILE_SIZE 64
+#define TILES_X ((EFB_WIDTH + TILE_SIZE - 1) / TILE_SIZE)
+#define TILES_Y ((EFB_HEIGHT + TILE_SIZE - 1) / TILE_SIZE)
+#define MAX_BINNED_TRIANGLES 4096
+
 #define CLAMP(x, a, b) (x>b)?b:(x<a)?a:x
 
 // returns approximation of log2(f) in s28.4
@@ -32,15 +47,37 @@ static inline s32 FixedLog2(float f)
 
 namespace Rasterizer
 {
-Slope ZSlope;
-Slope WSlope;
-Slope ColorSlopes[2][4];
-Slope TexSlopes[8][3];
+// Everything needed to rasterize a triangle, so that binned triangles can be
+// shaded later on any thread
+struct TriangleSetup
+{
+	Slope ZSlope;
+	Slope WSlope;
+	Slope ColorSlopes[2][4];
+	Slope TexSlopes[8][3];
+
+	s32 vertex0X;
+	s32 vertex0Y;
+	float vertexOffsetX;
+	float vertexOffsetY;
+
+	// half-edge constants and deltas in 28.4 fixed point
+	s32 C1, C2, C3;
+	s32 DX12, DX23, DX31;
+	s32 DY12, DY23, DY31;
+
+	// scissored bounding rectangle, minx and miny are block aligned
+	s32 minx, maxx, miny, maxy;
+};
+
+struct RasterWorker
+{
+	Tev tev;
+	RasterBlock rasterBlock;
+	std::thread thread;
+};
 
-s32 vertex0X;
-s32 vertex0Y;
-float vertexOffsetX;
-float vertexOffsetY;
+TriangleSetup triangle;
 
 s32 scissorLeft = 0;
 s32 scissorTop = 0;
@@ -50,20 +87,32 @@ s32 scissorBottom = 0;
 Tev tev;
 RasterBlock rasterBlock;
 
+static std::vector<TriangleSetup> s_binnedTriangles;
+static std::vector<u32> s_tileBins[TILES_X * TILES_Y];
+
+static std::vector<RasterWorker*> s_workers;
+static std::mutex s_workerLock;
+static std::condition_variable s_workAvailable;
+static std::condition_variable s_workDone;
+static u32 s_workGeneration = 0;
+static u32 s_busyWorkers = 0;
+static int s_nextTile = 0;
+static bool s_workersQuit = false;
+
 void DoState(PointerWrap &p)
 {
-	ZSlope.DoState(p);
-	WSlope.DoState(p);
-	for (auto& ColorSlope : ColorSlopes)
+	triangle.ZSlope.DoState(p);
+	triangle.WSlope.DoState(p);
+	for (auto& ColorSlope : triangle.ColorSlopes)
 		for (int n=0; n<4; ++n)
 			ColorSlope[n].DoState(p);
-	for (auto& TexSlope : TexSlopes)
+	for (auto& TexSlope : triangle.TexSlopes)
 		for (int n=0; n<3; ++n)
 			TexSlope[n].DoState(p);
-	p.Do(vertex0X);
-	p.Do(vertex0Y);
-	p.Do(vertexOffsetX);
-	p.Do(vertexOffsetY);
+	p.Do(triangle.vertex0X);
+	p.Do(triangle.vertex0Y);
+	p.Do(triangle.vertexOffsetX);
+	p.Do(triangle.vertexOffsetY);
 	p.Do(scissorLeft);
 	p.Do(scissorTop);
 	p.Do(scissorRight);
@@ -78,8 +127,8 @@ void Init()
 
 	// Set initial z reference plane in the unlikely case that zfreeze is enabled when drawing the first primitive.
 	// TODO: This is just a guess!
-	ZSlope.dfdx = ZSlope.dfdy = 0.f;
-	ZSlope.f0 = 1.f;
+	triangle.ZSlope.dfdx = triangle.ZSlope.dfdy = 0.f;
+	triangle.ZSlope.f0 = 1.f;
 }
 
 inline int iround(float x)
@@ -124,32 +173,27 @@ void SetTevReg(int reg, int comp, bool konst, s16 color)
 	tev.SetRegColor(reg, comp, konst, color);
 }
 
-inline void Draw(s32 x, s32 y, s32 xi, s32 yi)
+static inline void Draw(Tev &tev, const RasterBlock &block, s32 x, s32 y, int lane)
 {
-	INCSTAT(swstats.thisFrame.rasterizedPixels);
+	tev.PEState.rasterizedPixels++;
 
-	float dx = vertexOffsetX + (float)(x - vertex0X);
-	float dy = vertexOffsetY + (float)(y - vertex0Y);
-
-	s32 z = (s32)ZSlope.GetValue(dx, dy);
+	s32 z = block.Z[lane];
 	if (z < 0 || z > 0x00ffffff)
 		return;
 
 	if (bpmem.UseEarlyDepthTest() && g_SWVideoConfig.bZComploc)
 	{
 		// TODO: Test if perf regs are incremented even if test is disabled
-		SWPixelEngine::pereg.IncZInputQuadCount(true);
+		tev.PEState.zInputPixels[1]++;
 		if (bpmem.zmode.testenable)
 		{
 			// early z
 			if (!EfbInterface::ZCompare(x, y, z))
 				return;
 		}
-		SWPixelEngine::pereg.IncZOutputQuadCount(true);
+		tev.PEState.zOutputPixels[1]++;
 	}
 
-	RasterBlockPixel& pixel = rasterBlock.Pixel[xi][yi];
-
 	tev.Position[0] = x;
 	tev.Position[1] = y;
 	tev.Position[2] = z;
@@ -159,7 +203,7 @@ inline void Draw(s32 x, s32 y, s32 xi, s32 yi)
 	{
 		for(int comp = 0; comp < 4; comp++)
 		{
-			u16 color = (u16)ColorSlopes[i][comp].GetValue(dx, dy);
+			u16 color = (u16)block.Color[i][comp][lane];
 
 			// clamp color value to 0
 			u16 mask = ~(color >> 8);
@@ -172,20 +216,20 @@ inline void Draw(s32 x, s32 y, s32 xi, s32 yi)
 	for (unsigned int i = 0; i < bpmem.genMode.numtexgens; i++)
 	{
 		// multiply by 128 because TEV stores UVs as s17.7
-		tev.Uv[i].s = (s32)(pixel.Uv[i][0] * 128);
-		tev.Uv[i].t = (s32)(pixel.Uv[i][1] * 128);
+		tev.Uv[i].s = (s32)(block.Uv[i][0][lane] * 128);
+		tev.Uv[i].t = (s32)(block.Uv[i][1][lane] * 128);
 	}
 
 	for (unsigned int i = 0; i < bpmem.genMode.numindstages; i++)
 	{
-		tev.IndirectLod[i] = rasterBlock.IndirectLod[i];
-		tev.IndirectLinear[i] = rasterBlock.IndirectLinear[i];
+		tev.IndirectLod[i] = block.IndirectLod[i];
+		tev.IndirectLinear[i] = block.IndirectLinear[i];
 	}
 
 	for (unsigned int i = 0; i <= bpmem.genMode.numtevstages; i++)
 	{
-		tev.TextureLod[i] = rasterBlock.TextureLod[i];
-		tev.TextureLinear[i] = rasterBlock.TextureLinear[i];
+		tev.TextureLod[i] = block.TextureLod[i];
+		tev.TextureLinear[i] = block.TextureLinear[i];
 	}
 
 	tev.Draw();
@@ -193,14 +237,14 @@ inline void Draw(s32 x, s32 y, s32 xi, s32 yi)
 
 void InitTriangle(float X1, float Y1, s32 xi, s32 yi)
 {
-	vertex0X = xi;
-	vertex0Y = yi;
+	triangle.vertex0X = xi;
+	triangle.vertex0Y = yi;
 
 	// adjust a little less than 0.5
 	const float adjust = 0.495f;
 
-	vertexOffsetX = ((float)xi - X1) + adjust;
-	vertexOffsetY = ((float)yi - Y1) + adjust;
+	triangle.vertexOffsetX = ((float)xi - X1) + adjust;
+	triangle.vertexOffsetY = ((float)yi - Y1) + adjust;
 }
 
 void InitSlope(Slope *slope, float f1, float f2, float f3, float DX31, float DX12, float DY12, float DY31)
@@ -215,7 +259,7 @@ void InitSlope(Slope *slope, float f1, float f2, float f3, float DX31, float DX1
 	slope->f0 = f1;
 }
 
-inline void CalculateLOD(s32 &lod, bool &linear, u32 texmap, u32 texcoord)
+inline void CalculateLOD(const RasterBlock &block, s32 &lod, bool &linear, u32 texmap, u32 texcoord)
 {
 	FourTexUnits& texUnit = bpmem.tex[(texmap >> 2) & 1];
 	u8 subTexmap = texmap & 3;
@@ -225,23 +269,19 @@ inline void CalculateLOD(s32 &lod, bool &linear, u32 texmap, u32 texcoord)
 	TexMode0& tm0 = texUnit.texMode0[subTexmap];
 	TexMode1& tm1 = texUnit.texMode1[subTexmap];
 
+	const float *s = block.Uv[texcoord][0];
+	const float *t = block.Uv[texcoord][1];
+
 	float sDelta, tDelta;
 	if (tm0.diag_lod)
 	{
-		float *uv0 = rasterBlock.Pixel[0][0].Uv[texcoord];
-		float *uv1 = rasterBlock.Pixel[1][1].Uv[texcoord];
-
-		sDelta = fabsf(uv0[0] - uv1[0]);
-		tDelta = fabsf(uv0[1] - uv1[1]);
+		sDelta = fabsf(s[0] - s[3]);
+		tDelta = fabsf(t[0] - t[3]);
 	}
 	else
 	{
-		float *uv0 = rasterBlock.Pixel[0][0].Uv[texcoord];
-		float *uv1 = rasterBlock.Pixel[1][0].Uv[texcoord];
-		float *uv2 = rasterBlock.Pixel[0][1].Uv[texcoord];
-
-		sDelta = max(fabsf(uv0[0] - uv1[0]), fabsf(uv0[0] - uv2[0]));
-		tDelta = max(fabsf(uv0[1] - uv1[1]), fabsf(uv0[1] - uv2[1]));
+		sDelta = max(fabsf(s[0] - s[1]), fabsf(s[0] - s[2]));
+		tDelta = max(fabsf(t[0] - t[1]), fabsf(t[0] - t[2]));
 	}
 
 	// get LOD in s28.4
@@ -261,36 +301,81 @@ inline void CalculateLOD(s32 &lod, bool &linear, u32 texmap, u32 texcoord)
 	lod = CLAMP(lod, (s32)tm1.min_lod, (s32)tm1.max_lod);
 }
 
-void BuildBlock(s32 blockX, s32 blockY)
+#ifndef _M_GENERIC
+static inline __m128 GetValues(const Slope &slope, __m128 dx, __m128 dy)
+{
+	// same order of operations as Slope::GetValue()
+	__m128 value = _mm_add_ps(_mm_set1_ps(slope.f0), _mm_mul_ps(_mm_set1_ps(slope.dfdx), dx));
+	return _mm_add_ps(value, _mm_mul_ps(_mm_set1_ps(slope.dfdy), dy));
+}
+#endif
+
+static void BuildBlock(const TriangleSetup &tri, RasterBlock &block, s32 blockX, s32 blockY)
 {
-	for (s32 yi = 0; yi < BLOCK_SIZE; yi++)
+#ifndef _M_GENERIC
+	const __m128 dx = _mm_add_ps(_mm_set1_ps(tri.vertexOffsetX),
+		_mm_cvtepi32_ps(_mm_add_epi32(_mm_set1_epi32(blockX - tri.vertex0X), _mm_setr_epi32(0, 1, 0, 1))));
+	const __m128 dy = _mm_add_ps(_mm_set1_ps(tri.vertexOffsetY),
+		_mm_cvtepi32_ps(_mm_add_epi32(_mm_set1_epi32(blockY - tri.vertex0Y), _mm_setr_epi32(0, 0, 1, 1))));
+
+	const __m128 invW = _mm_div_ps(_mm_set1_ps(1.0f), GetValues(tri.WSlope, dx, dy));
+	_mm_storeu_ps(block.InvW, invW);
+
+	_mm_storeu_si128((__m128i*)block.Z, _mm_cvttps_epi32(GetValues(tri.ZSlope, dx, dy)));
+
+	for (unsigned int i = 0; i < bpmem.genMode.numcolchans; i++)
+	{
+		for (int comp = 0; comp < 4; comp++)
+			_mm_storeu_si128((__m128i*)block.Color[i][comp], _mm_cvttps_epi32(GetValues(tri.ColorSlopes[i][comp], dx, dy)));
+	}
+
+	// tex coords
+	for (unsigned int i = 0; i < bpmem.genMode.numtexgens; i++)
 	{
-		for (s32 xi = 0; xi < BLOCK_SIZE; xi++)
+		__m128 projection = invW;
+		if (swxfregs.texMtxInfo[i].projection)
 		{
-			RasterBlockPixel& pixel = rasterBlock.Pixel[xi][yi];
+			__m128 q = _mm_mul_ps(GetValues(tri.TexSlopes[i][2], dx, dy), invW);
+			__m128 valid = _mm_cmpneq_ps(q, _mm_setzero_ps());
+			projection = _mm_or_ps(_mm_and_ps(valid, _mm_div_ps(invW, q)), _mm_andnot_ps(valid, invW));
+		}
 
-			float dx = vertexOffsetX + (float)(xi + blockX - vertex0X);
-			float dy = vertexOffsetY + (float)(yi + blockY - vertex0Y);
+		_mm_storeu_ps(block.Uv[i][0], _mm_mul_ps(GetValues(tri.TexSlopes[i][0], dx, dy), projection));
+		_mm_storeu_ps(block.Uv[i][1], _mm_mul_ps(GetValues(tri.TexSlopes[i][1], dx, dy), projection));
+	}
+#else
+	for (int lane = 0; lane < 4; lane++)
+	{
+		float dx = tri.vertexOffsetX + (float)((lane & 1) + blockX - tri.vertex0X);
+		float dy = tri.vertexOffsetY + (float)((lane >> 1) + blockY - tri.vertex0Y);
 
-			float invW = 1.0f / WSlope.GetValue(dx, dy);
-			pixel.InvW = invW;
+		float invW = 1.0f / tri.WSlope.GetValue(dx, dy);
+		block.InvW[lane] = invW;
 
-			// tex coords
-			for (unsigned int i = 0; i < bpmem.genMode.numtexgens; i++)
+		block.Z[lane] = (s32)tri.ZSlope.GetValue(dx, dy);
+
+		for (unsigned int i = 0; i < bpmem.genMode.numcolchans; i++)
+		{
+			for (int comp = 0; comp < 4; comp++)
+				block.Color[i][comp][lane] = (s32)tri.ColorSlopes[i][comp].GetValue(dx, dy);
+		}
+
+		// tex coords
+		for (unsigned int i = 0; i < bpmem.genMode.numtexgens; i++)
+		{
+			float projection = invW;
+			if (swxfregs.texMtxInfo[i].projection)
 			{
-				float projection = invW;
-				if (swxfregs.texMtxInfo[i].projection)
-				{
-					float q = TexSlopes[i][2].GetValue(dx, dy) * invW;
-					if (q != 0.0f)
-						projection = invW / q;
-				}
-
-				pixel.Uv[i][0] = TexSlopes[i][0].GetValue(dx, dy) * projection;
-				pixel.Uv[i][1] = TexSlopes[i][1].GetValue(dx, dy) * projection;
+				float q = tri.TexSlopes[i][2].GetValue(dx, dy) * invW;
+				if (q != 0.0f)
+					projection = invW / q;
 			}
+
+			block.Uv[i][0][lane] = tri.TexSlopes[i][0].GetValue(dx, dy) * projection;
+			block.Uv[i][1][lane] = tri.TexSlopes[i][1].GetValue(dx, dy) * projection;
 		}
 	}
+#endif
 
 	u32 indref = bpmem.tevindref.hex;
 	for (unsigned int i = 0; i < bpmem.genMode.numindstages; i++)
@@ -300,7 +385,7 @@ void BuildBlock(s32 blockX, s32 blockY)
 		u32 texcoord = indref & 3;
 		indref >>= 3;
 
-		CalculateLOD(rasterBlock.IndirectLod[i], rasterBlock.IndirectLinear[i], texmap, texcoord);
+		CalculateLOD(block, block.IndirectLod[i], block.IndirectLinear[i], texmap, texcoord);
 	}
 
 	for (unsigned int i = 0; i <= bpmem.genMode.numtevstages; i++)
@@ -312,9 +397,255 @@ void BuildBlock(s32 blockX, s32 blockY)
 			u32 texmap = order.getTexMap(stageOdd);
 			u32 texcoord = order.getTexCoord(stageOdd);
 
-			CalculateLOD(rasterBlock.TextureLod[i], rasterBlock.TextureLinear[i], texmap, texcoord);
+			CalculateLOD(block, block.TextureLod[i], block.TextureLinear[i], texmap, texcoord);
+		}
+	}
+}
+
+// Returns which pixels of the block at x, y are inside the triangle, one bit per lane
+static inline int GetCoverage(const TriangleSetup &tri, s32 x, s32 y)
+{
+	const s32 x0 = x << 4;
+	const s32 y0 = y << 4;
+
+	// Evaluate half-space functions at the top left pixel,
+	// the other pixels are one step of 16 (28.4 fixed point) away
+	const s32 CY1 = tri.C1 + tri.DX12 * y0 - tri.DY12 * x0;
+	const s32 CY2 = tri.C2 + tri.DX23 * y0 - tri.DY23 * x0;
+	const s32 CY3 = tri.C3 + tri.DX31 * y0 - tri.DY31 * x0;
+
+#ifndef _M_GENERIC
+	const __m128i zero = _mm_setzero_si128();
+	__m128i e1 = _mm_add_epi32(_mm_set1_epi32(CY1), _mm_setr_epi32(0, -(tri.DY12 << 4), tri.DX12 << 4, (tri.DX12 - tri.DY12) << 4));
+	__m128i e2 = _mm_add_epi32(_mm_set1_epi32(CY2), _mm_setr_epi32(0, -(tri.DY23 << 4), tri.DX23 << 4, (tri.DX23 - tri.DY23) << 4));
+	__m128i e3 = _mm_add_epi32(_mm_set1_epi32(CY3), _mm_setr_epi32(0, -(tri.DY31 << 4), tri.DX31 << 4, (tri.DX31 - tri.DY31) << 4));
+
+	__m128i inside = _mm_and_si128(_mm_and_si128(_mm_cmpgt_epi32(e1, zero), _mm_cmpgt_epi32(e2, zero)), _mm_cmpgt_epi32(e3, zero));
+	return _mm_movemask_ps(_mm_castsi128_ps(inside));
+#else
+	int mask = 0;
+	for (int lane = 0; lane < 4; lane++)
+	{
+		s32 xs = (lane & 1) << 4;
+		s32 ys = (lane >> 1) << 4;
+		if (CY1 + tri.DX12 * ys - tri.DY12 * xs > 0 &&
+			CY2 + tri.DX23 * ys - tri.DY23 * xs > 0 &&
+			CY3 + tri.DX31 * ys - tri.DY31 * xs > 0)
+		{
+			mask |= 1 << lane;
+		}
+	}
+	return mask;
+#endif
+}
+
+// Draws the part of the triangle within the given rectangle, minx and miny must be block aligned
+static void RasterizeTriangle(const TriangleSetup &tri, Tev &tev, RasterBlock &block, s32 minx, s32 maxx, s32 miny, s32 maxy)
+{
+	// Loop through blocks
+	for(s32 y = miny; y < maxy; y += BLOCK_SIZE)
+	{
+		for(s32 x = minx; x < maxx; x += BLOCK_SIZE)
+		{
+			int coverage = GetCoverage(tri, x, y);
+			if (coverage == 0)
+				continue;
+
+			BuildBlock(tri, block, x, y);
+
+			for (int lane = 0; lane < 4; lane++)
+			{
+				if (coverage & (1 << lane))
+					Draw(tev, block, x + (lane & 1), y + (lane >> 1), lane);
+			}
+		}
+	}
+}
+
+static void DrawTile(int tile, Tev &tev, RasterBlock &block)
+{
+	const s32 tileX = (tile % TILES_X) * TILE_SIZE;
+	const s32 tileY = (tile / TILES_X) * TILE_SIZE;
+
+	for (u32 index : s_tileBins[tile])
+	{
+		const TriangleSetup &tri = s_binnedTriangles[index];
+		RasterizeTriangle(tri, tev, block,
+			max(tri.minx, tileX), min(tri.maxx, tileX + TILE_SIZE),
+			max(tri.miny, tileY), min(tri.maxy, tileY + TILE_SIZE));
+	}
+}
+
+// Shades tiles until there are none left, called by the workers and the video thread
+static void DrawTiles(Tev &tev, RasterBlock &block)
+{
+	while (true)
+	{
+		int tile;
+		{
+			std::lock_guard<std::mutex> lk(s_workerLock);
+			while (s_nextTile < TILES_X * TILES_Y && s_tileBins[s_nextTile].empty())
+				s_nextTile++;
+			if (s_nextTile == TILES_X * TILES_Y)
+				return;
+			tile = s_nextTile++;
+		}
+
+		DrawTile(tile, tev, block);
+	}
+}
+
+static void WorkerThread(RasterWorker *worker)
+{
+	Common::SetCurrentThreadName("Rasterizer worker");
+
+	u32 generation = 0;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lk(s_workerLock);
+			while (!s_workersQuit && s_workGeneration == generation)
+				s_workAvailable.wait(lk);
+			if (s_workersQuit)
+				return;
+			generation = s_workGeneration;
 		}
+
+		DrawTiles(worker->tev, worker->rasterBlock);
+
+		std::lock_guard<std::mutex> lk(s_workerLock);
+		if (--s_busyWorkers == 0)
+			s_workDone.notify_one();
+	}
+}
+
+static void StopWorkers()
+{
+	Flush();
+
+	{
+		std::lock_guard<std::mutex> lk(s_workerLock);
+		s_workersQuit = true;
+	}
+	s_workAvailable.notify_all();
+
+	for (RasterWorker *worker : s_workers)
+	{
+		worker->thread.join();
+		delete worker;
+	}
+	s_workers.clear();
+	s_workersQuit = false;
+}
+
+static void StartWorkers(u32 count)
+{
+	StopWorkers();
+
+	for (u32 i = 0; i < count; i++)
+	{
+		RasterWorker *worker = new RasterWorker;
+		worker->tev.Init();
+		worker->thread = std::thread(WorkerThread, worker);
+		s_workers.push_back(worker);
+	}
+}
+
+// Number of threads helping the video thread to shade tiles
+static u32 GetWorkerCount()
+{
+	// The debug dumps need every pixel to be drawn when its triangle is submitted
+	if (g_SWVideoConfig.bDumpObjects || g_SWVideoConfig.bDumpFrames ||
+		g_SWVideoConfig.bDumpTevStages || g_SWVideoConfig.bDumpTevTextureFetches)
+		return 0;
+
+	u32 threads = g_SWVideoConfig.rasterizerThreads;
+	if (threads == 0)
+		threads = std::thread::hardware_concurrency();
+
+	return threads > 1 ? threads - 1 : 0;
+}
+
+void Shutdown()
+{
+	StopWorkers();
+}
+
+// Draws the binned triangles again on this thread alone, starting from the EFB
+// they were drawn over, and checks that the threads produced the same EFB
+static void VerifyTiles(const std::vector<u8> &efbBefore)
+{
+	std::vector<u8> threaded(efb, efb + sizeof(efb));
+	memcpy(efb, &efbBefore[0], sizeof(efb));
+
+	// pixel engine counters were already taken from the threaded run
+	Tev serialTev;
+	serialTev.Init();
+	serialTev.CopyRegColors(tev);
+	RasterBlock block;
+	for (const TriangleSetup &tri : s_binnedTriangles)
+		RasterizeTriangle(tri, serialTev, block, tri.minx, tri.maxx, tri.miny, tri.maxy);
+
+	if (memcmp(efb, &threaded[0], sizeof(efb)) != 0)
+		ERROR_LOG(VIDEO, "Threaded rasterizer output differs from drawing on one thread");
+
+	memcpy(efb, &threaded[0], sizeof(efb));
+}
+
+void Flush()
+{
+	if (s_binnedTriangles.empty())
+		return;
+
+	std::vector<u8> efbBefore;
+	if (g_SWVideoConfig.bVerifyRasterizerThreads)
+		efbBefore.assign(efb, efb + sizeof(efb));
+
+	for (RasterWorker *worker : s_workers)
+		worker->tev.CopyRegColors(tev);
+
+	{
+		std::lock_guard<std::mutex> lk(s_workerLock);
+		s_nextTile = 0;
+		s_busyWorkers = (u32)s_workers.size();
+		s_workGeneration++;
+	}
+	s_workAvailable.notify_all();
+
+	DrawTiles(tev, rasterBlock);
+
+	{
+		std::unique_lock<std::mutex> lk(s_workerLock);
+		while (s_busyWorkers != 0)
+			s_workDone.wait(lk);
 	}
+
+	if (!efbBefore.empty())
+		VerifyTiles(efbBefore);
+
+	for (RasterWorker *worker : s_workers)
+		worker->tev.FlushPixelEngineState();
+	tev.FlushPixelEngineState();
+
+	s_binnedTriangles.clear();
+	for (auto& bin : s_tileBins)
+		bin.clear();
+}
+
+static void BinTriangle(const TriangleSetup &tri)
+{
+	const u32 index = (u32)s_binnedTriangles.size();
+	s_binnedTriangles.push_back(tri);
+
+	// blocks never cross a tile boundary since TILE_SIZE is a multiple of BLOCK_SIZE
+	for (s32 ty = tri.miny / TILE_SIZE; ty <= (tri.maxy - 1) / TILE_SIZE; ty++)
+	{
+		for (s32 tx = tri.minx / TILE_SIZE; tx <= (tri.maxx - 1) / TILE_SIZE; tx++)
+			s_tileBins[ty * TILES_X + tx].push_back(index);
+	}
+
+	if (s_binnedTriangles.size() >= MAX_BINNED_TRIANGLES)
+		Flush();
 }
 
 void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVertexData *v2)
@@ -348,15 +679,6 @@ void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVer
 	const s32 DY23 = Y2 - Y3;
 	const s32 DY31 = Y3 - Y1;
 
-	// Fixed-pos32 deltas
-	const s32 FDX12 = DX12 << 4;
-	const s32 FDX23 = DX23 << 4;
-	const s32 FDX31 = DX31 << 4;
-
-	const s32 FDY12 = DY12 << 4;
-	const s32 FDY23 = DY23 << 4;
-	const s32 FDY31 = DY31 << 4;
-
 	// Bounding rectangle
 	s32 minx = (min(min(X1, X2), X3) + 0xF) >> 4;
 	s32 maxx = (max(max(X1, X2), X3) + 0xF) >> 4;
@@ -383,25 +705,25 @@ void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVer
 	InitTriangle(fltx1, flty1, (X1 + 0xF) >> 4, (Y1 + 0xF) >> 4);
 
 	float w[3] = { 1.0f / v0->projectedPosition.w, 1.0f / v1->projectedPosition.w, 1.0f / v2->projectedPosition.w };
-	InitSlope(&WSlope, w[0], w[1], w[2], fltdx31, fltdx12, fltdy12, fltdy31);
+	InitSlope(&triangle.WSlope, w[0], w[1], w[2], fltdx31, fltdx12, fltdy12, fltdy31);
 
 	// TODO: The zfreeze emulation is not quite correct, yet!
 	// Many things might prevent us from reaching this line (culling, clipping, scissoring).
 	// However, the zslope is always guaranteed to be calculated unless all vertices are trivially rejected during clipping!
 	// We're currently sloppy at this since we abort early if any of the culling/clipping/scissoring tests fail.
 	if (!bpmem.genMode.zfreeze || !g_SWVideoConfig.bZFreeze)
-		InitSlope(&ZSlope, v0->screenPosition[2], v1->screenPosition[2], v2->screenPosition[2], fltdx31, fltdx12, fltdy12, fltdy31);
+		InitSlope(&triangle.ZSlope, v0->screenPosition[2], v1->screenPosition[2], v2->screenPosition[2], fltdx31, fltdx12, fltdy12, fltdy31);
 
 	for(unsigned int i = 0; i < bpmem.genMode.numcolchans; i++)
 	{
 		for(int comp = 0; comp < 4; comp++)
-			InitSlope(&ColorSlopes[i][comp], v0->color[i][comp], v1->color[i][comp], v2->color[i][comp], fltdx31, fltdx12, fltdy12, fltdy31);
+			InitSlope(&triangle.ColorSlopes[i][comp], v0->color[i][comp], v1->color[i][comp], v2->color[i][comp], fltdx31, fltdx12, fltdy12, fltdy31);
 	}
 
 	for(unsigned int i = 0; i < bpmem.genMode.numtexgens; i++)
 	{
 		for(int comp = 0; comp < 3; comp++)
-			InitSlope(&TexSlopes[i][comp], v0->texCoords[i][comp] * w[0], v1->texCoords[i][comp] * w[1], v2->texCoords[i][comp] * w[2], fltdx31, fltdx12, fltdy12, fltdy31);
+			InitSlope(&triangle.TexSlopes[i][comp], v0->texCoords[i][comp] * w[0], v1->texCoords[i][comp] * w[1], v2->texCoords[i][comp] * w[2], fltdx31, fltdx12, fltdy12, fltdy31);
 	}
 
 	// Start in corner of 8x8 block
@@ -418,83 +740,35 @@ void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVer
 	if(DY23 < 0 || (DY23 == 0 && DX23 > 0)) C2++;
 	if(DY31 < 0 || (DY31 == 0 && DX31 > 0)) C3++;
 
-	// Loop through blocks
-	for(s32 y = miny; y < maxy; y += BLOCK_SIZE)
+	triangle.C1 = C1;
+	triangle.C2 = C2;
+	triangle.C3 = C3;
+	triangle.DX12 = DX12;
+	triangle.DX23 = DX23;
+	triangle.DX31 = DX31;
+	triangle.DY12 = DY12;
+	triangle.DY23 = DY23;
+	triangle.DY31 = DY31;
+	triangle.minx = minx;
+	triangle.maxx = maxx;
+	triangle.miny = miny;
+	triangle.maxy = maxy;
+
+	TevJit::Update(tev);
+	TextureSampler::UpdateCache();
+
+	u32 workers = GetWorkerCount();
+	if (workers != s_workers.size())
+		StartWorkers(workers);
+
+	if (workers)
 	{
-		for(s32 x = minx; x < maxx; x += BLOCK_SIZE)
-		{
-			// Corners of block
-			s32 x0 = x << 4;
-			s32 x1 = (x + BLOCK_SIZE - 1) << 4;
-			s32 y0 = y << 4;
-			s32 y1 = (y + BLOCK_SIZE - 1) << 4;
-
-			// Evaluate half-space functions
-			bool a00 = C1 + DX12 * y0 - DY12 * x0 > 0;
-			bool a10 = C1 + DX12 * y0 - DY12 * x1 > 0;
-			bool a01 = C1 + DX12 * y1 - DY12 * x0 > 0;
-			bool a11 = C1 + DX12 * y1 - DY12 * x1 > 0;
-			int a = (a00 << 0) | (a10 << 1) | (a01 << 2) | (a11 << 3);
-
-			bool b00 = C2 + DX23 * y0 - DY23 * x0 > 0;
-			bool b10 = C2 + DX23 * y0 - DY23 * x1 > 0;
-			bool b01 = C2 + DX23 * y1 - DY23 * x0 > 0;
-			bool b11 = C2 + DX23 * y1 - DY23 * x1 > 0;
-			int b = (b00 << 0) | (b10 << 1) | (b01 << 2) | (b11 << 3);
-
-			bool c00 = C3 + DX31 * y0 - DY31 * x0 > 0;
-			bool c10 = C3 + DX31 * y0 - DY31 * x1 > 0;
-			bool c01 = C3 + DX31 * y1 - DY31 * x0 > 0;
-			bool c11 = C3 + DX31 * y1 - DY31 * x1 > 0;
-			int c = (c00 << 0) | (c10 << 1) | (c01 << 2) | (c11 << 3);
-
-			// Skip block when outside an edge
-			if(a == 0x0 || b == 0x0 || c == 0x0)
-				continue;
-
-			BuildBlock(x, y);
-
-			// Accept whole block when totally covered
-			if(a == 0xF && b == 0xF && c == 0xF)
-			{
-				for(s32 iy = 0; iy < BLOCK_SIZE; iy++)
-				{
-					for(s32 ix = 0; ix < BLOCK_SIZE; ix++)
-					{
-						Draw(x + ix, y + iy, ix, iy);
-					}
-				}
-			}
-			else // Partially covered block
-			{
-				s32 CY1 = C1 + DX12 * y0 - DY12 * x0;
-				s32 CY2 = C2 + DX23 * y0 - DY23 * x0;
-				s32 CY3 = C3 + DX31 * y0 - DY31 * x0;
-
-				for(s32 iy = 0; iy < BLOCK_SIZE; iy++)
-				{
-					s32 CX1 = CY1;
-					s32 CX2 = CY2;
-					s32 CX3 = CY3;
-
-					for(s32 ix = 0; ix < BLOCK_SIZE; ix++)
-					{
-						if(CX1 > 0 && CX2 > 0 && CX3 > 0)
-						{
-							Draw(x + ix, y + iy, ix, iy);
-						}
-
-						CX1 -= FDY12;
-						CX2 -= FDY23;
-						CX3 -= FDY31;
-					}
-
-					CY1 += FDX12;
-					CY2 += FDX23;
-					CY3 += FDX31;
-				}
-			}
-		}
+		BinTriangle(triangle);
+	}
+	else
+	{
+		RasterizeTriangle(triangle, tev, rasterBlock, minx, maxx, miny, maxy);
+		tev.FlushPixelEngineState();
 	}
 }
 
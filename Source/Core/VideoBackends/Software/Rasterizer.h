@@ -10,6 +10,7 @@
 namespace Rasterizer
 {
 	void Init();
+	void Shutdown();
 
 	void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVertexData *v2);
 
@@ -17,6 +18,10 @@ namespace Rasterizer
 
 	void SetTevReg(int reg, int comp, bool konst, s16 color);
 
+	// Shades all triangles that are still waiting in the tile bins.
+	// Must be called before anything the rasterizer reads (BP/XF memory) changes.
+	void Flush();
+
 	struct Slope
 	{
 		float dfdx;
@@ -32,15 +37,13 @@ namespace Rasterizer
 		}
 	};
 
-	struct RasterBlockPixel
-	{
-		float InvW;
-		float Uv[8][2];
-	};
-
+	// Interpolants of a 2x2 pixel block, one lane per pixel (x + y * 2)
 	struct RasterBlock
 	{
-		RasterBlockPixel Pixel[2][2];
+		float InvW[4];
+		float Uv[8][2][4];
+		s32 Z[4];
+		s32 Color[2][4][4];
 		s32 IndirectLod[4];
 		bool IndirectLinear[4];
 		s32 TextureLod[16];
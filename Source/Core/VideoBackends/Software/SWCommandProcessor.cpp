@@ -16,6 +16,7 @@
 #include "ChunkFile.h"
 #include "MathUtil.h"
 #include "OpcodeDecoder.h"
+#include "Rasterizer.h"
 
 
 namespace SWCommandProcessor
@@ -420,6 +421,9 @@ bool RunBuffer()
 		availableBytes = writePos - readPos;
 	}
 
+	// finish drawing before reporting the GPU as idle
+	Rasterizer::Flush();
+
 	cpreg.status.CommandIdle = 1;
 
 	bool ranDecoder = false;
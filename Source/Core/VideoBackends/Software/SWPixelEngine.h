@@ -147,51 +147,35 @@ namespace SWPixelEngine
 		u16 perfEfbCopyClocksHi;
 
 		// NOTE: hardware doesn't process individual pixels but quads instead. Current software renderer architecture works on pixels though, so we have this "quad" hack here to only increment the registers on every fourth rendered pixel
-		void IncZInputQuadCount(bool early_ztest)
+		static void AddQuads(u16 &lo, u16 &hi, u32 &quad, u32 pixels)
 		{
-			static int quad = 0;
-			if (++quad != 3)
-				return;
-			quad = 0;
+			quad += pixels;
+			u32 value = ((hi << 16) | lo) + quad / 3;
+			quad %= 3;
 
+			lo = value & 0xffff;
+			hi = value >> 16;
+		}
+		void AddZInputPixels(bool early_ztest, u32 pixels)
+		{
+			static u32 quad = 0;
 			if (early_ztest)
-			{
-				if (++perfZcompInputZcomplocLo == 0)
-					perfZcompInputZcomplocHi++;
-			}
+				AddQuads(perfZcompInputZcomplocLo, perfZcompInputZcomplocHi, quad, pixels);
 			else
-			{
-				if (++perfZcompInputLo == 0)
-					perfZcompInputHi++;
-			}
+				AddQuads(perfZcompInputLo, perfZcompInputHi, quad, pixels);
 		}
-		void IncZOutputQuadCount(bool early_ztest)
+		void AddZOutputPixels(bool early_ztest, u32 pixels)
 		{
-			static int quad = 0;
-			if (++quad != 3)
-				return;
-			quad = 0;
-
+			static u32 quad = 0;
 			if (early_ztest)
-			{
-				if (++perfZcompOutputZcomplocLo == 0)
-					perfZcompOutputZcomplocHi++;
-			}
+				AddQuads(perfZcompOutputZcomplocLo, perfZcompOutputZcomplocHi, quad, pixels);
 			else
-			{
-				if (++perfZcompOutputLo == 0)
-					perfZcompOutputHi++;
-			}
+				AddQuads(perfZcompOutputLo, perfZcompOutputHi, quad, pixels);
 		}
-		void IncBlendInputQuadCount()
+		void AddBlendInputPixels(u32 pixels)
 		{
-			static int quad = 0;
-			if (++quad != 3)
-				return;
-			quad = 0;
-
-			if (++perfBlendInputLo == 0)
-				perfBlendInputHi++;
+			static u32 quad = 0;
+			AddQuads(perfBlendInputLo, perfBlendInputHi, quad, pixels);
 		}
 	};
 
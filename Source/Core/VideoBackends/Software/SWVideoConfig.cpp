@@ -16,12 +16,14 @@ SWVideoConfig::SWVideoConfig()
 
 	bHwRasterizer = false;
 	bBypassXFB = false;
+	rasterizerThreads = 0;
 
 	bShowStats = false;
 
 	bDumpTextures = false;
 	bDumpObjects = false;
 	bDumpFrames = false;
+	bVerifyRasterizerThreads = false;
 
 	bZComploc = true;
 	bZFreeze = true;
@@ -43,6 +45,7 @@ void SWVideoConfig::Load(const char* ini_file)
 
 	iniFile.Get("Rendering", "HwRasterizer", &bHwRasterizer, false);
 	iniFile.Get("Rendering", "BypassXFB", &bBypassXFB, false);
+	iniFile.Get("Rendering", "RasterizerThreads", &rasterizerThreads, 0);
 	iniFile.Get("Rendering", "ZComploc", &bZComploc, true);
 	iniFile.Get("Rendering", "ZFreeze", &bZFreeze, true);
 
@@ -51,6 +54,7 @@ void SWVideoConfig::Load(const char* ini_file)
 	iniFile.Get("Utility", "DumpTexture", &bDumpTextures, false);
 	iniFile.Get("Utility", "DumpObjects", &bDumpObjects, false);
 	iniFile.Get("Utility", "DumpFrames", &bDumpFrames, false);
+	iniFile.Get("Utility", "VerifyRasterizerThreads", &bVerifyRasterizerThreads, false);
 	iniFile.Get("Utility", "DumpTevStages", &bDumpTevStages, false);
 	iniFile.Get("Utility", "DumpTevTexFetches", &bDumpTevTextureFetches, false);
 
@@ -68,6 +72,7 @@ void SWVideoConfig::Save(const char* ini_file)
 
 	iniFile.Set("Rendering", "HwRasterizer", bHwRasterizer);
 	iniFile.Set("Rendering", "BypassXFB", bBypassXFB);
+	iniFile.Set("Rendering", "RasterizerThreads", rasterizerThreads);
 	iniFile.Set("Rendering", "ZComploc", bZComploc);
 	iniFile.Set("Rendering", "ZFreeze", bZFreeze);
 
@@ -76,6 +81,7 @@ void SWVideoConfig::Save(const char* ini_file)
 	iniFile.Set("Utility", "DumpTexture", bDumpTextures);
 	iniFile.Set("Utility", "DumpObjects", bDumpObjects);
 	iniFile.Set("Utility", "DumpFrames", bDumpFrames);
+	iniFile.Set("Utility", "VerifyRasterizerThreads", bVerifyRasterizerThreads);
 	iniFile.Set("Utility", "DumpTevStages", bDumpTevStages);
 	iniFile.Set("Utility", "DumpTevTexFetches", bDumpTevTextureFetches);
 
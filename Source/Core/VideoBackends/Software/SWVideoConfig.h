@@ -23,6 +23,9 @@ struct SWVideoConfig : NonCopyable
 	bool bHwRasterizer;
 	bool bBypassXFB;
 
+	// Threads used to shade triangles, 0 means one per CPU core
+	u32 rasterizerThreads;
+
 	// Emulation features
 	bool bZComploc;
 	bool bZFreeze;
@@ -33,6 +36,9 @@ struct SWVideoConfig : NonCopyable
 	bool bDumpObjects;
 	bool bDumpFrames;
 
+	// Draws everything again on one thread and compares the EFB
+	bool bVerifyRasterizerThreads;
+
 	// Debug only
 	bool bDumpTevStages;
 	bool bDumpTevTextureFetches;
@@ -19,6 +19,8 @@
 #include "XFMemLoader.h"
 #include "Clipper.h"
 #include "Rasterizer.h"
+#include "TevJit.h"
+#include "TextureSampler.h"
 #include "SWRenderer.h"
 #include "HwRasterizer.h"
 #include "LogManager.h"
@@ -90,6 +92,7 @@ bool VideoSoftware::Initialize(void *&window_handle)
 	OpcodeDecoder::Init();
 	Clipper::Init();
 	Rasterizer::Init();
+	TevJit::Init();
 	HwRasterizer::Init();
 	SWRenderer::Init();
 	DebugUtil::Init();
@@ -124,6 +127,8 @@ void VideoSoftware::DoState(PointerWrap& p)
 	p.DoArray(g_VtxAttr, 8);
 	p.DoMarker("CP Memory");
 
+	TevJit::Invalidate();
+	TextureSampler::InvalidateCache();
 }
 
 void VideoSoftware::CheckInvalidState()
@@ -161,6 +166,9 @@ void VideoSoftware::EmuStateChange(EMUSTATE_CHANGE newState)
 void VideoSoftware::Shutdown()
 {
 	// TODO: should be in Video_Cleanup
+	Rasterizer::Shutdown();
+	TevJit::Shutdown();
+	TextureSampler::ShutdownCache();
 	HwRasterizer::Shutdown();
 	SWRenderer::Shutdown();
 
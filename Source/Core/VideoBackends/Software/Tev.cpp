@@ -12,7 +12,9 @@
 #include "SWStatistics.h"
 #include "SWVideoConfig.h"
 #include "DebugUtil.h"
+#include "TevJit.h"
 
+#include <algorithm>
 #include <cmath>
 
 #ifdef _DEBUG
@@ -36,6 +38,9 @@ void Tev::Init()
 	for (int i = 0; i < 4; i++)
 		Zero16[i] = 0;
 
+	memset(&PEState, 0, sizeof(PEState));
+	PEState.boxLeft = PEState.boxTop = 0xffff;
+
 	m_ColorInputLUT[0][RED_INP] = &Reg[0][RED_C]; m_ColorInputLUT[0][GRN_INP] = &Reg[0][GRN_C]; m_ColorInputLUT[0][BLU_INP] = &Reg[0][BLU_C]; // prev.rgb
 	m_ColorInputLUT[1][RED_INP] = &Reg[0][ALP_C]; m_ColorInputLUT[1][GRN_INP] = &Reg[0][ALP_C]; m_ColorInputLUT[1][BLU_INP] = &Reg[0][ALP_C]; // prev.aaa
 	m_ColorInputLUT[2][RED_INP] = &Reg[1][RED_C]; m_ColorInputLUT[2][GRN_INP] = &Reg[1][GRN_C]; m_ColorInputLUT[2][BLU_INP] = &Reg[1][BLU_C]; // c0.rgb
@@ -570,12 +575,48 @@ void Tev::Indirect(unsigned int stageNum, s32 s, s32 t)
 	}
 }
 
+void Tev::FetchStageTexture(unsigned int stageNum)
+{
+	int stageOdd = stageNum&1;
+	TwoTevStageOrders &order = bpmem.tevorders[stageNum >> 1];
+
+	int texcoordSel = order.getTexCoord(stageOdd);
+	int texmap = order.getTexMap(stageOdd);
+
+	Indirect(stageNum, Uv[texcoordSel].s, Uv[texcoordSel].t);
+
+	// sample texture
+	if (order.getEnable(stageOdd))
+	{
+		// RGBA
+		u8 texel[4];
+
+		TextureSampler::Sample(TexCoord.s, TexCoord.t, TextureLod[stageNum], TextureLinear[stageNum], texmap, texel);
+
+#if ALLOW_TEV_DUMPS
+		if (g_SWVideoConfig.bDumpTevTextureFetches)
+			DebugUtil::DrawTempBuffer(texel, DIRECT_TFETCH + stageNum);
+#endif
+
+		int swaptable = bpmem.combiners[stageNum].alphaC.tswap * 2;
+
+		TexColor[RED_C] = texel[bpmem.tevksel[swaptable].swap1];
+		TexColor[GRN_C] = texel[bpmem.tevksel[swaptable].swap2];
+		swaptable++;
+		TexColor[BLU_C] = texel[bpmem.tevksel[swaptable].swap1];
+		TexColor[ALP_C] = texel[bpmem.tevksel[swaptable].swap2];
+	}
+}
+
 void Tev::Draw()
 {
 	_assert_(Position[0] >= 0 && Position[0] < EFB_WIDTH);
 	_assert_(Position[1] >= 0 && Position[1] < EFB_HEIGHT);
 
-	INCSTAT(swstats.thisFrame.tevPixelsIn);
+	PEState.tevPixelsIn++;
+
+	// the result does not depend on the pixels drawn before, whichever thread drew them
+	memcpy(Reg, BPReg, sizeof(Reg));
 
 	for (unsigned int stageNum = 0; stageNum < bpmem.genMode.numindstages; stageNum++)
 	{
@@ -604,91 +645,75 @@ void Tev::Draw()
 #endif
 	}
 
-	for (unsigned int stageNum = 0; stageNum <= bpmem.genMode.numtevstages; stageNum++)
+	TevJit::TevProgram program = TevJit::GetProgram();
+	if (program)
 	{
-		int stageNum2 = stageNum >> 1;
-		int stageOdd = stageNum&1;
-		TwoTevStageOrders &order = bpmem.tevorders[stageNum2];
-		TevKSel &kSel = bpmem.tevksel[stageNum2];
-
-		// stage combiners
-		TevStageCombiner::ColorCombiner &cc = bpmem.combiners[stageNum].colorC;
-		TevStageCombiner::AlphaCombiner &ac = bpmem.combiners[stageNum].alphaC;
-
-		int texcoordSel = order.getTexCoord(stageOdd);
-		int texmap = order.getTexMap(stageOdd);
-
-		Indirect(stageNum, Uv[texcoordSel].s, Uv[texcoordSel].t);
-
-		// sample texture
-		if (order.getEnable(stageOdd))
+		// the TEV stages compiled for the current BP state
+		program(this);
+	}
+	else
+	{
+		for (unsigned int stageNum = 0; stageNum <= bpmem.genMode.numtevstages; stageNum++)
 		{
-			// RGBA
-			u8 texel[4];
-
-			TextureSampler::Sample(TexCoord.s, TexCoord.t, TextureLod[stageNum], TextureLinear[stageNum], texmap, texel);
+			int stageNum2 = stageNum >> 1;
+			int stageOdd = stageNum&1;
+			TwoTevStageOrders &order = bpmem.tevorders[stageNum2];
+			TevKSel &kSel = bpmem.tevksel[stageNum2];
 
-#if ALLOW_TEV_DUMPS
-			if (g_SWVideoConfig.bDumpTevTextureFetches)
-				DebugUtil::DrawTempBuffer(texel, DIRECT_TFETCH + stageNum);
-#endif
+			// stage combiners
+			TevStageCombiner::ColorCombiner &cc = bpmem.combiners[stageNum].colorC;
+			TevStageCombiner::AlphaCombiner &ac = bpmem.combiners[stageNum].alphaC;
 
-			int swaptable = ac.tswap * 2;
-
-			TexColor[RED_C] = texel[bpmem.tevksel[swaptable].swap1];
-			TexColor[GRN_C] = texel[bpmem.tevksel[swaptable].swap2];
-			swaptable++;
-			TexColor[BLU_C] = texel[bpmem.tevksel[swaptable].swap1];
-			TexColor[ALP_C] = texel[bpmem.tevksel[swaptable].swap2];
-		}
+			FetchStageTexture(stageNum);
 
-		// set konst for this stage
-		int kc = kSel.getKC(stageOdd);
-		int ka = kSel.getKA(stageOdd);
-		StageKonst[RED_C] = *(m_KonstLUT[kc][RED_C]);
-		StageKonst[GRN_C] = *(m_KonstLUT[kc][GRN_C]);
-		StageKonst[BLU_C] = *(m_KonstLUT[kc][BLU_C]);
-		StageKonst[ALP_C] = *(m_KonstLUT[ka][ALP_C]);
+			// set konst for this stage
+			int kc = kSel.getKC(stageOdd);
+			int ka = kSel.getKA(stageOdd);
+			StageKonst[RED_C] = *(m_KonstLUT[kc][RED_C]);
+			StageKonst[GRN_C] = *(m_KonstLUT[kc][GRN_C]);
+			StageKonst[BLU_C] = *(m_KonstLUT[kc][BLU_C]);
+			StageKonst[ALP_C] = *(m_KonstLUT[ka][ALP_C]);
 
-		// set color
-		SetRasColor(order.getColorChan(stageOdd), ac.rswap * 2);
+			// set color
+			SetRasColor(order.getColorChan(stageOdd), ac.rswap * 2);
 
-		// combine inputs
-		if (cc.bias != 3)
-			DrawColorRegular(cc);
-		else
-			DrawColorCompare(cc);
+			// combine inputs
+			if (cc.bias != 3)
+				DrawColorRegular(cc);
+			else
+				DrawColorCompare(cc);
 
-		if (cc.clamp)
-		{
-			Reg[cc.dest][RED_C] = Clamp255(Reg[cc.dest][RED_C]);
-			Reg[cc.dest][GRN_C] = Clamp255(Reg[cc.dest][GRN_C]);
-			Reg[cc.dest][BLU_C] = Clamp255(Reg[cc.dest][BLU_C]);
-		}
-		else
-		{
-			Reg[cc.dest][RED_C] = Clamp1024(Reg[cc.dest][RED_C]);
-			Reg[cc.dest][GRN_C] = Clamp1024(Reg[cc.dest][GRN_C]);
-			Reg[cc.dest][BLU_C] = Clamp1024(Reg[cc.dest][BLU_C]);
-		}
+			if (cc.clamp)
+			{
+				Reg[cc.dest][RED_C] = Clamp255(Reg[cc.dest][RED_C]);
+				Reg[cc.dest][GRN_C] = Clamp255(Reg[cc.dest][GRN_C]);
+				Reg[cc.dest][BLU_C] = Clamp255(Reg[cc.dest][BLU_C]);
+			}
+			else
+			{
+				Reg[cc.dest][RED_C] = Clamp1024(Reg[cc.dest][RED_C]);
+				Reg[cc.dest][GRN_C] = Clamp1024(Reg[cc.dest][GRN_C]);
+				Reg[cc.dest][BLU_C] = Clamp1024(Reg[cc.dest][BLU_C]);
+			}
 
-		if (ac.bias != 3)
-			DrawAlphaRegular(ac);
-		else
-			DrawAlphaCompare(ac);
+			if (ac.bias != 3)
+				DrawAlphaRegular(ac);
+			else
+				DrawAlphaCompare(ac);
 
-		if (ac.clamp)
-			Reg[ac.dest][ALP_C] = Clamp255(Reg[ac.dest][ALP_C]);
-		else
-			Reg[ac.dest][ALP_C] = Clamp1024(Reg[ac.dest][ALP_C]);
+			if (ac.clamp)
+				Reg[ac.dest][ALP_C] = Clamp255(Reg[ac.dest][ALP_C]);
+			else
+				Reg[ac.dest][ALP_C] = Clamp1024(Reg[ac.dest][ALP_C]);
 
 #if ALLOW_TEV_DUMPS
-		if (g_SWVideoConfig.bDumpTevStages)
-		{
-			u8 stage[4] = {(u8)Reg[0][RED_C], (u8)Reg[0][GRN_C], (u8)Reg[0][BLU_C], (u8)Reg[0][ALP_C]};
-			DebugUtil::DrawTempBuffer(stage, DIRECT + stageNum);
-		}
+			if (g_SWVideoConfig.bDumpTevStages)
+			{
+				u8 stage[4] = {(u8)Reg[0][RED_C], (u8)Reg[0][GRN_C], (u8)Reg[0][BLU_C], (u8)Reg[0][ALP_C]};
+				DebugUtil::DrawTempBuffer(stage, DIRECT + stageNum);
+			}
 #endif
+		}
 	}
 
 	// convert to 8 bits per component
@@ -809,12 +834,12 @@ void Tev::Draw()
 	if (late_ztest && bpmem.zmode.testenable)
 	{
 		// TODO: Check against hw if these values get incremented even if depth testing is disabled
-		SWPixelEngine::pereg.IncZInputQuadCount(false);
+		PEState.zInputPixels[0]++;
 
 		if (!EfbInterface::ZCompare(Position[0], Position[1], Position[2]))
 			return;
 
-		SWPixelEngine::pereg.IncZOutputQuadCount(false);
+		PEState.zOutputPixels[0]++;
 	}
 
 #if ALLOW_TEV_DUMPS
@@ -837,10 +862,18 @@ void Tev::Draw()
 	}
 #endif
 
-	INCSTAT(swstats.thisFrame.tevPixelsOut);
-	SWPixelEngine::pereg.IncBlendInputQuadCount();
+	PEState.tevPixelsOut++;
+	PEState.blendInputPixels++;
 
 	EfbInterface::BlendTev(Position[0], Position[1], output);
+
+	// branchless bounding box update
+	u16 x = Position[0];
+	u16 y = Position[1];
+	PEState.boxLeft = PEState.boxLeft>x?x:PEState.boxLeft;
+	PEState.boxRight = PEState.boxRight<x?x:PEState.boxRight;
+	PEState.boxTop = PEState.boxTop>y?y:PEState.boxTop;
+	PEState.boxBottom = PEState.boxBottom<y?y:PEState.boxBottom;
 }
 
 void Tev::SetRegColor(int reg, int comp, bool konst, s16 color)
@@ -851,13 +884,45 @@ void Tev::SetRegColor(int reg, int comp, bool konst, s16 color)
 	}
 	else
 	{
-		Reg[reg][comp] = color;
+		BPReg[reg][comp] = color;
 	}
 }
 
+void Tev::CopyRegColors(const Tev &tev)
+{
+	memcpy(BPReg, tev.BPReg, sizeof(BPReg));
+	memcpy(KonstantColors, tev.KonstantColors, sizeof(KonstantColors));
+}
+
+void Tev::FlushPixelEngineState()
+{
+	SWPixelEngine::PEReg &pereg = SWPixelEngine::pereg;
+
+	pereg.AddZInputPixels(true, PEState.zInputPixels[1]);
+	pereg.AddZInputPixels(false, PEState.zInputPixels[0]);
+	pereg.AddZOutputPixels(true, PEState.zOutputPixels[1]);
+	pereg.AddZOutputPixels(false, PEState.zOutputPixels[0]);
+	pereg.AddBlendInputPixels(PEState.blendInputPixels);
+
+	if (PEState.boxLeft <= PEState.boxRight)
+	{
+		pereg.boxLeft = std::min(pereg.boxLeft, PEState.boxLeft);
+		pereg.boxRight = std::max(pereg.boxRight, PEState.boxRight);
+		pereg.boxTop = std::min(pereg.boxTop, PEState.boxTop);
+		pereg.boxBottom = std::max(pereg.boxBottom, PEState.boxBottom);
+	}
+
+	ADDSTAT(swstats.thisFrame.rasterizedPixels, PEState.rasterizedPixels);
+	ADDSTAT(swstats.thisFrame.tevPixelsIn, PEState.tevPixelsIn);
+	ADDSTAT(swstats.thisFrame.tevPixelsOut, PEState.tevPixelsOut);
+
+	memset(&PEState, 0, sizeof(PEState));
+	PEState.boxLeft = PEState.boxTop = 0xffff;
+}
+
 void Tev::DoState(PointerWrap &p)
 {
-	p.DoArray(Reg, sizeof(Reg));
+	p.DoArray(BPReg, sizeof(BPReg));
 
 	p.DoArray(KonstantColors, sizeof(KonstantColors));
 	p.DoArray(TexColor,4);
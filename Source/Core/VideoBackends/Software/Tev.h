@@ -7,8 +7,12 @@
 #include "BPMemLoader.h"
 #include "ChunkFile.h"
 
+namespace TevJit { class Compiler; }
+
 class Tev
 {
+	friend class TevJit::Compiler;
+
 	struct InputRegType
 	{
 		unsigned a : 8;
@@ -25,6 +29,8 @@ class Tev
 
 	// color order: ABGR
 	s16 Reg[4][4];
+	// Reg as loaded through BP, stage results only last for the pixel
+	s16 BPReg[4][4];
 	s16 KonstantColors[4][4];
 	s16 TexColor[4];
 	s16 RasColor[4];
@@ -66,6 +72,7 @@ class Tev
 	void DrawAlphaCompare(TevStageCombiner::AlphaCombiner &ac);
 
 	void Indirect(unsigned int stageNum, s32 s, s32 t);
+	void FetchStageTexture(unsigned int stageNum);
 
 public:
 	s32 Position[3];
@@ -76,11 +83,32 @@ public:
 	s32 TextureLod[16];
 	bool TextureLinear[16];
 
+	// Pixel engine counters and statistics updated while drawing. Each Tev
+	// collects its own so that several rasterizer threads can draw at once,
+	// FlushPixelEngineState() applies them to SWPixelEngine::pereg and swstats.
+	struct PixelEngineState
+	{
+		u32 zInputPixels[2]; // indexed by early_ztest
+		u32 zOutputPixels[2];
+		u32 blendInputPixels;
+		u16 boxLeft;
+		u16 boxRight;
+		u16 boxTop;
+		u16 boxBottom;
+		u32 rasterizedPixels;
+		u32 tevPixelsIn;
+		u32 tevPixelsOut;
+	};
+	PixelEngineState PEState;
+
 	void Init();
 
 	void Draw();
 
 	void SetRegColor(int reg, int comp, bool konst, s16 color);
+	void CopyRegColors(const Tev &tev);
+
+	void FlushPixelEngineState();
 
 	enum { ALP_C, BLU_C, GRN_C, RED_C };
 
@@ -0,0 +1,528 @@
+// Copyright 2013 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include "Common.h"
+#include "Hash.h"
+
+#include <map>
+
+#include "BPMemLoader.h"
+#include "SWVideoConfig.h"
+#include "Tev.h"
+#include "TevJit.h"
+
+#if defined(_M_X64) && !defined(_M_GENERIC)
+#include "x64ABI.h"
+#include "x64Emitter.h"
+#endif
+
+namespace TevJit
+{
+
+static TevProgram s_program = NULL;
+static bool s_dirty = true;
+
+#if defined(_M_X64) && !defined(_M_GENERIC)
+
+using namespace Gen;
+
+#define CODE_SIZE (1024 * 1024)
+
+// Everything in BP memory the compiled code depends on
+struct ProgramKey
+{
+	u32 numTevStages;
+	u32 colorCombiners[16];
+	u32 alphaCombiners[16];
+	u32 indirect[16];
+	u32 orders[8];
+	u32 ksel[8];
+};
+
+struct ProgramEntry
+{
+	ProgramKey key;
+	TevProgram program;
+};
+
+// The generated code keeps the Tev pointer in RBX and reads and writes the
+// TEV registers at fixed offsets from it. Offsets are taken from the input
+// lookup tables of the Tev the program is compiled for, they are the same for
+// every instance.
+class Compiler : public XCodeBlock
+{
+public:
+	TevProgram Compile(const Tev &tev);
+
+private:
+	const Tev *m_tev;
+
+	static void FetchStageTexture(Tev *tev, u32 stageNum);
+
+	OpArg TevMember(const void *ptr) const;
+
+	void LoadInputD(X64Reg reg, const s16 *input);
+	void LoadCompareValue(X64Reg reg, const s16 *const *bytes, int count);
+	void StoreClamped(const s16 *dest, bool clamp);
+
+	void WriteStageKonst(int kc, int ka);
+	void WriteRasColor(int colorChan, int swaptable);
+
+	void WriteRegular(const s16 *a, const s16 *b, const s16 *c, const s16 *d,
+		int bias, int shift, bool op, const s16 *dest, bool clamp);
+	void WriteCompareResult(const s16 *c, const s16 *d, bool equal, const s16 *dest, bool clamp);
+
+	void WriteColorRegular(const TevStageCombiner::ColorCombiner &cc);
+	void WriteColorCompare(const TevStageCombiner::ColorCombiner &cc);
+	void WriteAlphaRegular(const TevStageCombiner::AlphaCombiner &ac);
+	void WriteAlphaCompare(const TevStageCombiner::AlphaCombiner &ac);
+};
+
+static Compiler s_compiler;
+static std::map<u64, ProgramEntry> s_programs;
+
+void Compiler::FetchStageTexture(Tev *tev, u32 stageNum)
+{
+	tev->FetchStageTexture(stageNum);
+}
+
+OpArg Compiler::TevMember(const void *ptr) const
+{
+	return MDisp(RBX, (int)((const u8*)ptr - (const u8*)m_tev));
+}
+
+// d is an 11 bit signed input
+void Compiler::LoadInputD(X64Reg reg, const s16 *input)
+{
+	MOVSX(32, 16, reg, TevMember(input));
+	SHL(32, R(reg), Imm8(21));
+	SAR(32, R(reg), Imm8(21));
+}
+
+// Packs the low bytes of the inputs, most significant first
+void Compiler::LoadCompareValue(X64Reg reg, const s16 *const *bytes, int count)
+{
+	MOVZX(32, 8, reg, TevMember(bytes[0]));
+	for (int i = 1; i < count; i++)
+	{
+		SHL(32, R(reg), Imm8(8));
+		MOVZX(32, 8, EAX, TevMember(bytes[i]));
+		OR(32, R(reg), R(EAX));
+	}
+}
+
+// Stores EAX as s16 after clamping it like Clamp255() or Clamp1024()
+void Compiler::StoreClamped(const s16 *dest, bool clamp)
+{
+	MOVSX(32, 16, EAX, R(EAX));
+	MOV(32, R(ECX), Imm32(clamp ? 255 : 1023));
+	CMP(32, R(EAX), R(ECX));
+	CMOVcc(32, EAX, R(ECX), CC_G);
+	MOV(32, R(ECX), Imm32(clamp ? 0 : (u32)-1024));
+	CMP(32, R(EAX), R(ECX));
+	CMOVcc(32, EAX, R(ECX), CC_L);
+	MOV(16, TevMember(dest), R(EAX));
+}
+
+void Compiler::WriteStageKonst(int kc, int ka)
+{
+	static const int comps[4] = { Tev::RED_C, Tev::GRN_C, Tev::BLU_C, Tev::ALP_C };
+
+	for (int comp : comps)
+	{
+		int sel = (comp == Tev::ALP_C) ? ka : kc;
+
+		// selections 8 to 11 are reserved and have no table entries
+		if (sel >= 8 && sel < 12)
+		{
+			MOV(16, TevMember(&m_tev->StageKonst[comp]), Imm16(0));
+		}
+		else
+		{
+			MOVZX(32, 16, EAX, TevMember(m_tev->m_KonstLUT[sel][comp]));
+			MOV(16, TevMember(&m_tev->StageKonst[comp]), R(EAX));
+		}
+	}
+}
+
+void Compiler::WriteRasColor(int colorChan, int swaptable)
+{
+	const s16 *ras = m_tev->RasColor;
+
+	switch (colorChan)
+	{
+	case 0: // Color0
+	case 1: // Color1
+		{
+			const u8 *color = m_tev->Color[colorChan];
+			const u8 *sources[4];
+			sources[Tev::RED_C] = &color[bpmem.tevksel[swaptable].swap1];
+			sources[Tev::GRN_C] = &color[bpmem.tevksel[swaptable].swap2];
+			sources[Tev::BLU_C] = &color[bpmem.tevksel[swaptable + 1].swap1];
+			sources[Tev::ALP_C] = &color[bpmem.tevksel[swaptable + 1].swap2];
+
+			for (int i = 0; i < 4; i++)
+			{
+				MOVZX(32, 8, EAX, TevMember(sources[i]));
+				MOV(16, TevMember(&ras[i]), R(EAX));
+			}
+		}
+		break;
+	case 5: // alpha bump
+	case 6: // alpha bump normalized
+		MOVZX(32, 8, EAX, TevMember(&m_tev->AlphaBump));
+		if (colorChan == 6)
+		{
+			MOV(32, R(ECX), R(EAX));
+			SHR(32, R(ECX), Imm8(5));
+			OR(32, R(EAX), R(ECX));
+		}
+		for (int i = 0; i < 4; i++)
+			MOV(16, TevMember(&ras[i]), R(EAX));
+		break;
+	default: // zero
+		for (int i = 0; i < 4; i++)
+			MOV(16, TevMember(&ras[i]), Imm16(0));
+		break;
+	}
+}
+
+void Compiler::WriteRegular(const s16 *a, const s16 *b, const s16 *c, const s16 *d,
+	int bias, int shift, bool op, const s16 *dest, bool clamp)
+{
+	MOVZX(32, 8, EAX, TevMember(a));
+	MOVZX(32, 8, ECX, TevMember(b));
+	MOVZX(32, 8, EDX, TevMember(c));
+
+	// c = c + (c >> 7)
+	MOV(32, R(R8), R(EDX));
+	SHR(32, R(R8), Imm8(7));
+	ADD(32, R(EDX), R(R8));
+
+	// a * (256 - c) + b * c
+	MOV(32, R(R8), Imm32(256));
+	SUB(32, R(R8), R(EDX));
+	IMUL(32, EAX, R(R8));
+	IMUL(32, ECX, R(EDX));
+	ADD(32, R(EAX), R(ECX));
+
+	if (op)
+		NEG(32, R(EAX));
+	SAR(32, R(EAX), Imm8(8));
+
+	LoadInputD(ECX, d);
+	ADD(32, R(EAX), R(ECX));
+
+	if (m_tev->m_BiasLUT[bias])
+		ADD(32, R(EAX), Imm32((u32)(s32)m_tev->m_BiasLUT[bias]));
+	if (m_tev->m_ScaleLShiftLUT[shift])
+		SHL(32, R(EAX), Imm8(m_tev->m_ScaleLShiftLUT[shift]));
+	if (m_tev->m_ScaleRShiftLUT[shift])
+		SAR(32, R(EAX), Imm8(m_tev->m_ScaleRShiftLUT[shift]));
+
+	StoreClamped(dest, clamp);
+}
+
+// Expects the compared values in R9D and R10D
+void Compiler::WriteCompareResult(const s16 *c, const s16 *d, bool equal, const s16 *dest, bool clamp)
+{
+	MOVZX(32, 8, ECX, TevMember(c));
+	XOR(32, R(EDX), R(EDX));
+	CMP(32, R(R9), R(R10));
+	CMOVcc(32, EDX, R(ECX), equal ? CC_E : CC_A);
+
+	LoadInputD(EAX, d);
+	ADD(32, R(EAX), R(EDX));
+
+	StoreClamped(dest, clamp);
+}
+
+void Compiler::WriteColorRegular(const TevStageCombiner::ColorCombiner &cc)
+{
+	for (int i = 0; i < 3; i++)
+	{
+		WriteRegular(m_tev->m_ColorInputLUT[cc.a][i], m_tev->m_ColorInputLUT[cc.b][i],
+			m_tev->m_ColorInputLUT[cc.c][i], m_tev->m_ColorInputLUT[cc.d][i],
+			cc.bias, cc.shift, cc.op != 0, &m_tev->Reg[cc.dest][Tev::BLU_C + i], cc.clamp != 0);
+	}
+}
+
+void Compiler::WriteColorCompare(const TevStageCombiner::ColorCombiner &cc)
+{
+	int cmp = (cc.shift<<1)|cc.op|8; // comparemode stored here
+	bool equal = (cmp & 1) != 0;
+
+	s16 *const *a = m_tev->m_ColorInputLUT[cc.a];
+	s16 *const *b = m_tev->m_ColorInputLUT[cc.b];
+
+	// The packed values use the same (partially odd) component
+	// selection as Tev::DrawColorCompare()
+	switch (cmp)
+	{
+	case TEVCMP_R8_GT:
+	case TEVCMP_R8_EQ:
+		{
+			const s16 *va[1] = { a[Tev::RED_INP] };
+			const s16 *vb[1] = { b[Tev::RED_INP] };
+			LoadCompareValue(R9, va, 1);
+			LoadCompareValue(R10, vb, 1);
+		}
+		break;
+	case TEVCMP_GR16_GT:
+		{
+			const s16 *va[2] = { a[Tev::GRN_INP], a[Tev::RED_INP] };
+			const s16 *vb[2] = { b[Tev::GRN_INP], b[Tev::RED_INP] };
+			LoadCompareValue(R9, va, 2);
+			LoadCompareValue(R10, vb, 2);
+		}
+		break;
+	case TEVCMP_GR16_EQ:
+		{
+			const s16 *va[2] = { a[Tev::GRN_C], a[Tev::RED_INP] };
+			const s16 *vb[2] = { b[Tev::GRN_C], b[Tev::RED_INP] };
+			LoadCompareValue(R9, va, 2);
+			LoadCompareValue(R10, vb, 2);
+		}
+		break;
+	case TEVCMP_BGR24_GT:
+	case TEVCMP_BGR24_EQ:
+		{
+			const s16 *va[3] = { a[Tev::BLU_C], a[Tev::GRN_C], a[Tev::RED_INP] };
+			const s16 *vb[3] = { b[Tev::BLU_C], b[Tev::GRN_C], b[Tev::RED_INP] };
+			LoadCompareValue(R9, va, 3);
+			LoadCompareValue(R10, vb, 3);
+		}
+		break;
+	}
+
+	for (int i = 0; i < 3; i++)
+	{
+		if (cmp == TEVCMP_RGB8_GT || cmp == TEVCMP_RGB8_EQ)
+		{
+			MOVZX(32, 8, R9, TevMember(a[i]));
+			MOVZX(32, 8, R10, TevMember(b[i]));
+		}
+
+		WriteCompareResult(m_tev->m_ColorInputLUT[cc.c][i], m_tev->m_ColorInputLUT[cc.d][i],
+			equal, &m_tev->Reg[cc.dest][Tev::BLU_C + i], cc.clamp != 0);
+	}
+}
+
+void Compiler::WriteAlphaRegular(const TevStageCombiner::AlphaCombiner &ac)
+{
+	WriteRegular(&m_tev->m_AlphaInputLUT[ac.a][Tev::ALP_C], &m_tev->m_AlphaInputLUT[ac.b][Tev::ALP_C],
+		&m_tev->m_AlphaInputLUT[ac.c][Tev::ALP_C], &m_tev->m_AlphaInputLUT[ac.d][Tev::ALP_C],
+		ac.bias, ac.shift, ac.op != 0, &m_tev->Reg[ac.dest][Tev::ALP_C], ac.clamp != 0);
+}
+
+void Compiler::WriteAlphaCompare(const TevStageCombiner::AlphaCombiner &ac)
+{
+	int cmp = (ac.shift<<1)|ac.op|8; // comparemode stored here
+	bool equal = (cmp & 1) != 0;
+
+	const s16 *a = m_tev->m_AlphaInputLUT[ac.a];
+	const s16 *b = m_tev->m_AlphaInputLUT[ac.b];
+
+	switch (cmp)
+	{
+	case TEVCMP_R8_GT:
+	case TEVCMP_R8_EQ:
+		{
+			const s16 *va[1] = { &a[Tev::RED_C] };
+			const s16 *vb[1] = { &b[Tev::RED_C] };
+			LoadCompareValue(R9, va, 1);
+			LoadCompareValue(R10, vb, 1);
+		}
+		break;
+	case TEVCMP_GR16_GT:
+	case TEVCMP_GR16_EQ:
+		{
+			const s16 *va[2] = { &a[Tev::GRN_C], &a[Tev::RED_C] };
+			const s16 *vb[2] = { &b[Tev::GRN_C], &b[Tev::RED_C] };
+			LoadCompareValue(R9, va, 2);
+			LoadCompareValue(R10, vb, 2);
+		}
+		break;
+	case TEVCMP_BGR24_GT:
+	case TEVCMP_BGR24_EQ:
+		{
+			const s16 *va[3] = { &a[Tev::BLU_C], &a[Tev::GRN_C], &a[Tev::RED_C] };
+			const s16 *vb[3] = { &b[Tev::BLU_C], &b[Tev::GRN_C], &b[Tev::RED_C] };
+			LoadCompareValue(R9, va, 3);
+			LoadCompareValue(R10, vb, 3);
+		}
+		break;
+	default: // TEVCMP_A8_GT, TEVCMP_A8_EQ
+		{
+			const s16 *va[1] = { &a[Tev::ALP_C] };
+			const s16 *vb[1] = { &b[Tev::ALP_C] };
+			LoadCompareValue(R9, va, 1);
+			LoadCompareValue(R10, vb, 1);
+		}
+		break;
+	}
+
+	WriteCompareResult(&m_tev->m_AlphaInputLUT[ac.c][Tev::ALP_C], &m_tev->m_AlphaInputLUT[ac.d][Tev::ALP_C],
+		equal, &m_tev->Reg[ac.dest][Tev::ALP_C], ac.clamp != 0);
+}
+
+// Tev::FetchStageTexture() computes the indirect texture coordinate, the alpha
+// bump value and samples the texture. It can be skipped when none of these
+// are used by this stage or by the next one (fb_addprev).
+static bool NeedsStageTexture(u32 stageNum, u32 numStages)
+{
+	int stageOdd = stageNum & 1;
+	TwoTevStageOrders &order = bpmem.tevorders[stageNum >> 1];
+
+	if (order.getEnable(stageOdd) || bpmem.tevind[stageNum].hex != 0)
+		return true;
+
+	int colorChan = order.getColorChan(stageOdd);
+	if (colorChan == 5 || colorChan == 6)
+		return true;
+
+	// the first stage adds to the coordinate of the last stage of the previous pixel
+	return bpmem.tevind[(stageNum + 1) % numStages].fb_addprev != 0;
+}
+
+TevProgram Compiler::Compile(const Tev &tev)
+{
+	m_tev = &tev;
+	TevProgram program = (TevProgram)GetCodePtr();
+
+	ABI_PushRegistersAndAdjustStack(1 << RBX, true);
+	MOV(64, R(RBX), R(ABI_PARAM1));
+
+	const u32 numStages = bpmem.genMode.numtevstages + 1;
+	for (u32 stageNum = 0; stageNum < numStages; stageNum++)
+	{
+		int stageOdd = stageNum & 1;
+		TwoTevStageOrders &order = bpmem.tevorders[stageNum >> 1];
+		TevKSel &kSel = bpmem.tevksel[stageNum >> 1];
+		TevStageCombiner::ColorCombiner &cc = bpmem.combiners[stageNum].colorC;
+		TevStageCombiner::AlphaCombiner &ac = bpmem.combiners[stageNum].alphaC;
+
+		if (NeedsStageTexture(stageNum, numStages))
+		{
+			MOV(64, R(ABI_PARAM1), R(RBX));
+			MOV(32, R(ABI_PARAM2), Imm32(stageNum));
+			ABI_CallFunction((void*)&Compiler::FetchStageTexture);
+		}
+
+		// konst and rasterized color are only materialized when this stage reads them
+		const u32 colorInputs[4] = { cc.a, cc.b, cc.c, cc.d };
+		const u32 alphaInputs[4] = { ac.a, ac.b, ac.c, ac.d };
+		bool usesKonst = false;
+		bool usesRas = false;
+		for (int i = 0; i < 4; i++)
+		{
+			usesKonst |= colorInputs[i] == 14 || alphaInputs[i] == 6;
+			usesRas |= colorInputs[i] == 10 || colorInputs[i] == 11 || alphaInputs[i] == 5;
+		}
+
+		if (usesKonst)
+			WriteStageKonst(kSel.getKC(stageOdd), kSel.getKA(stageOdd));
+		if (usesRas)
+			WriteRasColor(order.getColorChan(stageOdd), ac.rswap * 2);
+
+		if (cc.bias != 3)
+			WriteColorRegular(cc);
+		else
+			WriteColorCompare(cc);
+
+		if (ac.bias != 3)
+			WriteAlphaRegular(ac);
+		else
+			WriteAlphaCompare(ac);
+	}
+
+	ABI_PopRegistersAndAdjustStack(1 << RBX, true);
+	RET();
+
+	return program;
+}
+
+void Init()
+{
+	s_compiler.AllocCodeSpace(CODE_SIZE);
+	s_program = NULL;
+	s_dirty = true;
+}
+
+void Shutdown()
+{
+	s_compiler.FreeCodeSpace();
+	s_programs.clear();
+	s_program = NULL;
+}
+
+void Update(const Tev &tev)
+{
+	// stage dumping is only implemented by the interpreter
+	if (g_SWVideoConfig.bDumpTevStages || g_SWVideoConfig.bDumpTevTextureFetches)
+	{
+		s_program = NULL;
+		s_dirty = true;
+		return;
+	}
+
+	if (!s_dirty)
+		return;
+	s_dirty = false;
+
+	ProgramKey key;
+	memset(&key, 0, sizeof(key));
+
+	key.numTevStages = bpmem.genMode.numtevstages + 1;
+	for (u32 i = 0; i < key.numTevStages; i++)
+	{
+		key.colorCombiners[i] = bpmem.combiners[i].colorC.hex;
+		key.alphaCombiners[i] = bpmem.combiners[i].alphaC.hex;
+		key.indirect[i] = bpmem.tevind[i].hex;
+	}
+	for (u32 i = 0; i < (key.numTevStages + 1) / 2; i++)
+		key.orders[i] = bpmem.tevorders[i].hex;
+	for (u32 i = 0; i < 8; i++)
+		key.ksel[i] = bpmem.tevksel[i].hex;
+
+	u64 hash = GetMurmurHash3((const u8*)&key, sizeof(key), 0);
+
+	auto iter = s_programs.find(hash);
+	if (iter != s_programs.end() && memcmp(&iter->second.key, &key, sizeof(key)) == 0)
+	{
+		s_program = iter->second.program;
+		return;
+	}
+
+	if (s_compiler.GetSpaceLeft() < 0x10000)
+	{
+		s_compiler.ClearCodeSpace();
+		s_programs.clear();
+	}
+
+	ProgramEntry &entry = s_programs[hash];
+	entry.key = key;
+	entry.program = s_compiler.Compile(tev);
+	s_program = entry.program;
+}
+
+#else
+
+void Init() {}
+void Shutdown() {}
+void Update(const Tev &tev) {}
+
+#endif
+
+void Invalidate()
+{
+	s_dirty = true;
+}
+
+TevProgram GetProgram()
+{
+	return s_program;
+}
+
+}
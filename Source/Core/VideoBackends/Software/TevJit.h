@@ -0,0 +1,29 @@
+// Copyright 2013 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "CommonTypes.h"
+
+class Tev;
+
+// Compiles the TEV stages of the current BP state to native code, so that
+// Tev::Draw() doesn't have to decode the combiner setup again for every pixel.
+namespace TevJit
+{
+	typedef void (*TevProgram)(Tev *tev);
+
+	void Init();
+	void Shutdown();
+
+	// Called for BP writes, the program is looked up again before the next triangle
+	void Invalidate();
+
+	// Selects or compiles the program for the current BP state.
+	// Only call this from the video thread while no triangles are being shaded.
+	void Update(const Tev &tev);
+
+	// NULL if the stages have to be interpreted
+	TevProgram GetProgram();
+}
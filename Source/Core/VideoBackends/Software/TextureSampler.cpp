@@ -5,16 +5,58 @@
 #include "TextureSampler.h"
 
 #include "BPMemLoader.h"
+#include "Hash.h"
 #include "TextureDecoder.h"
 #include "HW/Memmap.h"
 
 #include <cmath>
+#include <vector>
 
 #define ALLOW_MIPMAP 1
 
+// 1024x1024 down to 1x1
+#define MAX_CACHED_LEVELS 11
+
 namespace TextureSampler
 {
 
+// Decoded RGBA8 copy of the texture bound to a texmap. Entries are only
+// changed by UpdateCache() on the video thread and are read-only while
+// triangles are shaded.
+struct CacheKey
+{
+	u8 *imageSrc;
+	u8 *imageSrcOdd;
+	u32 texImage0; // format and size
+	u32 texTlut;
+	u32 tlutHash;
+	u32 numLevels;
+};
+
+struct CacheEntry
+{
+	CacheKey key;
+	bool hasData;
+	bool current; // key was checked against the current BP state
+	u32 levelOffset[MAX_CACHED_LEVELS];
+	std::vector<u32> texels;
+};
+
+static CacheEntry s_cache[8];
+static bool s_cacheDirty = true;
+
+struct TexelSource
+{
+	const u32 *decoded; // NULL if the texture has to be decoded on the fly
+	u8 *imageSrc;
+	u8 *imageSrcOdd;
+	int imageWidth;
+	int format;
+	int tlutAddress;
+	int tlutFormat;
+	bool rgba8Tmem;
+};
+
 inline void WrapCoord(int &coord, int wrapMode, int imageSize)
 {
 	switch (wrapMode)
@@ -38,6 +80,16 @@ inline void WrapCoord(int &coord, int wrapMode, int imageSize)
 	}
 }
 
+inline void GetTexel(const TexelSource &src, int s, int t, u8 *texel)
+{
+	if (src.decoded)
+		memcpy(texel, &src.decoded[t * (src.imageWidth + 1) + s], 4);
+	else if (src.rgba8Tmem)
+		TexDecoder_DecodeTexelRGBA8FromTmem(texel, src.imageSrc, src.imageSrcOdd, s, t, src.imageWidth);
+	else
+		TexDecoder_DecodeTexel(texel, src.imageSrc, s, t, src.imageWidth, src.format, src.tlutAddress, src.tlutFormat);
+}
+
 inline void SetTexel(u8 *inTexel, u32 *outTexel, u32 fract)
 {
 	outTexel[0] = inTexel[0] * fract;
@@ -98,6 +150,177 @@ void Sample(s32 s, s32 t, s32 lod, bool linear, u8 texmap, u8 *sample)
 	}
 }
 
+static u8 *GetImageSource(const FourTexUnits &texUnit, u8 subTexmap, u8 **imageSrcOdd)
+{
+	*imageSrcOdd = NULL;
+
+	if (texUnit.texImage1[subTexmap].image_type)
+	{
+		if (texUnit.texImage0[subTexmap].format == GX_TF_RGBA8)
+			*imageSrcOdd = &texMem[texUnit.texImage2[subTexmap].tmem_odd * TMEM_LINE_SIZE];
+		return &texMem[texUnit.texImage1[subTexmap].tmem_even * TMEM_LINE_SIZE];
+	}
+	else
+	{
+		u32 imageBase = texUnit.texImage3[subTexmap].image_base << 5;
+		return Memory::GetPointer(imageBase);
+	}
+}
+
+// offset of a mip level from the start of the image
+static u32 GetMipOffset(const TexImage0 &ti0, int mip)
+{
+	int mipWidth = ti0.width + 1;
+	int mipHeight = ti0.height + 1;
+
+	int fmtWidth = TexDecoder_GetBlockWidthInTexels(ti0.format);
+	int fmtHeight = TexDecoder_GetBlockHeightInTexels(ti0.format);
+	int fmtDepth = TexDecoder_GetTexelSizeInNibbles(ti0.format);
+
+	u32 offset = 0;
+	while (mip)
+	{
+		mipWidth = max(mipWidth, fmtWidth);
+		mipHeight = max(mipHeight, fmtHeight);
+		offset += (mipWidth * mipHeight * fmtDepth) >> 1;
+
+		mipWidth >>= 1;
+		mipHeight >>= 1;
+		mip--;
+	}
+
+	return offset;
+}
+
+static u32 GetTlutSize(int format)
+{
+	switch (format)
+	{
+	case GX_TF_C4:    return 16 * 2;
+	case GX_TF_C8:    return 256 * 2;
+	case GX_TF_C14X2: return 16384 * 2;
+	default:          return 0;
+	}
+}
+
+static void UpdateCacheEntry(u8 texmap)
+{
+	CacheEntry &entry = s_cache[texmap];
+	if (entry.current)
+		return;
+	entry.current = true;
+
+	FourTexUnits &texUnit = bpmem.tex[(texmap >> 2) & 1];
+	u8 subTexmap = texmap & 3;
+
+	TexMode0 &tm0 = texUnit.texMode0[subTexmap];
+	TexMode1 &tm1 = texUnit.texMode1[subTexmap];
+	TexImage0 &ti0 = texUnit.texImage0[subTexmap];
+	TexTLUT &texTlut = texUnit.texTlut[subTexmap];
+
+	CacheKey key;
+	memset(&key, 0, sizeof(key));
+	key.imageSrc = GetImageSource(texUnit, subTexmap, &key.imageSrcOdd);
+	key.texImage0 = ti0.hex;
+	key.texTlut = texTlut.hex;
+
+	u32 tlutAddress = texTlut.tmem_offset << 9;
+	u32 tlutSize = GetTlutSize(ti0.format);
+	if (tlutSize)
+		key.tlutHash = GetMurmurHash3(texMem + tlutAddress, min(tlutSize, (u32)TMEM_SIZE - tlutAddress), 0);
+
+	// levels Sample() can reach with the current lod range
+	key.numLevels = 1;
+	if (tm0.min_filter & 3)
+		key.numLevels = min((u32)((tm1.max_lod + 15) >> 4) + 1, (u32)MAX_CACHED_LEVELS);
+
+	if (entry.hasData && memcmp(&entry.key, &key, sizeof(key)) == 0)
+		return;
+
+	entry.key = key;
+	entry.hasData = false;
+
+	if (!key.imageSrc)
+		return;
+
+	bool rgba8Tmem = ti0.format == GX_TF_RGBA8 && texUnit.texImage1[subTexmap].image_type;
+
+	u32 size = 0;
+	for (u32 mip = 0; mip < key.numLevels; mip++)
+	{
+		entry.levelOffset[mip] = size;
+		size += ((ti0.width >> mip) + 1) * ((ti0.height >> mip) + 1);
+	}
+	entry.texels.resize(size);
+
+	for (u32 mip = 0; mip < key.numLevels; mip++)
+	{
+		u8 *imageSrc = key.imageSrc + GetMipOffset(ti0, mip);
+		int imageWidth = ti0.width >> mip;
+		int imageHeight = ti0.height >> mip;
+		u32 *dst = &entry.texels[entry.levelOffset[mip]];
+
+		for (int t = 0; t <= imageHeight; t++)
+		{
+			for (int s = 0; s <= imageWidth; s++)
+			{
+				if (rgba8Tmem)
+					TexDecoder_DecodeTexelRGBA8FromTmem((u8*)dst, imageSrc, key.imageSrcOdd, s, t, imageWidth);
+				else
+					TexDecoder_DecodeTexel((u8*)dst, imageSrc, s, t, imageWidth, ti0.format, tlutAddress, texTlut.tlut_format);
+				dst++;
+			}
+		}
+	}
+
+	entry.hasData = true;
+}
+
+void UpdateCache()
+{
+	if (!s_cacheDirty)
+		return;
+	s_cacheDirty = false;
+
+	for (unsigned int stageNum = 0; stageNum <= bpmem.genMode.numtevstages; stageNum++)
+	{
+		TwoTevStageOrders &order = bpmem.tevorders[stageNum >> 1];
+		if (order.getEnable(stageNum & 1))
+			UpdateCacheEntry(order.getTexMap(stageNum & 1));
+	}
+
+	for (unsigned int stageNum = 0; stageNum < bpmem.genMode.numindstages; stageNum++)
+		UpdateCacheEntry(bpmem.tevindref.getTexMap(stageNum));
+}
+
+void RecheckCache()
+{
+	for (CacheEntry &entry : s_cache)
+		entry.current = false;
+	s_cacheDirty = true;
+}
+
+void InvalidateCache()
+{
+	for (CacheEntry &entry : s_cache)
+	{
+		entry.current = false;
+		entry.hasData = false;
+	}
+	s_cacheDirty = true;
+}
+
+void ShutdownCache()
+{
+	for (CacheEntry &entry : s_cache)
+	{
+		std::vector<u32>().swap(entry.texels);
+		entry.current = false;
+		entry.hasData = false;
+	}
+	s_cacheDirty = true;
+}
+
 void SampleMip(s32 s, s32 t, s32 mip, bool linear, u8 texmap, u8 *sample)
 {
 	FourTexUnits& texUnit = bpmem.tex[(texmap >> 2) & 1];
@@ -107,53 +330,43 @@ void SampleMip(s32 s, s32 t, s32 mip, bool linear, u8 texmap, u8 *sample)
 	TexImage0& ti0 = texUnit.texImage0[subTexmap];
 	TexTLUT& texTlut = texUnit.texTlut[subTexmap];
 
-	u8 *imageSrc, *imageSrcOdd = NULL;
-	if (texUnit.texImage1[subTexmap].image_type)
+	int imageWidth = ti0.width;
+	int imageHeight = ti0.height;
+
+	TexelSource src;
+
+	// the reserved wrap mode leaves coordinates outside of the decoded image
+	const CacheEntry &entry = s_cache[texmap];
+	if (entry.current && entry.hasData && mip < (s32)entry.key.numLevels &&
+		tm0.wrap_s != 3 && tm0.wrap_t != 3)
 	{
-		imageSrc = &texMem[texUnit.texImage1[subTexmap].tmem_even * TMEM_LINE_SIZE];
-		if (ti0.format == GX_TF_RGBA8)
-			imageSrcOdd = &texMem[texUnit.texImage2[subTexmap].tmem_odd * TMEM_LINE_SIZE];
+		src.decoded = &entry.texels[entry.levelOffset[mip]];
 	}
 	else
 	{
-		u32 imageBase = texUnit.texImage3[subTexmap].image_base << 5;
-		imageSrc = Memory::GetPointer(imageBase);
+		src.decoded = NULL;
+		src.imageSrc = GetImageSource(texUnit, subTexmap, &src.imageSrcOdd);
+		src.format = ti0.format;
+		src.tlutAddress = texTlut.tmem_offset << 9;
+		src.tlutFormat = texTlut.tlut_format;
+		src.rgba8Tmem = ti0.format == GX_TF_RGBA8 && texUnit.texImage1[subTexmap].image_type;
+
+		// move texture pointer to mip location
+		if (mip)
+			src.imageSrc += GetMipOffset(ti0, mip);
 	}
 
-	int imageWidth = ti0.width;
-	int imageHeight = ti0.height;
-
-	int tlutAddress = texTlut.tmem_offset << 9;
-
 	// reduce sample location and texture size to mip level
-	// move texture pointer to mip location
 	if (mip)
 	{
-		int mipWidth = imageWidth + 1;
-		int mipHeight = imageHeight + 1;
-
-		int fmtWidth = TexDecoder_GetBlockWidthInTexels(ti0.format);
-		int fmtHeight = TexDecoder_GetBlockHeightInTexels(ti0.format);
-		int fmtDepth = TexDecoder_GetTexelSizeInNibbles(ti0.format);
-
 		imageWidth >>= mip;
 		imageHeight >>= mip;
 		s >>= mip;
 		t >>= mip;
-
-		while (mip)
-		{
-			mipWidth = max(mipWidth, fmtWidth);
-			mipHeight = max(mipHeight, fmtHeight);
-			u32 size = (mipWidth * mipHeight * fmtDepth) >> 1;
-
-			imageSrc += size;
-			mipWidth >>= 1;
-			mipHeight >>= 1;
-			mip--;
-		}
 	}
 
+	src.imageWidth = imageWidth;
+
 	if (linear)
 	{
 		// offset linear sampling
@@ -179,34 +392,17 @@ void SampleMip(s32 s, s32 t, s32 mip, bool linear, u8 texmap, u8 *sample)
 		WrapCoord(imageSPlus1, tm0.wrap_s, imageWidth);
 		WrapCoord(imageTPlus1, tm0.wrap_t, imageHeight);
 
-		if (!(ti0.format == GX_TF_RGBA8 && texUnit.texImage1[subTexmap].image_type))
-		{
-			TexDecoder_DecodeTexel(sampledTex, imageSrc, imageS, imageT, imageWidth, ti0.format, tlutAddress, texTlut.tlut_format);
-			SetTexel(sampledTex, texel, (128 - fractS) * (128 - fractT));
+		GetTexel(src, imageS, imageT, sampledTex);
+		SetTexel(sampledTex, texel, (128 - fractS) * (128 - fractT));
 
-			TexDecoder_DecodeTexel(sampledTex, imageSrc, imageSPlus1, imageT, imageWidth, ti0.format, tlutAddress, texTlut.tlut_format);
-			AddTexel(sampledTex, texel, (fractS) * (128 - fractT));
+		GetTexel(src, imageSPlus1, imageT, sampledTex);
+		AddTexel(sampledTex, texel, (fractS) * (128 - fractT));
 
-			TexDecoder_DecodeTexel(sampledTex, imageSrc, imageS, imageTPlus1, imageWidth, ti0.format, tlutAddress, texTlut.tlut_format);
-			AddTexel(sampledTex, texel, (128 - fractS) * (fractT));
+		GetTexel(src, imageS, imageTPlus1, sampledTex);
+		AddTexel(sampledTex, texel, (128 - fractS) * (fractT));
 
-			TexDecoder_DecodeTexel(sampledTex, imageSrc, imageSPlus1, imageTPlus1, imageWidth, ti0.format, tlutAddress, texTlut.tlut_format);
-			AddTexel(sampledTex, texel, (fractS) * (fractT));
-		}
-		else
-		{
-			TexDecoder_DecodeTexelRGBA8FromTmem(sampledTex, imageSrc, imageSrcOdd, imageS, imageT, imageWidth);
-			SetTexel(sampledTex, texel, (128 - fractS) * (128 - fractT));
-
-			TexDecoder_DecodeTexelRGBA8FromTmem(sampledTex, imageSrc, imageSrcOdd, imageSPlus1, imageT, imageWidth);
-			AddTexel(sampledTex, texel, (fractS) * (128 - fractT));
-
-			TexDecoder_DecodeTexelRGBA8FromTmem(sampledTex, imageSrc, imageSrcOdd, imageS, imageTPlus1, imageWidth);
-			AddTexel(sampledTex, texel, (128 - fractS) * (fractT));
-
-			TexDecoder_DecodeTexelRGBA8FromTmem(sampledTex, imageSrc, imageSrcOdd, imageSPlus1, imageTPlus1, imageWidth);
-			AddTexel(sampledTex, texel, (fractS) * (fractT));
-		}
+		GetTexel(src, imageSPlus1, imageTPlus1, sampledTex);
+		AddTexel(sampledTex, texel, (fractS) * (fractT));
 
 		sample[0] = (u8)(texel[0] >> 14);
 		sample[1] = (u8)(texel[1] >> 14);
@@ -223,10 +419,7 @@ void SampleMip(s32 s, s32 t, s32 mip, bool linear, u8 texmap, u8 *sample)
 		WrapCoord(imageS, tm0.wrap_s, imageWidth);
 		WrapCoord(imageT, tm0.wrap_t, imageHeight);
 
-		if (!(ti0.format == GX_TF_RGBA8 && texUnit.texImage1[subTexmap].image_type))
-			TexDecoder_DecodeTexel(sample, imageSrc, imageS, imageT, imageWidth, ti0.format, tlutAddress, texTlut.tlut_format);
-		else
-			TexDecoder_DecodeTexelRGBA8FromTmem(sample, imageSrc, imageSrcOdd, imageS, imageT, imageWidth);
+		GetTexel(src, imageS, imageT, sample);
 	}
 }
 
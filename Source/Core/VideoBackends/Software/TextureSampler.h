@@ -12,5 +12,18 @@ namespace TextureSampler
 
 	void SampleMip(s32 s, s32 t, s32 mip, bool linear, u8 texmap, u8 *sample);
 
+	// Decodes the textures used by the current BP state to RGBA8, sampling
+	// then reads the decoded texels instead of decoding them on every fetch.
+	// Must be called on the video thread while no triangles are being shaded.
+	void UpdateCache();
+
+	// Texture registers changed, entries are compared against them on the next update
+	void RecheckCache();
+
+	// TMEM or the texture data in memory may have changed
+	void InvalidateCache();
+
+	void ShutdownCache();
+
 	enum { RED_SMP, GRN_SMP, BLU_SMP, ALP_SMP };
 }
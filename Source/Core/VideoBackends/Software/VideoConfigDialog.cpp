@@ -71,6 +71,10 @@ VideoConfigDialog::VideoConfigDialog(wxWindow* parent, const std::string& title,
 
 	// xfb
 	szr_rendering->Add(new SettingCheckBox(page_general, wxT("Bypass XFB"), wxT(""), vconfig.bBypassXFB));
+
+	// rasterizer threads
+	szr_rendering->Add(new wxStaticText(page_general, -1, wxT("Rasterizer threads (0 = auto)")), 1, wxALIGN_CENTER_VERTICAL, 5);
+	szr_rendering->Add(new U32Setting(page_general, wxT(""), vconfig.rasterizerThreads, 0, 64), 1, 0, 0);
 	}
 
 	// - info
@@ -93,6 +97,7 @@ VideoConfigDialog::VideoConfigDialog(wxWindow* parent, const std::string& title,
 	szr_utility->Add(new SettingCheckBox(page_general, wxT("Dump Textures"), wxT(""), vconfig.bDumpTextures));
 	szr_utility->Add(new SettingCheckBox(page_general, wxT("Dump Objects"), wxT(""), vconfig.bDumpObjects));
 	szr_utility->Add(new SettingCheckBox(page_general, wxT("Dump Frames"), wxT(""), vconfig.bDumpFrames));
+	szr_utility->Add(new SettingCheckBox(page_general, wxT("Verify Rasterizer Threads"), wxT(""), vconfig.bVerifyRasterizerThreads));
 
 	// - debug only
 	wxStaticBoxSizer* const group_debug_only_utility = new wxStaticBoxSizer(wxHORIZONTAL, page_general, wxT("Debug Only"));
@@ -7,6 +7,7 @@
 #include "XFMemLoader.h"
 #include "CPMemLoader.h"
 #include "Clipper.h"
+#include "Rasterizer.h"
 #include "HW/Memmap.h"
 
 XFRegisters swxfregs;
@@ -48,6 +49,22 @@ void XFWritten(u32 transferSize, u32 baseAddress)
 	}
 }
 
+// Shading only reads the viewport width (for range fog) and the texture
+// projection flags, everything else was used up when the triangles were set up
+static bool ChangesShadingState(u32 size, u32 baseAddress, const u32 *pData)
+{
+	const u32 *regs = (const u32*)&swxfregs;
+	for (u32 i = 0; i < size; i++)
+	{
+		u32 address = baseAddress + i;
+		if (address != 0x101a && (address < 0x1040 || address > 0x1047))
+			continue;
+		if (regs[address] != pData[i])
+			return true;
+	}
+	return false;
+}
+
 void SWLoadXFReg(u32 transferSize, u32 baseAddress, u32 *pData)
 {
 	u32 size = transferSize;
@@ -65,6 +82,8 @@ void SWLoadXFReg(u32 transferSize, u32 baseAddress, u32 *pData)
 
 	if (size > 0)
 	{
+		if (ChangesShadingState(size, baseAddress, pData))
+			Rasterizer::Flush();
 		memcpy_gc( &((u32*)&swxfregs)[baseAddress], pData, size * 4);
 		XFWritten(transferSize, baseAddress);
 	}
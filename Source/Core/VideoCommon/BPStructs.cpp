@@ -8,6 +8,7 @@
 #include "Statistics.h"
 #include "RenderBase.h"
 #include "VideoCommon.h"
+#include "PixelShaderGen.h"
 #include "PixelShaderManager.h"
 #include "PixelEngine.h"
 #include "BPFunctions.h"
@@ -35,6 +36,30 @@ void BPInit()
 {
 	memset(&bpmem, 0, sizeof(bpmem));
 	bpmem.bpMask = 0xFFFFFF;
+	SetPixelShaderUidDirty();
+}
+
+// Whether the register is one GetPixelShaderUid reads.  The TEV, fog and
+// indirect constants only end up in uniforms and are left out.
+static bool AffectsPixelShaderUid(u32 address)
+{
+	switch (address)
+	{
+	case BPMEM_GENMODE:
+	case BPMEM_IREF:
+	case BPMEM_ZMODE:
+	case BPMEM_ZCOMPARE:
+	case BPMEM_FOGRANGE:
+	case BPMEM_FOGPARAM3:
+	case BPMEM_ALPHACOMPARE:
+	case BPMEM_ZTEX2:
+		return true;
+	default:
+		return (address >= BPMEM_IND_CMD && address < BPMEM_IND_CMD + 16) ||
+		       (address >= BPMEM_TREF && address < BPMEM_TREF + 8) ||
+		       (address >= BPMEM_TEV_COLOR_ENV && address < BPMEM_TEV_COLOR_ENV + 32) ||
+		       (address >= BPMEM_TEV_KSEL && address < BPMEM_TEV_KSEL + 8);
+	}
 }
 
 void RenderToXFB(const BPCmd &bp, const EFBRectangle &rc, float yScale, float xfbLines, u32 xfbAddr, const u32 dstWidth, const u32 dstHeight, float gamma)
@@ -85,6 +110,9 @@ void BPWritten(const BPCmd& bp)
 
 	((u32*)&bpmem)[bp.address] = bp.newvalue;
 
+	if (AffectsPixelShaderUid(bp.address))
+		SetPixelShaderUidDirty();
+
 	switch (bp.address)
 	{
 	case BPMEM_GENMODE: // Set the Generation Mode
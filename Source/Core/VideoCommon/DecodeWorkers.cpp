@@ -0,0 +1,129 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "DecodeWorkers.h"
+#include "Thread.h"
+
+namespace DecodeWorkers
+{
+
+struct Job
+{
+	std::function<void()> func;
+	Batch* batch;
+};
+
+// s_mutex guards the queue and every batch's m_pending.
+static std::mutex s_mutex;
+static std::condition_variable s_job_queued;
+static std::condition_variable s_job_done;
+static std::deque<Job> s_jobs;
+static std::vector<std::thread> s_threads;
+static bool s_quit;
+
+// Called with s_mutex held.
+void JobDone(Batch* batch)
+{
+	if (--batch->m_pending == 0)
+		s_job_done.notify_all();
+}
+
+static void WorkerThread()
+{
+	Common::SetCurrentThreadName("Texture decoder");
+
+	std::unique_lock<std::mutex> lk(s_mutex);
+	while (true)
+	{
+		while (!s_quit && s_jobs.empty())
+			s_job_queued.wait(lk);
+		if (s_quit)
+			break;
+
+		Job job = std::move(s_jobs.front());
+		s_jobs.pop_front();
+
+		lk.unlock();
+		job.func();
+		lk.lock();
+
+		JobDone(job.batch);
+	}
+}
+
+void Batch::Add(const std::function<void()>& job)
+{
+	if (s_threads.empty())
+	{
+		job();
+		return;
+	}
+
+	std::lock_guard<std::mutex> lk(s_mutex);
+	Job queued = { job, this };
+	s_jobs.push_back(std::move(queued));
+	m_pending++;
+	s_job_queued.notify_one();
+}
+
+void Batch::Wait()
+{
+	std::unique_lock<std::mutex> lk(s_mutex);
+	while (m_pending)
+	{
+		auto iter = s_jobs.begin();
+		while (iter != s_jobs.end() && iter->batch != this)
+			++iter;
+
+		if (iter == s_jobs.end())
+		{
+			// All of them are running on the workers already.
+			s_job_done.wait(lk);
+			continue;
+		}
+
+		std::function<void()> func = std::move(iter->func);
+		s_jobs.erase(iter);
+
+		lk.unlock();
+		func();
+		lk.lock();
+
+		JobDone(this);
+	}
+}
+
+void Init(int num_threads)
+{
+	s_quit = false;
+	for (int i = 0; i < num_threads; i++)
+		s_threads.push_back(std::thread(WorkerThread));
+}
+
+void Shutdown()
+{
+	{
+		std::lock_guard<std::mutex> lk(s_mutex);
+		s_quit = true;
+		s_job_queued.notify_all();
+	}
+
+	for (auto& thread : s_threads)
+		thread.join();
+	s_threads.clear();
+	s_jobs.clear();
+}
+
+int GetNumThreads()
+{
+	return (int)s_threads.size();
+}
+
+}
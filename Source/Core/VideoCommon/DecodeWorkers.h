@@ -0,0 +1,40 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <functional>
+
+#include "Common.h"
+
+// A persistent pool of threads which texture decoding is split over.
+// Jobs are added to a Batch, and the batch is waited for before their results
+// are used.  While waiting, the caller runs the batch's jobs no worker has
+// started yet, so a batch always finishes even when every worker is busy.
+namespace DecodeWorkers
+{
+
+class Batch : NonCopyable
+{
+public:
+	Batch() : m_pending(0) {}
+	~Batch() { Wait(); }
+
+	// Runs job on a worker, or right away if there are no workers.
+	void Add(const std::function<void()>& job);
+	void Wait();
+
+private:
+	friend void JobDone(Batch* batch);
+
+	int m_pending;
+};
+
+// With num_threads == 0 no workers are started and Batch::Add runs the job itself.
+void Init(int num_threads);
+void Shutdown();
+
+int GetNumThreads();
+
+}
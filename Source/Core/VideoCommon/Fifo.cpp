@@ -15,6 +15,8 @@
 #include "Core.h"
 #include "CoreTiming.h"
 
+#include <algorithm>
+
 volatile bool g_bSkipCurrentFrame = false;
 extern u8* g_pVideoData;
 
@@ -26,6 +28,8 @@ static std::mutex m_csHWVidOccupied;
 // STATE_TO_SAVE
 static u8 *videoBuffer;
 static int size = 0;
+// Set while OpcodeDecoder_Run() reads straight out of emulated RAM instead of videoBuffer
+static u8 *s_video_data_end = NULL;
 }  // namespace
 
 void Fifo_DoState(PointerWrap &p)
@@ -76,6 +80,8 @@ u8* GetVideoBufferStartPtr()
 
 u8* GetVideoBufferEndPtr()
 {
+	if (s_video_data_end)
+		return s_video_data_end;
 	return &videoBuffer[size];
 }
 
@@ -103,7 +109,7 @@ void EmulatorState(bool running)
 }
 
 
-// Description: RunGpuLoop() sends data through this function.
+// Description: Stages FIFO data in videoBuffer for commands that cannot be decoded in place.
 void ReadDataFromFifo(u8* _uData, u32 len)
 {
 	if (size + len >= FIFO_SIZE)
@@ -128,6 +134,68 @@ void ResetVideoBuffer()
 	size = 0;
 }
 
+// Decodes len bytes of FIFO data located at _uData in emulated RAM.
+// As long as videoBuffer holds no leftovers, commands are decoded in place and
+// only a command straddling the end of the range (ring wrap, or data the CPU
+// has not written yet) gets staged into videoBuffer to be completed later.
+static u32 RunFifoData(u8* _uData, u32 len, bool skipped_frame)
+{
+	u32 cycles = 0;
+
+	// Finish the staged command first, feeding it one cache line at a time so
+	// that we stop copying as soon as it is complete.
+	while (len && g_pVideoData != GetVideoBufferEndPtr())
+	{
+		u32 chunk = std::min<u32>(len, 32);
+		ReadDataFromFifo(_uData, chunk);
+		cycles += OpcodeDecoder_Run(skipped_frame);
+		_uData += chunk;
+		len -= chunk;
+	}
+
+	if (!len)
+		return cycles;
+
+	g_pVideoData = _uData;
+	s_video_data_end = _uData + len;
+	cycles += OpcodeDecoder_Run(skipped_frame);
+	u8 *remaining = g_pVideoData;
+	s_video_data_end = NULL;
+
+	ResetVideoBuffer();
+	if (remaining != _uData + len)
+		ReadDataFromFifo(remaining, (u32)(_uData + len - remaining));
+
+	return cycles;
+}
+
+// Returns how many bytes starting at CPReadPointer can be consumed in one go.
+// A batch never crosses the CPEnd/CPBase wrap or a FIFO breakpoint, so the
+// data is contiguous in RAM and AtBreakpoint() stays exact.
+static u32 GetFifoBatchSize(const SCPFifoStruct &fifo)
+{
+	u32 readPtr = fifo.CPReadPointer;
+	u32 distance = fifo.CPReadWriteDistance;
+
+	if (!Core::g_CoreStartupParameter.bBatchGPUFifo || Core::g_CoreStartupParameter.bSyncGPU ||
+	    readPtr >= fifo.CPEnd || distance < 32)
+		return 32;
+
+	u32 len = std::min<u32>(distance & ~31, fifo.CPEnd - readPtr + 32);
+	if (fifo.bFF_BPEnable && fifo.CPBreakpoint > readPtr && fifo.CPBreakpoint - readPtr < len)
+		len = fifo.CPBreakpoint - readPtr;
+
+	return std::min<u32>(len, FIFO_BATCH_SIZE);
+}
+
+static u32 AdvanceFifoReadPointer(const SCPFifoStruct &fifo, u32 readPtr, u32 len)
+{
+	if (readPtr + len - 32 == fifo.CPEnd)
+		return fifo.CPBase;
+	else
+		return readPtr + len;
+}
+
 
 // Description: Main FIFO update loop
 // Purpose: Keep the Core HW updated about the CPU-GPU distance
@@ -158,24 +226,20 @@ void RunGpuLoop()
 			{
 				u32 readPtr = fifo.CPReadPointer;
 				u8 *uData = Memory::GetPointer(readPtr);
+				u32 len = GetFifoBatchSize(fifo);
 
-				if (readPtr == fifo.CPEnd)
-					readPtr = fifo.CPBase;
-				else
-					readPtr += 32;
+				readPtr = AdvanceFifoReadPointer(fifo, readPtr, len);
 
-				_assert_msg_(COMMANDPROCESSOR, (s32)fifo.CPReadWriteDistance - 32 >= 0 ,
-					"Negative fifo.CPReadWriteDistance = %i in FIFO Loop !\nThat can produce instability in the game. Please report it.", fifo.CPReadWriteDistance - 32);
+				_assert_msg_(COMMANDPROCESSOR, (s32)fifo.CPReadWriteDistance - (s32)len >= 0 ,
+					"Negative fifo.CPReadWriteDistance = %i in FIFO Loop !\nThat can produce instability in the game. Please report it.", fifo.CPReadWriteDistance - len);
 
-				ReadDataFromFifo(uData, 32);
-
-				cyclesExecuted = OpcodeDecoder_Run(g_bSkipCurrentFrame);
+				cyclesExecuted = RunFifoData(uData, len, g_bSkipCurrentFrame);
 
 				if (Core::g_CoreStartupParameter.bSyncGPU && Common::AtomicLoad(CommandProcessor::VITicks) > cyclesExecuted)
 					Common::AtomicAdd(CommandProcessor::VITicks, -(s32)cyclesExecuted);
 
 				Common::AtomicStore(fifo.CPReadPointer, readPtr);
-				Common::AtomicAdd(fifo.CPReadWriteDistance, -32);
+				Common::AtomicAdd(fifo.CPReadWriteDistance, -(s32)len);
 				if((GetVideoBufferEndPtr() - g_pVideoData) == 0)
 					Common::AtomicStore(fifo.SafeCPReadPointer, fifo.CPReadPointer);
 			}
@@ -227,21 +291,17 @@ void RunGpu()
 	while (fifo.bFF_GPReadEnable && fifo.CPReadWriteDistance && !AtBreakpoint() )
 	{
 		u8 *uData = Memory::GetPointer(fifo.CPReadPointer);
+		u32 len = GetFifoBatchSize(fifo);
 
 		FPURoundMode::SaveSIMDState();
 		FPURoundMode::LoadDefaultSIMDState();
-		ReadDataFromFifo(uData, 32);
-		OpcodeDecoder_Run(g_bSkipCurrentFrame);
+		RunFifoData(uData, len, g_bSkipCurrentFrame);
 		FPURoundMode::LoadSIMDState();
 
 		//DEBUG_LOG(COMMANDPROCESSOR, "Fifo wraps to base");
 
-		if (fifo.CPReadPointer == fifo.CPEnd)
-			fifo.CPReadPointer = fifo.CPBase;
-		else
-			fifo.CPReadPointer += 32;
-
-		fifo.CPReadWriteDistance -= 32;
+		fifo.CPReadPointer = AdvanceFifoReadPointer(fifo, fifo.CPReadPointer, len);
+		fifo.CPReadWriteDistance -= len;
 	}
 	CommandProcessor::SetCpStatus();
 }
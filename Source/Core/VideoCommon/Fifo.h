@@ -10,6 +10,8 @@
 class PointerWrap;
 
 #define FIFO_SIZE (2*1024*1024)
+// Upper bound on how much of the CPU FIFO the GPU thread consumes per decoder pass
+#define FIFO_BATCH_SIZE (64*1024)
 
 extern volatile bool g_bSkipCurrentFrame;
 
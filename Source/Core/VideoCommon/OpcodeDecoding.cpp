@@ -35,6 +35,7 @@
 
 #include "VideoConfig.h"
 
+// Points either into the CPU FIFO in emulated RAM or into the staging buffer in Fifo.cpp
 u8* g_pVideoData = 0;
 bool g_bRecordFifoData = false;
 
@@ -1184,9 +1184,38 @@ static inline void WriteFog(T& out, pixel_shader_uid_data& uid_data)
 	out.Write("\tprev.rgb = lerp(prev.rgb, " I_FOG"[0].rgb, fog);\n");
 }
 
+// The last UID generated for each dstAlphaMode.  It's only regenerated after a
+// write to one of the registers it's built from, see SetPixelShaderUidDirty.
+struct CachedPixelShaderUid
+{
+	u32 epoch;
+	API_TYPE ApiType;
+	u32 components;
+	PixelShaderUid uid;
+};
+static CachedPixelShaderUid s_cached_uid[DSTALPHA_DUAL_SOURCE_BLEND + 1];
+static u32 s_uid_epoch = 1;
+
+void SetPixelShaderUidDirty()
+{
+	s_uid_epoch++;
+}
+
 void GetPixelShaderUid(PixelShaderUid& object, DSTALPHA_MODE dstAlphaMode, API_TYPE ApiType, u32 components)
 {
+	CachedPixelShaderUid& cached = s_cached_uid[dstAlphaMode];
+	if (cached.epoch == s_uid_epoch && cached.ApiType == ApiType && cached.components == components)
+	{
+		object = cached.uid;
+		return;
+	}
+
 	GeneratePixelShader<PixelShaderUid>(object, dstAlphaMode, ApiType, components);
+
+	cached.epoch = s_uid_epoch;
+	cached.ApiType = ApiType;
+	cached.components = components;
+	cached.uid = object;
 }
 
 void GeneratePixelShaderCode(PixelShaderCode& object, DSTALPHA_MODE dstAlphaMode, API_TYPE ApiType, u32 components)
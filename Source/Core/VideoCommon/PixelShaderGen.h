@@ -139,4 +139,8 @@ typedef ShaderConstantProfile PixelShaderConstantProfile; // TODO: Obsolete
 
 void GeneratePixelShaderCode(PixelShaderCode& object, DSTALPHA_MODE dstAlphaMode, API_TYPE ApiType, u32 components);
 void GetPixelShaderUid(PixelShaderUid& object, DSTALPHA_MODE dstAlphaMode, API_TYPE ApiType, u32 components);
+
+// Must be called when any state GetPixelShaderUid reads changes: the BP and XF
+// registers the UID is built from and the active video config.
+void SetPixelShaderUidDirty();
 void GetPixelShaderConstantProfile(PixelShaderConstantProfile& object, DSTALPHA_MODE dstAlphaMode, API_TYPE ApiType, u32 components);
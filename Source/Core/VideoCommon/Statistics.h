@@ -17,6 +17,8 @@ struct Statistics
 
 	int numTexturesCreated;
 	int numTexturesAlive;
+	int numTexturePoolHits;
+	int numTexturePoolMisses;
 
 	int numRenderTargetsCreated;
 	int numRenderTargetsAlive;
@@ -2,6 +2,11 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "CPUDetect.h"
 #include "MemoryUtil.h"
 
 #include "VideoConfig.h"
@@ -11,6 +16,7 @@
 #include "FileUtil.h"
 
 #include "TextureCacheBase.h"
+#include "DecodeWorkers.h"
 #include "Debugger.h"
 #include "ConfigManager.h"
 #include "HW/Memmap.h"
@@ -21,6 +27,7 @@ extern int frameCount;
 enum
 {
 	TEXTURE_KILL_THRESHOLD = 200,
+	TEXTURE_POOL_KILL_THRESHOLD = 3,
 };
 
 TextureCache *g_texture_cache;
@@ -29,6 +36,7 @@ GC_ALIGNED16(u8 *TextureCache::temp) = NULL;
 unsigned int TextureCache::temp_size;
 
 TextureCache::TexCache TextureCache::textures;
+TextureCache::TexPool TextureCache::texture_pool;
 
 TextureCache::BackupConfig TextureCache::backup_config;
 
@@ -51,6 +59,10 @@ TextureCache::TextureCache()
 
 	SetHash64Function(g_ActiveConfig.bHiresTextures || g_ActiveConfig.bDumpTextures);
 
+	// The GPU thread decodes too while it waits, and too many threads
+	// would slow down the rest of the emulator.
+	DecodeWorkers::Init(std::max(0, (cpu_info.num_cores + 2) / 3 - 1));
+
 	invalidate_texture_cache_requested = false;
 }
 
@@ -65,7 +77,7 @@ void TextureCache::Invalidate()
 		iter = textures.begin(),
 		tcend = textures.end();
 	for (; iter != tcend; ++iter)
-		delete iter->second;
+		FreeTexture(iter->second);
 
 	textures.clear();
 }
@@ -73,6 +85,8 @@ void TextureCache::Invalidate()
 TextureCache::~TextureCache()
 {
 	Invalidate();
+	ClearTexturePool();
+	DecodeWorkers::Shutdown();
 	if (temp)
 	{
 		FreeAlignedMemory(temp);
@@ -135,7 +149,7 @@ void TextureCache::Cleanup()
 			// EFB copies living on the host GPU are unrecoverable and thus shouldn't be deleted
 			&& ! iter->second->IsEfbCopy() )
 		{
-			delete iter->second;
+			FreeTexture(iter->second);
 			textures.erase(iter++);
 		}
 		else
@@ -143,6 +157,76 @@ void TextureCache::Cleanup()
 			++iter;
 		}
 	}
+
+	TexPool::iterator pool_iter = texture_pool.begin();
+	while (pool_iter != texture_pool.end())
+	{
+		if (frameCount > TEXTURE_POOL_KILL_THRESHOLD + pool_iter->second->frameCount)
+		{
+			delete pool_iter->second;
+			texture_pool.erase(pool_iter++);
+		}
+		else
+		{
+			++pool_iter;
+		}
+	}
+}
+
+TextureCache::TCacheEntryBase* TextureCache::AllocateTexture(unsigned int width, unsigned int height,
+	unsigned int expanded_width, unsigned int tex_levels, PC_TexFormat pcfmt)
+{
+	const TexPoolKey key = { width, height, tex_levels, pcfmt, false };
+
+	TexPool::iterator iter = texture_pool.find(key);
+	if (iter != texture_pool.end())
+	{
+		TCacheEntryBase* const entry = iter->second;
+		texture_pool.erase(iter);
+		INCSTAT(stats.numTexturePoolHits);
+
+		// CreateTexture loads level 0 as well
+		entry->Load(temp, width, height, expanded_width, 0);
+		return entry;
+	}
+
+	INCSTAT(stats.numTexturePoolMisses);
+	TCacheEntryBase* const entry = g_texture_cache->CreateTexture(width, height, expanded_width, tex_levels, pcfmt);
+	entry->pool_key = key;
+	return entry;
+}
+
+TextureCache::TCacheEntryBase* TextureCache::AllocateRenderTargetTexture(unsigned int scaled_tex_w, unsigned int scaled_tex_h)
+{
+	const TexPoolKey key = { scaled_tex_w, scaled_tex_h, 1, PC_TEX_FMT_NONE, true };
+
+	TexPool::iterator iter = texture_pool.find(key);
+	if (iter != texture_pool.end())
+	{
+		TCacheEntryBase* const entry = iter->second;
+		texture_pool.erase(iter);
+		INCSTAT(stats.numTexturePoolHits);
+		return entry;
+	}
+
+	INCSTAT(stats.numTexturePoolMisses);
+	TCacheEntryBase* const entry = g_texture_cache->CreateRenderTargetTexture(scaled_tex_w, scaled_tex_h);
+	entry->pool_key = key;
+	return entry;
+}
+
+void TextureCache::FreeTexture(TCacheEntryBase* entry)
+{
+	entry->frameCount = frameCount;
+	texture_pool.insert(TexPool::value_type(entry->pool_key, entry));
+}
+
+void TextureCache::ClearTexturePool()
+{
+	for (auto& pooled : texture_pool)
+		delete pooled.second;
+
+	texture_pool.clear();
 }
 
 void TextureCache::InvalidateRange(u32 start_address, u32 size)
@@ -155,7 +239,7 @@ void TextureCache::InvalidateRange(u32 start_address, u32 size)
 		const int rangePosition = iter->second->IntersectsMemoryRange(start_address, size);
 		if (0 == rangePosition)
 		{
-			delete iter->second;
+			FreeTexture(iter->second);
 			textures.erase(iter++);
 		}
 		else
@@ -215,7 +299,7 @@ void TextureCache::ClearRenderTargets()
 	{
 		if (iter->second->type == TCET_EC_VRAM)
 		{
-			delete iter->second;
+			FreeTexture(iter->second);
 			textures.erase(iter++);
 		}
 		else
@@ -370,8 +454,6 @@ TextureCache::TCacheEntryBase* TextureCache::Load(unsigned int const stage,
 	else
 		src_data = Memory::GetPointer(address);
 
-	// TODO: This doesn't hash GB tiles for preloaded RGBA8 textures (instead, it's hashing more data from the low tmem bank than it should)
-	tex_hash = GetHash64(src_data, texture_size, g_ActiveConfig.iSafeTextureCache_ColorSamples);
 	if (isPaletteTexture)
 	{
 		const u32 palette_size = TexDecoder_GetPaletteSize(texformat);
@@ -387,15 +469,40 @@ TextureCache::TCacheEntryBase* TextureCache::Load(unsigned int const stage,
 		//
 		// TODO: Because texID isn't always the same as the address now, CopyRenderTargetToTexture might be broken now
 		texID ^= ((u32)tlut_hash) ^(u32)(tlut_hash >> 32);
-		tex_hash ^= tlut_hash;
 	}
 
+	TCacheEntryBase *entry = textures[texID];
+
+	bool watched = false;
+	u64 watch_epoch = 0;
+	// Preloaded textures are read from TMEM, which the watch doesn't cover.
+	if (!from_tmem && entry && entry->watched && entry->type == TCET_NORMAL && address == entry->addr &&
+		texture_size == entry->size_in_bytes && !Memory::WrittenSince(address, texture_size, entry->watch_epoch))
+	{
+		// Nothing has written to the texture's RAM since it was hashed.
+		watched = true;
+		watch_epoch = entry->watch_epoch;
+		tex_hash = entry->data_hash;
+	}
+	else
+	{
+		// The watch has to be in place before hashing, so that any write racing with it is caught.
+		// Rewind turns on write watches as well, the texture cache only uses them when asked to.
+		if (!from_tmem && SConfig::GetInstance().m_LocalCoreStartupParameter.bTextureWriteWatch)
+			watched = Memory::WatchRange(address, texture_size, watch_epoch);
+
+		// TODO: This doesn't hash GB tiles for preloaded RGBA8 textures (instead, it's hashing more data from the low tmem bank than it should)
+		tex_hash = GetHash64(src_data, texture_size, g_ActiveConfig.iSafeTextureCache_ColorSamples);
+	}
+	const u64 data_hash = tex_hash;
+	if (isPaletteTexture)
+		tex_hash ^= tlut_hash;
+
 	// D3D doesn't like when the specified mipmap count would require more than one 1x1-sized LOD in the mipmap chain
 	// e.g. 64x64 with 7 LODs would have the mipmap chain 64x64,32x32,16x16,8x8,4x4,2x2,1x1,1x1, so we limit the mipmap count to 6 there
 	while (g_ActiveConfig.backend_info.bUseMinimalMipCount && max(expandedWidth, expandedHeight) >> maxlevel == 0)
 		--maxlevel;
 
-	TCacheEntryBase *entry = textures[texID];
 	if (entry)
 	{
 		// 1. Calculate reference hash:
@@ -418,6 +525,9 @@ TextureCache::TCacheEntryBase* TextureCache::Load(unsigned int const stage,
 		if (address == entry->addr && tex_hash == entry->hash && full_format == entry->format &&
 			entry->num_mipmaps > maxlevel && entry->native_width == nativeW && entry->native_height == nativeH)
 		{
+			entry->watched = watched;
+			entry->watch_epoch = watch_epoch;
+			entry->data_hash = data_hash;
 			return ReturnEntry(stage, entry);
 		}
 
@@ -435,7 +545,7 @@ TextureCache::TCacheEntryBase* TextureCache::Load(unsigned int const stage,
 		else
 		{
 			// delete the texture and make a new one
-			delete entry;
+			FreeTexture(entry);
 			entry = NULL;
 		}
 	}
@@ -456,7 +566,7 @@ TextureCache::TCacheEntryBase* TextureCache::Load(unsigned int const stage,
 				// If we thought we could reuse the texture before, make sure to pool it now!
 				if(entry)
 				{
-					delete entry;
+					FreeTexture(entry);
 					entry = NULL;
 				}
 			}
@@ -464,11 +574,22 @@ TextureCache::TCacheEntryBase* TextureCache::Load(unsigned int const stage,
 		}
 	}
 
+	u32 texLevels = use_mipmaps ? (maxlevel + 1) : 1;
+	const bool using_custom_lods = using_custom_texture && CheckForCustomTextureLODs(tex_hash, texformat, texLevels);
+	// Only load native mips if their dimensions fit to our virtual texture dimensions
+	const bool use_native_mips = use_mipmaps && !using_custom_lods && (width == nativeW && height == nativeH);
+	texLevels = (use_native_mips || using_custom_lods) ? texLevels : 1; // TODO: Should be forced to 1 for non-pow2 textures (e.g. efb copies with automatically adjusted IR)
+
+	// All levels are queued to the decode workers at once, each decoded into its own
+	// part of temp, so the mips get decoded while the levels before them are uploaded.
+	std::unique_ptr<DecodeWorkers::Batch[]> level_batches(new DecodeWorkers::Batch[texLevels]);
+	std::vector<u8*> level_data(texLevels, temp);
+
 	if (!using_custom_texture)
 	{
 		if (!(texformat == GX_TF_RGBA8 && from_tmem))
 		{
-			pcfmt = TexDecoder_Decode(temp, src_data, expandedWidth,
+			pcfmt = TexDecoder_DecodeAsync(level_batches[0], temp, src_data, expandedWidth,
 						expandedHeight, texformat, tlutaddr, tlutfmt, g_ActiveConfig.backend_info.bUseRGBATextures);
 		}
 		else
@@ -478,16 +599,45 @@ TextureCache::TCacheEntryBase* TextureCache::Load(unsigned int const stage,
 		}
 	}
 
-	u32 texLevels = use_mipmaps ? (maxlevel + 1) : 1;
-	const bool using_custom_lods = using_custom_texture && CheckForCustomTextureLODs(tex_hash, texformat, texLevels);
-	// Only load native mips if their dimensions fit to our virtual texture dimensions
-	const bool use_native_mips = use_mipmaps && !using_custom_lods && (width == nativeW && height == nativeH);
-	texLevels = (use_native_mips || using_custom_lods) ? texLevels : 1; // TODO: Should be forced to 1 for non-pow2 textures (e.g. efb copies with automatically adjusted IR)
+	// load mips - TODO: Loading mipmaps from tmem is untested!
+	if (pcfmt != PC_TEX_FMT_NONE && use_native_mips)
+	{
+		src_data += texture_size;
+
+		const u8* ptr_even = NULL;
+		const u8* ptr_odd = NULL;
+		if (from_tmem)
+		{
+			ptr_even = &texMem[bpmem.tex[stage/4].texImage1[stage%4].tmem_even * TMEM_LINE_SIZE + texture_size];
+			ptr_odd = &texMem[bpmem.tex[stage/4].texImage2[stage%4].tmem_odd * TMEM_LINE_SIZE];
+		}
+
+		// Decoded texels take at most 4 bytes.  Textures are at most 1024x1024,
+		// so all levels fit into temp.
+		u32 offset = ROUND_UP(expandedWidth * expandedHeight * 4, 16);
+		for (u32 level = 1; level != texLevels; ++level)
+		{
+			const u32 mip_width = CalculateLevelSize(width, level);
+			const u32 mip_height = CalculateLevelSize(height, level);
+			const u32 expanded_mip_width = (mip_width + bsw) & (~bsw);
+			const u32 expanded_mip_height = (mip_height + bsh) & (~bsh);
+
+			const u8*& mip_src_data = from_tmem
+				? ((level % 2) ? ptr_odd : ptr_even)
+				: src_data;
+			level_data[level] = temp + offset;
+			TexDecoder_DecodeAsync(level_batches[level], level_data[level], mip_src_data, expanded_mip_width, expanded_mip_height, texformat, tlutaddr, tlutfmt, g_ActiveConfig.backend_info.bUseRGBATextures);
+			mip_src_data += TexDecoder_GetTextureSizeInBytes(expanded_mip_width, expanded_mip_height, texformat);
+			offset += ROUND_UP(expanded_mip_width * expanded_mip_height * 4, 16);
+		}
+	}
+
+	level_batches[0].Wait();
 
 	// create the entry/texture
 	if (NULL == entry)
 	{
-		textures[texID] = entry = g_texture_cache->CreateTexture(width, height, expandedWidth, texLevels, pcfmt);
+		textures[texID] = entry = AllocateTexture(width, height, expandedWidth, texLevels, pcfmt);
 
 		// Sometimes, we can get around recreating a texture if only the number of mip levels changes
 		// e.g. if our texture cache entry got too many mipmap levels we can limit the number of used levels by setting the appropriate render states
@@ -504,12 +654,15 @@ TextureCache::TCacheEntryBase* TextureCache::Load(unsigned int const stage,
 	else
 	{
 		// load texture (CreateTexture also loads level 0)
-		entry->Load(width, height, expandedWidth, 0);
+		entry->Load(temp, width, height, expandedWidth, 0);
 	}
 
 	entry->SetGeneralParameters(address, texture_size, full_format, entry->num_mipmaps);
 	entry->SetDimensions(nativeW, nativeH, width, height);
 	entry->hash = tex_hash;
+	entry->watched = watched;
+	entry->watch_epoch = watch_epoch;
+	entry->data_hash = data_hash;
 
 	if (entry->IsEfbCopy() && !g_ActiveConfig.bCopyEFBToTexture)
 		entry->type = TCET_EC_DYNAMIC;
@@ -520,35 +673,18 @@ TextureCache::TCacheEntryBase* TextureCache::Load(unsigned int const stage,
 		DumpTexture(entry, 0);
 
 	u32 level = 1;
-	// load mips - TODO: Loading mipmaps from tmem is untested!
 	if (pcfmt != PC_TEX_FMT_NONE)
 	{
 		if (use_native_mips)
 		{
-			src_data += texture_size;
-
-			const u8* ptr_even = NULL;
-			const u8* ptr_odd = NULL;
-			if (from_tmem)
-			{
-				ptr_even = &texMem[bpmem.tex[stage/4].texImage1[stage%4].tmem_even * TMEM_LINE_SIZE + texture_size];
-				ptr_odd = &texMem[bpmem.tex[stage/4].texImage2[stage%4].tmem_odd * TMEM_LINE_SIZE];
-			}
-
 			for (; level != texLevels; ++level)
 			{
 				const u32 mip_width = CalculateLevelSize(width, level);
 				const u32 mip_height = CalculateLevelSize(height, level);
 				const u32 expanded_mip_width = (mip_width + bsw) & (~bsw);
-				const u32 expanded_mip_height = (mip_height + bsh) & (~bsh);
-
-				const u8*& mip_src_data = from_tmem
-					? ((level % 2) ? ptr_odd : ptr_even)
-					: src_data;
-				TexDecoder_Decode(temp, mip_src_data, expanded_mip_width, expanded_mip_height, texformat, tlutaddr, tlutfmt, g_ActiveConfig.backend_info.bUseRGBATextures);
-				mip_src_data += TexDecoder_GetTextureSizeInBytes(expanded_mip_width, expanded_mip_height, texformat);
 
-				entry->Load(mip_width, mip_height, expanded_mip_width, level);
+				level_batches[level].Wait();
+				entry->Load(level_data[level], mip_width, mip_height, expanded_mip_width, level);
 
 				if (g_ActiveConfig.bDumpTextures)
 					DumpTexture(entry, level);
@@ -562,7 +698,7 @@ TextureCache::TCacheEntryBase* TextureCache::Load(unsigned int const stage,
 				unsigned int mip_height = CalculateLevelSize(height, level);
 
 				LoadCustomTexture(tex_hash, texformat, level, mip_width, mip_height);
-				entry->Load(mip_width, mip_height, mip_width, level);
+				entry->Load(temp, mip_width, mip_height, mip_width, level);
 			}
 		}
 	}
@@ -866,7 +1002,7 @@ void TextureCache::CopyRenderTargetToTexture(u32 dstAddr, unsigned int dstFormat
 		else if (!(entry->type == TCET_EC_VRAM && entry->virtual_width == scaled_tex_w && entry->virtual_height == scaled_tex_h))
 		{
 			// remove it and recreate it as a render target
-			delete entry;
+			FreeTexture(entry);
 			entry = NULL;
 		}
 	}
@@ -874,7 +1010,7 @@ void TextureCache::CopyRenderTargetToTexture(u32 dstAddr, unsigned int dstFormat
 	if (NULL == entry)
 	{
 		// create the texture
-		textures[dstAddr] = entry = g_texture_cache->CreateRenderTargetTexture(scaled_tex_w, scaled_tex_h);
+		textures[dstAddr] = entry = AllocateRenderTargetTexture(scaled_tex_w, scaled_tex_h);
 
 		// TODO: Using the wrong dstFormat, dumb...
 		entry->SetGeneralParameters(dstAddr, 0, dstFormat, 1);
@@ -25,6 +25,27 @@ public:
 		TCET_EC_DYNAMIC,	// EFB copy which sits in RAM and needs to be decoded before being used
 	};
 
+	// Parameters of a backend texture object, used to find a pooled one to reuse.
+	struct TexPoolKey
+	{
+		unsigned int width, height, levels;
+		PC_TexFormat pcfmt;
+		bool render_target;
+
+		bool operator<(const TexPoolKey& other) const
+		{
+			if (width != other.width)
+				return width < other.width;
+			if (height != other.height)
+				return height < other.height;
+			if (levels != other.levels)
+				return levels < other.levels;
+			if (pcfmt != other.pcfmt)
+				return pcfmt < other.pcfmt;
+			return render_target < other.render_target;
+		}
+	};
+
 	struct TCacheEntryBase
 	{
 #define TEXHASH_INVALID 0
@@ -43,8 +64,19 @@ public:
 		unsigned int virtual_width, virtual_height; // Texture dimensions from OUR point of view - for hires textures or scaled EFB copies
 
 		// used to delete textures which haven't been used for TEXTURE_KILL_THRESHOLD frames
+		// (TEXTURE_POOL_KILL_THRESHOLD frames while in the texture pool)
 		int frameCount;
 
+		// what the backend texture was created with, see TextureCache::AllocateTexture
+		TexPoolKey pool_key;
+
+		// Normal textures whose RAM is under a write watch (see Memory::WatchRange)
+		// keep data_hash, the hash of the RAM data alone, until something writes there.
+		bool watched;
+		u64 watch_epoch;
+		u64 data_hash;
+
+		TCacheEntryBase() : watched(false), watch_epoch(0), data_hash(TEXHASH_INVALID) {}
 
 		void SetGeneralParameters(u32 _addr, u32 _size, u32 _format, unsigned int _num_mipmaps)
 		{
@@ -74,7 +106,7 @@ public:
 		virtual void Bind(unsigned int stage) = 0;
 		virtual bool Save(const std::string filename, unsigned int level) = 0;
 
-		virtual void Load(unsigned int width, unsigned int height,
+		virtual void Load(const u8* data, unsigned int width, unsigned int height,
 			unsigned int expanded_width, unsigned int level) = 0;
 		virtual void FromRenderTarget(u32 dstAddr, unsigned int dstFormat,
 			unsigned int srcFormat, const EFBRectangle& srcRect,
@@ -119,9 +151,19 @@ private:
 	static PC_TexFormat LoadCustomTexture(u64 tex_hash, int texformat, unsigned int level, unsigned int& width, unsigned int& height);
 	static void DumpTexture(TCacheEntryBase* entry, unsigned int level);
 
+	// Textures are taken from and returned to the texture pool instead of being
+	// created and deleted through the backend every time.
+	static TCacheEntryBase* AllocateTexture(unsigned int width, unsigned int height,
+		unsigned int expanded_width, unsigned int tex_levels, PC_TexFormat pcfmt);
+	static TCacheEntryBase* AllocateRenderTargetTexture(unsigned int scaled_tex_w, unsigned int scaled_tex_h);
+	static void FreeTexture(TCacheEntryBase* entry);
+	static void ClearTexturePool();
+
 	typedef std::map<u32, TCacheEntryBase*> TexCache;
+	typedef std::multimap<TexPoolKey, TCacheEntryBase*> TexPool;
 
 	static TexCache textures;
+	static TexPool texture_pool;
 
 	// Backup configuration values
 	static struct BackupConfig
@@ -6,6 +6,11 @@
 
 #include "Hash.h"
 
+namespace DecodeWorkers
+{
+	class Batch;
+}
+
 enum
 {
 	TMEM_SIZE = 1024*1024,
@@ -72,6 +77,9 @@ enum PC_TexFormat
 };
 
 PC_TexFormat TexDecoder_Decode(u8 *dst, const u8 *src, int width, int height, int texformat, int tlutaddr, int tlutfmt,bool rgbaOnly = false);
+// Like TexDecoder_Decode, but the decoding is queued to the decode workers as
+// part of batch.  dst and src have to stay valid until the batch is waited for.
+PC_TexFormat TexDecoder_DecodeAsync(DecodeWorkers::Batch& batch, u8 *dst, const u8 *src, int width, int height, int texformat, int tlutaddr, int tlutfmt, bool rgbaOnly = false);
 PC_TexFormat GetPC_TexFormat(int texformat, int tlutfmt);
 void TexDecoder_DecodeTexel(u8 *dst, const u8 *src, int s, int t, int imageWidth, int texformat, int tlutaddr, int tlutfmt);
 void TexDecoder_DecodeTexelRGBA8FromTmem(u8 *dst, const u8 *src_ar, const u8* src_gb, int s, int t, int imageWidth);
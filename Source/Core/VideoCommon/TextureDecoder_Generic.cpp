@@ -1137,6 +1137,12 @@ PC_TexFormat TexDecoder_Decode(u8 *dst, const u8 *src, int width, int height, in
 	return retval;
 }
 
+// Not split up here, the decoders are only parallelized on x64.
+PC_TexFormat TexDecoder_DecodeAsync(DecodeWorkers::Batch& batch, u8 *dst, const u8 *src, int width, int height, int texformat, int tlutaddr, int tlutfmt, bool rgbaOnly)
+{
+	return TexDecoder_Decode(dst, src, width, height, texformat, tlutaddr, tlutfmt, rgbaOnly);
+}
+
 
 
 void TexDecoder_DecodeTexel(u8 *dst, const u8 *src, int s, int t, int imageWidth, int texformat, int tlutaddr, int tlutfmt)
@@ -31,6 +31,9 @@
 #ifndef _M_GENERIC
 #ifndef __APPLE__
 #define USE_JIT
+#ifdef _M_X64
+#define USE_INLINE_JIT
+#endif
 #endif
 #endif
 
@@ -470,6 +473,7 @@ void LOADERDECL TexMtx_Write_Float4()
 VertexLoader::VertexLoader(const TVtxDesc &vtx_desc, const VAT &vtx_attr)
 {
 	m_compiledCode = NULL;
+	m_inlineCode = false;
 	m_numLoadedVertices = 0;
 	m_VertexSize = 0;
 	m_numPipelineStages = 0;
@@ -512,24 +516,33 @@ void VertexLoader::CompileVertexTranslator()
 	m_compiledCode = GetCodePtr();
 	ABI_PushAllCalleeSavedRegsAndAdjustStack();
 
+#ifdef USE_INLINE_JIT
+	m_inlineCode = !g_ActiveConfig.bUseBBox && IsInlineable();
+	if (m_inlineCode)
+		GeneratePrologue();
+#endif
+
 	// Start loop here
 	const u8 *loop_start = GetCodePtr();
 
 	// Reset component counters if present in vertex format only.
-	if (m_VtxDesc.Tex0Coord || m_VtxDesc.Tex1Coord || m_VtxDesc.Tex2Coord || m_VtxDesc.Tex3Coord ||
-		m_VtxDesc.Tex4Coord || m_VtxDesc.Tex5Coord || m_VtxDesc.Tex6Coord || m_VtxDesc.Tex7Coord)
-	{
-		WriteSetVariable(32, &tcIndex, Imm32(0));
-	}
-	if (m_VtxDesc.Color0 || m_VtxDesc.Color1)
-	{
-		WriteSetVariable(32, &colIndex, Imm32(0));
-	}
-	if (m_VtxDesc.Tex0MatIdx || m_VtxDesc.Tex1MatIdx || m_VtxDesc.Tex2MatIdx || m_VtxDesc.Tex3MatIdx ||
-		m_VtxDesc.Tex4MatIdx || m_VtxDesc.Tex5MatIdx || m_VtxDesc.Tex6MatIdx || m_VtxDesc.Tex7MatIdx)
+	if (!m_inlineCode)
 	{
-		WriteSetVariable(32, &s_texmtxwrite, Imm32(0));
-		WriteSetVariable(32, &s_texmtxread, Imm32(0));
+		if (m_VtxDesc.Tex0Coord || m_VtxDesc.Tex1Coord || m_VtxDesc.Tex2Coord || m_VtxDesc.Tex3Coord ||
+			m_VtxDesc.Tex4Coord || m_VtxDesc.Tex5Coord || m_VtxDesc.Tex6Coord || m_VtxDesc.Tex7Coord)
+		{
+			WriteSetVariable(32, &tcIndex, Imm32(0));
+		}
+		if (m_VtxDesc.Color0 || m_VtxDesc.Color1)
+		{
+			WriteSetVariable(32, &colIndex, Imm32(0));
+		}
+		if (m_VtxDesc.Tex0MatIdx || m_VtxDesc.Tex1MatIdx || m_VtxDesc.Tex2MatIdx || m_VtxDesc.Tex3MatIdx ||
+			m_VtxDesc.Tex4MatIdx || m_VtxDesc.Tex5MatIdx || m_VtxDesc.Tex6MatIdx || m_VtxDesc.Tex7MatIdx)
+		{
+			WriteSetVariable(32, &s_texmtxwrite, Imm32(0));
+			WriteSetVariable(32, &s_texmtxread, Imm32(0));
+		}
 	}
 #endif
 
@@ -543,6 +556,10 @@ void VertexLoader::CompileVertexTranslator()
 		m_VtxDesc.Tex0Coord, m_VtxDesc.Tex1Coord, m_VtxDesc.Tex2Coord, m_VtxDesc.Tex3Coord,
 		m_VtxDesc.Tex4Coord, m_VtxDesc.Tex5Coord, m_VtxDesc.Tex6Coord, (const u32)((m_VtxDesc.Hex >> 31) & 3)
 	};
+	const u32 texmtx[8] = {
+		m_VtxDesc.Tex0MatIdx, m_VtxDesc.Tex1MatIdx, m_VtxDesc.Tex2MatIdx, m_VtxDesc.Tex3MatIdx,
+		m_VtxDesc.Tex4MatIdx, m_VtxDesc.Tex5MatIdx, m_VtxDesc.Tex6MatIdx, m_VtxDesc.Tex7MatIdx
+	};
 
 	// Reset pipeline
 	m_numPipelineStages = 0;
@@ -553,24 +570,36 @@ void VertexLoader::CompileVertexTranslator()
 	PortableVertexDeclaration vtx_decl;
 	memset(&vtx_decl, 0, sizeof(vtx_decl));
 
+	// Offsets of the matrix index bytes within the GC vertex, for the inline loader
+	int posmtx_offset = 0;
+	int texmtx_offset[8] = {};
+	int num_colors = 0;
+
 	// Position Matrix Index
 	if (m_VtxDesc.PosMatIdx)
 	{
 		WriteCall(PosMtx_ReadDirect_UByte);
 		components |= VB_HAS_POSMTXIDX;
+		posmtx_offset = m_VertexSize;
 		m_VertexSize += 1;
 	}
 
-	if (m_VtxDesc.Tex0MatIdx) {m_VertexSize += 1; components |= VB_HAS_TEXMTXIDX0; WriteCall(TexMtx_ReadDirect_UByte); }
-	if (m_VtxDesc.Tex1MatIdx) {m_VertexSize += 1; components |= VB_HAS_TEXMTXIDX1; WriteCall(TexMtx_ReadDirect_UByte); }
-	if (m_VtxDesc.Tex2MatIdx) {m_VertexSize += 1; components |= VB_HAS_TEXMTXIDX2; WriteCall(TexMtx_ReadDirect_UByte); }
-	if (m_VtxDesc.Tex3MatIdx) {m_VertexSize += 1; components |= VB_HAS_TEXMTXIDX3; WriteCall(TexMtx_ReadDirect_UByte); }
-	if (m_VtxDesc.Tex4MatIdx) {m_VertexSize += 1; components |= VB_HAS_TEXMTXIDX4; WriteCall(TexMtx_ReadDirect_UByte); }
-	if (m_VtxDesc.Tex5MatIdx) {m_VertexSize += 1; components |= VB_HAS_TEXMTXIDX5; WriteCall(TexMtx_ReadDirect_UByte); }
-	if (m_VtxDesc.Tex6MatIdx) {m_VertexSize += 1; components |= VB_HAS_TEXMTXIDX6; WriteCall(TexMtx_ReadDirect_UByte); }
-	if (m_VtxDesc.Tex7MatIdx) {m_VertexSize += 1; components |= VB_HAS_TEXMTXIDX7; WriteCall(TexMtx_ReadDirect_UByte); }
+	for (int i = 0; i < 8; i++)
+	{
+		if (texmtx[i])
+		{
+			components |= VB_HAS_TEXMTXIDX0 << i;
+			texmtx_offset[i] = m_VertexSize;
+			m_VertexSize += 1;
+			WriteCall(TexMtx_ReadDirect_UByte);
+		}
+	}
 
 	// Write vertex position loader
+#ifdef USE_INLINE_JIT
+	if (m_inlineCode)
+		GenerateReadPosition(m_VertexSize, nat_offset);
+#endif
 	if(g_ActiveConfig.bUseBBox)
 	{
 		WriteCall(UpdateBoundingBoxPrepare);
@@ -592,6 +621,11 @@ void VertexLoader::CompileVertexTranslator()
 	// Normals
 	if (m_VtxDesc.Normal != NOT_PRESENT)
 	{
+#ifdef USE_INLINE_JIT
+		if (m_inlineCode)
+			GenerateReadNormal(m_VertexSize, nat_offset);
+#endif
+
 		m_VertexSize += VertexLoader_Normal::GetSize(m_VtxDesc.Normal,
 			m_VtxAttr.NormalFormat, m_VtxAttr.NormalElements, m_VtxAttr.NormalIndex3);
 
@@ -629,6 +663,10 @@ void VertexLoader::CompileVertexTranslator()
 		vtx_decl.colors[i].components = 4;
 		vtx_decl.colors[i].type = VAR_UNSIGNED_BYTE;
 		vtx_decl.colors[i].integer = false;
+#ifdef USE_INLINE_JIT
+		if (col[i] != NOT_PRESENT && m_inlineCode)
+			GenerateReadColor(col[i], m_VtxAttr.color[i].Comp, num_colors, m_VertexSize, nat_offset);
+#endif
 		switch (col[i])
 		{
 		case NOT_PRESENT:
@@ -679,6 +717,7 @@ void VertexLoader::CompileVertexTranslator()
 			vtx_decl.colors[i].offset = nat_offset;
 			vtx_decl.colors[i].enable = true;
 			nat_offset += 4;
+			num_colors++;
 		}
 	}
 
@@ -703,6 +742,10 @@ void VertexLoader::CompileVertexTranslator()
 			_assert_msg_(VIDEO, 0 <= elements && elements <= 1, "Invalid number of texture coordinates elements!\n(elements = %d)", elements);
 
 			components |= VB_HAS_UV0 << i;
+#ifdef USE_INLINE_JIT
+			if (m_inlineCode)
+				GenerateReadTexCoord(i, tc[i], format, elements, m_VertexSize, nat_offset);
+#endif
 			WriteCall(VertexLoader_TextCoord::GetFunction(tc[i], format, elements));
 			m_VertexSize += VertexLoader_TextCoord::GetSize(tc[i], format, elements);
 		}
@@ -714,6 +757,10 @@ void VertexLoader::CompileVertexTranslator()
 			{
 				// if texmtx is included, texcoord will always be 3 floats, z will be the texmtx index
 				vtx_decl.texcoords[i].components = 3;
+#ifdef USE_INLINE_JIT
+				if (m_inlineCode)
+					GenerateWriteTexMtx(texmtx_offset[i], nat_offset, m_VtxAttr.texCoord[i].Elements ? 2 : 1, 3);
+#endif
 				nat_offset += 12;
 				WriteCall(m_VtxAttr.texCoord[i].Elements ? TexMtx_Write_Float : TexMtx_Write_Float2);
 			}
@@ -721,6 +768,10 @@ void VertexLoader::CompileVertexTranslator()
 			{
 				components |= VB_HAS_UV0 << i; // have to include since using now
 				vtx_decl.texcoords[i].components = 4;
+#ifdef USE_INLINE_JIT
+				if (m_inlineCode)
+					GenerateWriteTexMtx(texmtx_offset[i], nat_offset, 0, 4);
+#endif
 				nat_offset += 16; // still include the texture coordinate, but this time as 6 + 2 bytes
 				WriteCall(TexMtx_Write_Float4);
 			}
@@ -758,6 +809,10 @@ void VertexLoader::CompileVertexTranslator()
 
 	if (m_VtxDesc.PosMatIdx)
 	{
+#ifdef USE_INLINE_JIT
+		if (m_inlineCode)
+			GenerateWritePosMtx(posmtx_offset, nat_offset);
+#endif
 		WriteCall(PosMtx_Write);
 		vtx_decl.posmtx.components = 4;
 		vtx_decl.posmtx.enable = true;
@@ -772,14 +827,26 @@ void VertexLoader::CompileVertexTranslator()
 
 #ifdef USE_JIT
 	// End loop here
+#ifdef USE_INLINE_JIT
+	if (m_inlineCode)
+	{
+		ADD(64, R(RSI), Imm32(m_VertexSize));
+		ADD(64, R(RDI), Imm32(native_stride));
+		SUB(32, R(R11), Imm8(1));
+		J_CC(CC_NZ, loop_start, true);
+		GenerateEpilogue();
+	}
+	else
+#endif
+	{
 #ifdef _M_X64
-	MOV(64, R(RAX), Imm64((u64)&loop_counter));
-	SUB(32, MatR(RAX), Imm8(1));
+		MOV(64, R(RAX), Imm64((u64)&loop_counter));
+		SUB(32, MatR(RAX), Imm8(1));
 #else
-	SUB(32, M(&loop_counter), Imm8(1));
+		SUB(32, M(&loop_counter), Imm8(1));
 #endif
-
-	J_CC(CC_NZ, loop_start, true);
+		J_CC(CC_NZ, loop_start, true);
+	}
 	ABI_PopAllCalleeSavedRegsAndAdjustStack();
 	RET();
 #endif
@@ -788,8 +855,301 @@ void VertexLoader::CompileVertexTranslator()
 	m_NativeFmt->Initialize(vtx_decl);
 }
 
+#ifdef USE_INLINE_JIT
+// The inline loader keeps everything in registers for the whole draw:
+//   RSI = GC vertex data (g_pVideoData), RDI = native vertex (s_pCurBufferPointer),
+//   R8  = tcScale, R9 = cached_arraybases, R10 = arraystrides, R11D = vertices left.
+// Attributes are addressed at constant offsets from RSI/RDI, which both advance
+// by one vertex per iteration. Only XMM0-XMM1 are used, so nothing besides the
+// GPRs pushed by ABI_PushAllCalleeSavedRegsAndAdjustStack needs preserving.
+
+bool VertexLoader::IsInlineable() const
+{
+	if (m_VtxAttr.PosFormat > FORMAT_FLOAT)
+		return false;
+	if (m_VtxDesc.Normal != NOT_PRESENT && m_VtxAttr.NormalFormat > FORMAT_FLOAT)
+		return false;
+
+	const u32 col[2] = {m_VtxDesc.Color0, m_VtxDesc.Color1};
+	for (int i = 0; i < 2; i++)
+	{
+		if (col[i] != NOT_PRESENT && m_VtxAttr.color[i].Comp > FORMAT_32B_8888)
+			return false;
+	}
+
+	const u32 tc[8] = {
+		m_VtxDesc.Tex0Coord, m_VtxDesc.Tex1Coord, m_VtxDesc.Tex2Coord, m_VtxDesc.Tex3Coord,
+		m_VtxDesc.Tex4Coord, m_VtxDesc.Tex5Coord, m_VtxDesc.Tex6Coord, (const u32)((m_VtxDesc.Hex >> 31) & 3)
+	};
+	for (int i = 0; i < 8; i++)
+	{
+		if (tc[i] != NOT_PRESENT && m_VtxAttr.texCoord[i].Format > FORMAT_FLOAT)
+			return false;
+	}
+
+	return true;
+}
+
+void VertexLoader::GeneratePrologue()
+{
+	MOV(64, R(RAX), Imm64((u64)&g_pVideoData));
+	MOV(64, R(RSI), MatR(RAX));
+	MOV(64, R(RAX), Imm64((u64)&VertexManager::s_pCurBufferPointer));
+	MOV(64, R(RDI), MatR(RAX));
+	MOV(64, R(RAX), Imm64((u64)&loop_counter));
+	MOV(32, R(R11), MatR(RAX));
+	MOV(64, R(R8), Imm64((u64)tcScale));
+	MOV(64, R(R9), Imm64((u64)cached_arraybases));
+	MOV(64, R(R10), Imm64((u64)arraystrides));
+}
+
+void VertexLoader::GenerateEpilogue()
+{
+	MOV(64, R(RAX), Imm64((u64)&g_pVideoData));
+	MOV(64, MatR(RAX), R(RSI));
+	MOV(64, R(RAX), Imm64((u64)&VertexManager::s_pCurBufferPointer));
+	MOV(64, MatR(RAX), R(RDI));
+}
+
+OpArg VertexLoader::GenerateIndexedAddress(int array, int index_type, int src_offset)
+{
+	if (index_type == INDEX8)
+	{
+		MOVZX(32, 8, EDX, MDisp(RSI, src_offset));
+	}
+	else
+	{
+		MOVZX(32, 16, EDX, MDisp(RSI, src_offset));
+		ROL(16, R(EDX), Imm8(8));
+	}
+	IMUL(32, EDX, MDisp(R10, array * sizeof(u32)));
+	ADD(64, R(RDX), MDisp(R9, array * sizeof(u8*)));
+	return MatR(RDX);
+}
+
+void VertexLoader::GenerateReadComponents(OpArg src, int format, int count, int dst_offset, bool scaled)
+{
+	static const int format_size[5] = {1, 1, 2, 2, 4};
+	const int size = format_size[format];
+
+	for (int i = 0; i < count; i++)
+	{
+		OpArg data = src;
+		data.offset += i * size;
+
+		switch (format)
+		{
+		case FORMAT_UBYTE:
+			MOVZX(32, 8, EAX, data);
+			break;
+		case FORMAT_BYTE:
+			MOVSX(32, 8, EAX, data);
+			break;
+		case FORMAT_USHORT:
+			MOVZX(32, 16, EAX, data);
+			ROL(16, R(EAX), Imm8(8));
+			break;
+		case FORMAT_SHORT:
+			MOVZX(32, 16, EAX, data);
+			ROL(16, R(EAX), Imm8(8));
+			MOVSX(32, 16, EAX, R(EAX));
+			break;
+		case FORMAT_FLOAT:
+			// Floats are passed through bit for bit
+			MOV(32, R(EAX), data);
+			BSWAP(32, EAX);
+			MOV(32, MDisp(RDI, dst_offset + i * 4), R(EAX));
+			continue;
+		}
+
+		MOVD_xmm(XMM0, R(EAX));
+		CVTDQ2PS(XMM0, R(XMM0));
+		if (scaled)
+			MULSS(XMM0, R(XMM1));
+		MOVSS(MDisp(RDI, dst_offset + i * 4), XMM0);
+	}
+}
+
+void VertexLoader::GenerateReadPosition(int src_offset, int dst_offset)
+{
+	const int format = m_VtxAttr.PosFormat;
+	const int elements = m_VtxAttr.PosElements ? 3 : 2;
+
+	OpArg src = MDisp(RSI, src_offset);
+	if (m_VtxDesc.Position != DIRECT)
+		src = GenerateIndexedAddress(ARRAY_POSITION, m_VtxDesc.Position, src_offset);
+
+	if (format != FORMAT_FLOAT)
+	{
+		MOV(64, R(RAX), Imm64((u64)&posScale));
+		MOVSS(XMM1, MatR(RAX));
+	}
+	GenerateReadComponents(src, format, elements, dst_offset, true);
+
+	if (elements == 2)
+		MOV(32, MDisp(RDI, dst_offset + 8), Imm32(0));
+}
+
+void VertexLoader::GenerateReadNormal(int src_offset, int dst_offset)
+{
+	// Same fixed point scale as FracAdjust() in VertexLoader_Normal.cpp
+	static const u32 normal_scale[5] = {
+		0x3c000000, // 1/128
+		0x3c800000, // 1/64
+		0x38000000, // 1/32768
+		0x38800000, // 1/16384
+		0x3f800000, // unused for floats
+	};
+	static const int format_size[5] = {1, 1, 2, 2, 4};
+	const int format = m_VtxAttr.NormalFormat;
+	const int count = m_VtxAttr.NormalElements ? 9 : 3;
+
+	if (format != FORMAT_FLOAT)
+	{
+		MOV(32, R(EAX), Imm32(normal_scale[format]));
+		MOVD_xmm(XMM1, R(EAX));
+	}
+
+	if (m_VtxDesc.Normal == DIRECT)
+	{
+		GenerateReadComponents(MDisp(RSI, src_offset), format, count, dst_offset, true);
+	}
+	else if (m_VtxAttr.NormalElements && m_VtxAttr.NormalIndex3)
+	{
+		// One index per normal, each selecting its own triplet of the array entry
+		const int index_size = (m_VtxDesc.Normal == INDEX8) ? 1 : 2;
+		for (int i = 0; i < 3; i++)
+		{
+			OpArg src = GenerateIndexedAddress(ARRAY_NORMAL, m_VtxDesc.Normal, src_offset + i * index_size);
+			src.offset += i * 3 * format_size[format];
+			GenerateReadComponents(src, format, 3, dst_offset + i * 12, true);
+		}
+	}
+	else
+	{
+		OpArg src = GenerateIndexedAddress(ARRAY_NORMAL, m_VtxDesc.Normal, src_offset);
+		GenerateReadComponents(src, format, count, dst_offset, true);
+	}
+}
+
+void VertexLoader::GenerateOrShifted(X64Reg dest, X64Reg src, int shift, u32 mask)
+{
+	MOV(32, R(ECX), R(src));
+	if (shift > 0)
+		SHL(32, R(ECX), Imm8(shift));
+	else if (shift < 0)
+		SHR(32, R(ECX), Imm8(-shift));
+	if (mask != 0xFFFFFFFF)
+		AND(32, R(ECX), Imm32(mask));
+	OR(32, R(dest), R(ECX));
+}
+
+void VertexLoader::GenerateReadColor(int mode, int format, int color_index, int src_offset, int dst_offset)
+{
+	// The C++ loaders pick the array and the alpha kill by the number of colors
+	// loaded so far rather than by the color channel, so do the same here.
+	OpArg src = MDisp(RSI, src_offset);
+	if (mode != DIRECT)
+		src = GenerateIndexedAddress(ARRAY_COLOR + color_index, mode, src_offset);
+
+	switch (format)
+	{
+	case FORMAT_24B_888:
+	case FORMAT_32B_888x:
+		MOV(32, R(EAX), src);
+		OR(32, R(EAX), Imm32(0xFF000000));
+		break;
+
+	case FORMAT_32B_8888:
+		MOV(32, R(EAX), src);
+		if (mode == DIRECT && !m_VtxAttr.color[color_index].Elements)
+			OR(32, R(EAX), Imm32(0xFF000000));
+		break;
+
+	case FORMAT_16B_565:
+		// RRRRRGGG GGGBBBBB -> AABBGGRR
+		MOVZX(32, 16, EDX, src);
+		ROL(16, R(EDX), Imm8(8));
+		XOR(32, R(EAX), R(EAX));
+		GenerateOrShifted(EAX, EDX, -8, 0xF8);
+		GenerateOrShifted(EAX, EDX, 5, 0xFC00);
+		GenerateOrShifted(EAX, EDX, 19, 0xF80000);
+		GenerateOrShifted(EAX, EAX, -5, 0x070007);
+		GenerateOrShifted(EAX, EAX, -6, 0x000300);
+		OR(32, R(EAX), Imm32(0xFF000000));
+		break;
+
+	case FORMAT_16B_4444:
+		// BARG (read little endian) -> AABBGGRR
+		MOVZX(32, 16, EDX, src);
+		XOR(32, R(EAX), R(EAX));
+		GenerateOrShifted(EAX, EDX, 0, 0xF0);
+		GenerateOrShifted(EAX, EDX, 12, 0xF000);
+		GenerateOrShifted(EAX, EDX, 8, 0xF00000);
+		GenerateOrShifted(EAX, EDX, 20, 0xF0000000);
+		GenerateOrShifted(EAX, EAX, -4, 0xFFFFFFFF);
+		break;
+
+	case FORMAT_24B_6666:
+		// RRRRRRGG GGGGBBBB BBAAAAAA -> AABBGGRR
+		src.offset -= 1;
+		MOV(32, R(EDX), src);
+		BSWAP(32, EDX);
+		XOR(32, R(EAX), R(EAX));
+		GenerateOrShifted(EAX, EDX, -16, 0xFC);
+		GenerateOrShifted(EAX, EDX, -2, 0xFC00);
+		GenerateOrShifted(EAX, EDX, 12, 0xFC0000);
+		GenerateOrShifted(EAX, EDX, 26, 0xFC000000);
+		GenerateOrShifted(EAX, EAX, -6, 0x03030303);
+		break;
+	}
+
+	MOV(32, MDisp(RDI, dst_offset), R(EAX));
+}
+
+void VertexLoader::GenerateReadTexCoord(int tex, int mode, int format, int elements, int src_offset, int dst_offset)
+{
+	OpArg src = MDisp(RSI, src_offset);
+	if (mode != DIRECT)
+		src = GenerateIndexedAddress(ARRAY_TEXCOORD0 + tex, mode, src_offset);
+
+	if (format != FORMAT_FLOAT)
+		MOVSS(XMM1, MDisp(R8, tex * sizeof(float)));
+	GenerateReadComponents(src, format, elements ? 2 : 1, dst_offset, true);
+}
+
+void VertexLoader::GenerateWriteTexMtx(int src_offset, int dst_offset, int texcoords, int components)
+{
+	// Same layout as TexMtx_Write_Float*(): the matrix index always goes into the
+	// third float, padding after the texture coordinate is zeroed.
+	const int mtx_component = 2;
+	for (int i = texcoords; i < components; i++)
+	{
+		if (i != mtx_component)
+			MOV(32, MDisp(RDI, dst_offset + i * 4), Imm32(0));
+	}
+
+	MOVZX(32, 8, EAX, MDisp(RSI, src_offset));
+	AND(32, R(EAX), Imm8(0x3f));
+	MOVD_xmm(XMM0, R(EAX));
+	CVTDQ2PS(XMM0, R(XMM0));
+	MOVSS(MDisp(RDI, dst_offset + mtx_component * 4), XMM0);
+}
+
+void VertexLoader::GenerateWritePosMtx(int src_offset, int dst_offset)
+{
+	MOVZX(32, 8, EAX, MDisp(RSI, src_offset));
+	AND(32, R(EAX), Imm8(0x3f));
+	MOV(32, MDisp(RDI, dst_offset), R(EAX));
+}
+#endif
+
 void VertexLoader::WriteCall(TPipelineFunction func)
 {
+	// Inline loaders generate the attribute code directly instead
+	if (m_inlineCode)
+		return;
+
 #ifdef USE_JIT
 #ifdef _M_X64
 	MOV(64, R(RAX), Imm64((u64)func));
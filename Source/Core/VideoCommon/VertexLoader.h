@@ -124,6 +124,8 @@ private:
 	int m_numPipelineStages;
 
 	const u8 *m_compiledCode;
+	// Attribute decoding is generated inline instead of calling m_PipelineStages
+	bool m_inlineCode;
 
 	int m_numLoadedVertices;
 
@@ -138,4 +140,19 @@ private:
 	void WriteGetVariable(int bits, Gen::OpArg dest, void *address);
 	void WriteSetVariable(int bits, void *address, Gen::OpArg dest);
 #endif
+
+#ifdef _M_X64
+	bool IsInlineable() const;
+	void GeneratePrologue();
+	void GenerateEpilogue();
+	Gen::OpArg GenerateIndexedAddress(int array, int index_type, int src_offset);
+	void GenerateReadComponents(Gen::OpArg src, int format, int count, int dst_offset, bool scaled);
+	void GenerateOrShifted(Gen::X64Reg dest, Gen::X64Reg src, int shift, u32 mask);
+	void GenerateReadPosition(int src_offset, int dst_offset);
+	void GenerateReadNormal(int src_offset, int dst_offset);
+	void GenerateReadColor(int mode, int format, int color_index, int src_offset, int dst_offset);
+	void GenerateReadTexCoord(int tex, int mode, int format, int elements, int src_offset, int dst_offset);
+	void GenerateWriteTexMtx(int src_offset, int dst_offset, int texcoords, int components);
+	void GenerateWritePosMtx(int src_offset, int dst_offset);
+#endif
 };
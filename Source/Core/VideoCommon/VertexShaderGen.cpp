@@ -454,9 +454,33 @@ static inline void GenerateVertexShader(T& out, u32 components, API_TYPE api_typ
 	}
 }
 
+// The last UID generated.  It's only regenerated after a write to one of the
+// registers it's built from, see SetVertexShaderUidDirty.
+static u32 s_uid_epoch = 1;
+static u32 s_cached_uid_epoch = 0;
+static API_TYPE s_cached_api_type;
+static u32 s_cached_components;
+static VertexShaderUid s_cached_uid;
+
+void SetVertexShaderUidDirty()
+{
+	s_uid_epoch++;
+}
+
 void GetVertexShaderUid(VertexShaderUid& object, u32 components, API_TYPE api_type)
 {
+	if (s_cached_uid_epoch == s_uid_epoch && s_cached_api_type == api_type && s_cached_components == components)
+	{
+		object = s_cached_uid;
+		return;
+	}
+
 	GenerateVertexShader<VertexShaderUid>(object, components, api_type);
+
+	s_cached_uid_epoch = s_uid_epoch;
+	s_cached_api_type = api_type;
+	s_cached_components = components;
+	s_cached_uid = object;
 }
 
 void GenerateVertexShaderCode(VertexShaderCode& object, u32 components, API_TYPE api_type)
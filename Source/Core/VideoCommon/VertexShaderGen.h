@@ -88,5 +88,9 @@ typedef ShaderUid<vertex_shader_uid_data> VertexShaderUid;
 typedef ShaderCode VertexShaderCode; // TODO: Obsolete..
 
 void GetVertexShaderUid(VertexShaderUid& object, u32 components, API_TYPE api_type);
+
+// Must be called when any state GetVertexShaderUid reads changes: the XF
+// registers the UID is built from and the active video config.
+void SetVertexShaderUidDirty();
 void GenerateVertexShaderCode(VertexShaderCode& object, u32 components, API_TYPE api_type);
 void GenerateVSOutputStructForGS(ShaderCode& object, API_TYPE api_type);
@@ -12,6 +12,8 @@
 #include "Core.h"
 #include "Movie.h"
 #include "OnScreenDisplay.h"
+#include "PixelShaderGen.h"
+#include "VertexShaderGen.h"
 #include "ConfigManager.h"
 
 VideoConfig g_Config;
@@ -22,6 +24,10 @@ void UpdateActiveConfig()
 	if (Movie::IsPlayingInput() && Movie::IsConfigSaved())
 		Movie::SetGraphicsConfig();
 	g_ActiveConfig = g_Config;
+
+	// The shader generators read some of the config too.
+	SetPixelShaderUidDirty();
+	SetVertexShaderUidDirty();
 }
 
 VideoConfig::VideoConfig()
@@ -81,6 +87,7 @@ void VideoConfig::Load(const char *ini_file)
 	iniFile.Get("Settings", "DisableFog", &bDisableFog, 0);
 
 	iniFile.Get("Settings", "OMPDecoder", &bOMPDecoder, false);
+	iniFile.Get("Settings", "AsyncShaderMode", &iAsyncShaderMode, ASYNC_SHADERS_OFF);
 
 	iniFile.Get("Settings", "EnableShaderDebugging", &bEnableShaderDebugging, false);
 
@@ -145,6 +152,7 @@ void VideoConfig::GameIniLoad()
 	CHECK_SETTING("Video_Settings", "SafeTextureCacheColorSamples", iSafeTextureCache_ColorSamples);
 	CHECK_SETTING("Video_Settings", "DLOptimize", iCompileDLsLevel);
 	CHECK_SETTING("Video_Settings", "HiresTextures", bHiresTextures);
+	CHECK_SETTING("Video_Settings", "AsyncShaderMode", iAsyncShaderMode);
 	CHECK_SETTING("Video_Settings", "AnaglyphStereo", bAnaglyphStereo);
 	CHECK_SETTING("Video_Settings", "AnaglyphStereoSeparation", iAnaglyphStereoSeparation);
 	CHECK_SETTING("Video_Settings", "AnaglyphFocalAngle", iAnaglyphFocalAngle);
@@ -257,6 +265,7 @@ void VideoConfig::Save(const char *ini_file)
 	iniFile.Set("Settings", "DisableFog", bDisableFog);
 
 	iniFile.Set("Settings", "OMPDecoder", bOMPDecoder);
+	iniFile.Set("Settings", "AsyncShaderMode", iAsyncShaderMode);
 
 	iniFile.Set("Settings", "EnableShaderDebugging", bEnableShaderDebugging);
 
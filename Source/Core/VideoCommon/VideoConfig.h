@@ -44,6 +44,14 @@ enum EFBScale
 	SCALE_4X,
 };
 
+// What to draw with while a shader is compiled in the background
+enum AsyncShaderMode
+{
+	ASYNC_SHADERS_OFF      = 0, // no background compiles, wait for the shader
+	ASYNC_SHADERS_SKIP     = 1, // skip the draw
+	ASYNC_SHADERS_FALLBACK = 2, // use a ready shader with the same vertex stage, else skip
+};
+
 class IniFile;
 
 // NEVER inherit from this class.
@@ -69,6 +77,7 @@ struct VideoConfig
 
 	// OpenMP
 	bool bOMPDecoder;
+	int iAsyncShaderMode;
 
 	// Enhancements
 	int iMultisampleMode;
@@ -11,7 +11,9 @@
 #include "Fifo.h"
 #include "CommandProcessor.h"
 #include "PixelEngine.h"
+#include "PixelShaderGen.h"
 #include "PixelShaderManager.h"
+#include "VertexShaderGen.h"
 #include "VertexShaderManager.h"
 #include "VertexManagerBase.h"
 
@@ -59,6 +61,12 @@ static void DoState(PointerWrap &p)
 	VertexManager::DoState(p);
 	p.DoMarker("VertexManager");
 
+	if (p.GetMode() == PointerWrap::MODE_READ)
+	{
+		SetPixelShaderUidDirty();
+		SetVertexShaderUidDirty();
+	}
+
 	// TODO: search for more data that should be saved and add it here
 }
 
@@ -7,7 +7,9 @@
 #include "XFMemory.h"
 #include "CPMemory.h"
 #include "VertexManagerBase.h"
+#include "VertexShaderGen.h"
 #include "VertexShaderManager.h"
+#include "PixelShaderGen.h"
 #include "PixelShaderManager.h"
 #include "HW/Memmap.h"
 
@@ -18,6 +20,14 @@ void XFMemWritten(u32 transferSize, u32 baseAddress)
 	PixelShaderManager::InvalidateXFRange(baseAddress, baseAddress + transferSize);
 }
 
+// For the registers both shader UIDs are built from.
+static void ShaderUidsChanged()
+{
+	VertexManager::Flush();
+	SetVertexShaderUidDirty();
+	SetPixelShaderUidDirty();
+}
+
 void XFRegWritten(int transferSize, u32 baseAddress, u32 *pData)
 {
 	u32 address = baseAddress;
@@ -50,7 +60,7 @@ void XFRegWritten(int transferSize, u32 baseAddress, u32 *pData)
 
 		case XFMEM_SETNUMCHAN:
 			if (xfregs.numChan.numColorChans != (newValue & 3))
-				VertexManager::Flush();
+				ShaderUidsChanged();
 			break;
 
 		case XFMEM_SETCHAN0_AMBCOLOR: // Channel Ambient Color
@@ -84,12 +94,12 @@ void XFRegWritten(int transferSize, u32 baseAddress, u32 *pData)
 		case XFMEM_SETCHAN0_ALPHA: // Channel Alpha
 		case XFMEM_SETCHAN1_ALPHA:
 			if (((u32*)&xfregs)[address - 0x1000] != (newValue & 0x7fff))
-				VertexManager::Flush();
+				ShaderUidsChanged();
 			break;
 
 		case XFMEM_DUALTEX:
 			if (xfregs.dualTexTrans.enabled != (newValue & 1))
-				VertexManager::Flush();
+				ShaderUidsChanged();
 			break;
 
 
@@ -130,7 +140,7 @@ void XFRegWritten(int transferSize, u32 baseAddress, u32 *pData)
 
 		case XFMEM_SETNUMTEXGENS: // GXSetNumTexGens
 			if (xfregs.numTexGen.numTexGens != (newValue & 15))
-				VertexManager::Flush();
+				ShaderUidsChanged();
 			break;
 
 		case XFMEM_SETTEXMTXINFO:
@@ -141,7 +151,7 @@ void XFRegWritten(int transferSize, u32 baseAddress, u32 *pData)
 		case XFMEM_SETTEXMTXINFO+5:
 		case XFMEM_SETTEXMTXINFO+6:
 		case XFMEM_SETTEXMTXINFO+7:
-			VertexManager::Flush();
+			ShaderUidsChanged();
 
 			nextAddress = XFMEM_SETTEXMTXINFO + 8;
 			break;
@@ -154,7 +164,7 @@ void XFRegWritten(int transferSize, u32 baseAddress, u32 *pData)
 		case XFMEM_SETPOSMTXINFO+5:
 		case XFMEM_SETPOSMTXINFO+6:
 		case XFMEM_SETPOSMTXINFO+7:
-			VertexManager::Flush();
+			ShaderUidsChanged();
 
 			nextAddress = XFMEM_SETPOSMTXINFO + 8;
 			break;
@@ -0,0 +1,115 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+// Measures how fast JitBaseBlockCache registers, links and invalidates
+// blocks, without generating any code.
+
+#include <cstdio>
+
+#include "Timer.h"
+#include "PowerPC/JitCommon/JitCache.h"
+
+namespace
+{
+
+// A block cache that never touches the code it is given.
+class BenchmarkBlockCache : public JitBaseBlockCache
+{
+private:
+	void WriteLinkBlock(u8* location, const u8* address) override {}
+	void WriteDestroyBlock(const u8* location, u32 address) override {}
+};
+
+u32 s_seed = 1;
+
+u32 Random()
+{
+	s_seed = s_seed * 1103515245 + 12345;
+	return s_seed >> 8;
+}
+
+// Registers a block like the JIT would: one exit falls through, the other
+// branches somewhere nearby.
+void CompileBlock(BenchmarkBlockCache& cache, u32 address, u32 size, u8* code)
+{
+	int block_num = cache.AllocateBlock(address);
+	JitBlock* b = cache.GetBlock(block_num);
+	b->checkedEntry = code;
+	b->normalEntry = code;
+	b->codeSize = 0;
+	b->originalSize = size;
+	b->runCount = 0;
+	b->flags = 0;
+	b->exitAddress[0] = address + size * 4;
+	b->exitAddress[1] = (address & ~0xFFFF) + (Random() & 0xFFFC);
+	b->exitPtrs[0] = code;
+	b->exitPtrs[1] = code;
+	cache.FinalizeBlock(block_num, true, code);
+}
+
+// Fills [base, base + span) with blocks of 1 to 32 instructions.
+int CompileRange(BenchmarkBlockCache& cache, u32 base, u32 span, u8* code)
+{
+	int count = 0;
+	for (u32 address = base; address < base + span; count++)
+	{
+		u32 size = 1 + Random() % 32;
+		CompileBlock(cache, address, size, code);
+		address += size * 4;
+	}
+	return count;
+}
+
+}  // namespace
+
+void JitCacheBenchmark()
+{
+	const u32 base = 0x80100000;
+	const u32 span = 0x100000;
+	const int rounds = 16;
+
+	static BenchmarkBlockCache cache;
+	cache.Init();
+	u8 code[16];
+
+	u64 compiled = 0, icbis = 0, dmas = 0;
+	u32 compile_ms = 0, icbi_ms = 0, dma_ms = 0;
+
+	for (int round = 0; round < rounds; round++)
+	{
+		cache.Clear();
+
+		// Compile and link a fresh working set.
+		u32 start = Common::Timer::GetTimeMs();
+		compiled += CompileRange(cache, base, span, code);
+		compile_ms += Common::Timer::GetTimeMs() - start;
+
+		// icbi single cache lines all over it, hitting live blocks.
+		start = Common::Timer::GetTimeMs();
+		for (int i = 0; i < 0x4000; i++)
+		{
+			u32 line = (Random() % (span / 32)) * 32;
+			cache.InvalidateICache(base + line, 32);
+			icbis++;
+		}
+		icbi_ms += Common::Timer::GetTimeMs() - start;
+
+		// Stream overlays over it, as a DVD read into executable RAM would,
+		// recompiling each one afterwards.
+		start = Common::Timer::GetTimeMs();
+		for (u32 overlay = 0; overlay < span; overlay += 0x8000)
+		{
+			cache.InvalidateICache(base + overlay, 0x8000);
+			compiled += CompileRange(cache, base + overlay, 0x8000, code);
+			dmas++;
+		}
+		dma_ms += Common::Timer::GetTimeMs() - start;
+	}
+
+	cache.Shutdown();
+
+	printf("JitCacheBenchmark: %llu blocks compiled and linked in %u ms\n", (unsigned long long)compiled, compile_ms);
+	printf("JitCacheBenchmark: %llu icbi in %u ms\n", (unsigned long long)icbis, icbi_ms);
+	printf("JitCacheBenchmark: %llu overlay loads in %u ms\n", (unsigned long long)dmas, dma_ms);
+}
@@ -16,6 +16,7 @@
 // http://code.google.com/p/dolphin-emu/
 
 #include <cmath>
+#include <cstring>
 #include <iostream>
 
 #include "StringUtil.h"
@@ -24,6 +25,7 @@
 #include "HW/SI_DeviceGCController.h"
 
 void AudioJitTests();
+void JitCacheBenchmark();
 
 using namespace std;
 int fail_count = 0;
@@ -141,5 +143,12 @@ int main(int argc, char* argv[])
 	{
 		printf("All tests passed.\n");
 	}
+
+	// Timings only, not run by default
+	for (int i = 1; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "--benchmark"))
+			JitCacheBenchmark();
+	}
 	return 0;
 }